@@ -21,19 +21,28 @@
 
 #include "Log.h"
 #include "common_includes.h"
+#include "spsc_ring.h"
+
+#include <condition_variable>
 
 decltype(Log::_log_user_param) Log::_log_user_param;
 decltype(Log::_log_level)      Log::_log_level = Log::LogLevel::OFF;
 decltype(Log::_log_func)       Log::_log_func  = default_log_func;
+decltype(Log::_async)          Log::_async(true);
 
-void Log::default_log_func(void* user_param, Log::LogLevel lv, const char* log_message)
+static std::ofstream& get_log_file()
 {
     static std::ofstream log_file("nemirtingassteamemu.log", std::ios::trunc | std::ios::out);
+    return log_file;
+}
 
+// Writes one or more log lines to the default sinks
+static void write_default_sinks(const char* log_messages, size_t len)
+{
 #if defined(__WINDOWS__)
     if (IsDebuggerPresent())
     {
-        OutputDebugString(log_message);
+        OutputDebugString(log_messages);
     }
     else
     {
@@ -44,15 +53,463 @@ void Log::default_log_func(void* user_param, Log::LogLevel lv, const char* log_m
             freopen("CONOUT$", "w", stdout);
         }
 
-        fprintf(stdout, "%s", log_message);
+        fwrite(log_messages, 1, len, stdout);
     }
 #endif
 
-    log_file << log_message;
+    std::ofstream& log_file = get_log_file();
+    log_file.write(log_messages, len);
     log_file.flush();
-    fprintf(stderr, "%s", log_message);
+    fwrite(log_messages, 1, len, stderr);
+}
+
+void Log::default_log_func(void* user_param, Log::LogLevel lv, const char* log_message)
+{
+    write_default_sinks(log_message, strlen(log_message));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                             Asynchronous sink                             //
+///////////////////////////////////////////////////////////////////////////////
+// A log call only serializes its arguments in a per-thread ring, the formatting and the writes are done by a background thread.
+// The format strings are never copied, they must outlive the process (APP_LOG and TRACE_FUNC use literals).
+
+// Walks a printf format string, calling on_text for the literal parts and on_spec for each conversion
+struct format_spec_t
+{
+    const char* begin; // Starts on the '%'
+    size_t len;
+    char length[3];    // hh, h, l, ll, z, j, t, L or empty
+    char conversion;
+    bool star_width;
+    bool star_precision;
+};
+
+template<typename OnText, typename OnSpec>
+static void parse_format(const char* format, OnText on_text, OnSpec on_spec)
+{
+    const char* text = format;
+    const char* it = format;
+    while (*it != '\0')
+    {
+        if (*it != '%')
+        {
+            ++it;
+            continue;
+        }
+
+        if (it[1] == '%')
+        {
+            on_text(text, it + 1 - text);
+            it += 2;
+            text = it;
+            continue;
+        }
+
+        if (it != text)
+            on_text(text, it - text);
+
+        format_spec_t spec{};
+        spec.begin = it++;
+        while (*it == '-' || *it == '+' || *it == ' ' || *it == '#' || *it == '0')
+            ++it;
+
+        if (*it == '*') { spec.star_width = true; ++it; }
+        while (*it >= '0' && *it <= '9') ++it;
+
+        if (*it == '.')
+        {
+            ++it;
+            if (*it == '*') { spec.star_precision = true; ++it; }
+            while (*it >= '0' && *it <= '9') ++it;
+        }
+
+        size_t length_len = 0;
+        while (length_len < 2 && (*it == 'h' || *it == 'l' || *it == 'z' || *it == 'j' || *it == 't' || *it == 'L'))
+            spec.length[length_len++] = *it++;
+
+        if (*it == '\0')
+        {// Truncated specification, print it as text
+            text = spec.begin;
+            break;
+        }
+
+        spec.conversion = *it++;
+        spec.len = it - spec.begin;
+        on_spec(spec);
+        text = it;
+    }
+
+    if (it != text)
+        on_text(text, it - text);
 }
 
+static inline bool is_signed_conversion(char c)   { return c == 'd' || c == 'i'; }
+static inline bool is_unsigned_conversion(char c) { return c == 'u' || c == 'o' || c == 'x' || c == 'X'; }
+static inline bool is_float_conversion(char c)    { return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A'; }
+
+struct log_record_t
+{
+    static constexpr size_t record_size = 256;
+
+    const char* format;
+    Log::LogLevel lv;
+    uint16_t size;
+    uint8_t data[record_size - sizeof(const char*) - sizeof(Log::LogLevel) - sizeof(uint16_t)];
+
+    template<typename T>
+    bool write(T const& v)
+    {
+        if (size + sizeof(T) > sizeof(data))
+            return false;
+
+        memcpy(data + size, &v, sizeof(T));
+        size += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    T read(size_t& offset) const
+    {
+        T v{};
+        if (offset + sizeof(T) <= size)
+            memcpy(&v, data + offset, sizeof(T));
+
+        offset += sizeof(T);
+        return v;
+    }
+
+    // Strings are stored null terminated and truncated to what is left in the record
+    void write_string(const char* str)
+    {
+        if (str == nullptr)
+            str = "(null)";
+
+        if (size >= sizeof(data))
+            return;
+
+        size_t len = std::min(strlen(str), sizeof(data) - size - 1);
+        memcpy(data + size, str, len);
+        data[size + len] = '\0';
+        size += static_cast<uint16_t>(len + 1);
+    }
+
+    const char* read_string(size_t& offset) const
+    {
+        if (offset >= size)
+            return "";
+
+        const char* str = reinterpret_cast<const char*>(data + offset);
+        offset += strlen(str) + 1;
+        return str;
+    }
+
+    void serialize(const char* fmt, va_list argptr)
+    {
+        format = fmt;
+        size = 0;
+        parse_format(fmt, [](const char*, size_t) {}, [this, &argptr](format_spec_t const& spec)
+        {
+            if (spec.star_width)     write(va_arg(argptr, int));
+            if (spec.star_precision) write(va_arg(argptr, int));
+
+            std::string length(spec.length);
+            char c = spec.conversion;
+            if (is_signed_conversion(c))
+            {
+                int64_t v;
+                if      (length == "ll") v = va_arg(argptr, long long);
+                else if (length == "l" ) v = va_arg(argptr, long);
+                else if (length == "z" ) v = static_cast<int64_t>(va_arg(argptr, size_t));
+                else if (length == "j" ) v = va_arg(argptr, intmax_t);
+                else if (length == "t" ) v = va_arg(argptr, ptrdiff_t);
+                else                     v = va_arg(argptr, int);
+                write(v);
+            }
+            else if (is_unsigned_conversion(c))
+            {
+                uint64_t v;
+                if      (length == "ll") v = va_arg(argptr, unsigned long long);
+                else if (length == "l" ) v = va_arg(argptr, unsigned long);
+                else if (length == "z" ) v = va_arg(argptr, size_t);
+                else if (length == "j" ) v = va_arg(argptr, uintmax_t);
+                else if (length == "t" ) v = static_cast<uint64_t>(va_arg(argptr, ptrdiff_t));
+                else                     v = va_arg(argptr, unsigned int);
+                write(v);
+            }
+            else if (is_float_conversion(c))
+            {
+                if (length == "L") write(va_arg(argptr, long double));
+                else               write(va_arg(argptr, double));
+            }
+            else if (c == 'c') write(va_arg(argptr, int));
+            else if (c == 's') write_string(va_arg(argptr, const char*));
+            else if (c == 'p') write(va_arg(argptr, void*));
+            else if (c == 'n') va_arg(argptr, void*); // Not supported, there is nothing to write to once deferred
+        });
+    }
+
+    // Formats the record in out, terminated by a '\n'
+    void format_to(std::string& out) const
+    {
+        size_t offset = 0;
+        char spec_buffer[32];
+        char value_buffer[512];
+
+        parse_format(format, [&out](const char* text, size_t len)
+        {
+            out.append(text, len);
+        }, [&](format_spec_t const& spec)
+        {
+            int width = spec.star_width ? read<int>(offset) : 0;
+            int precision = spec.star_precision ? read<int>(offset) : 0;
+
+            // Rebuild the specification without its length modifier, the values are stored with a known size
+            size_t spec_len = spec.len - 1 - strlen(spec.length);
+            if (spec_len + 4 > sizeof(spec_buffer))
+                return;
+
+            memcpy(spec_buffer, spec.begin, spec_len);
+            char c = spec.conversion;
+            char* end = spec_buffer + spec_len;
+            if (is_signed_conversion(c) || is_unsigned_conversion(c)) { *end++ = 'l'; *end++ = 'l'; }
+            else if (is_float_conversion(c) && strcmp(spec.length, "L") == 0) { *end++ = 'L'; }
+            *end++ = c;
+            *end = '\0';
+
+            auto print = [&](auto v)
+            {
+                int len;
+                if (spec.star_width && spec.star_precision) len = snprintf(value_buffer, sizeof(value_buffer), spec_buffer, width, precision, v);
+                else if (spec.star_width)                   len = snprintf(value_buffer, sizeof(value_buffer), spec_buffer, width, v);
+                else if (spec.star_precision)               len = snprintf(value_buffer, sizeof(value_buffer), spec_buffer, precision, v);
+                else                                        len = snprintf(value_buffer, sizeof(value_buffer), spec_buffer, v);
+
+                if (len > 0)
+                    out.append(value_buffer, std::min<size_t>(len, sizeof(value_buffer) - 1));
+            };
+
+            if      (is_signed_conversion(c))   print(static_cast<long long>(read<int64_t>(offset)));
+            else if (is_unsigned_conversion(c)) print(static_cast<unsigned long long>(read<uint64_t>(offset)));
+            else if (is_float_conversion(c))
+            {
+                if (strcmp(spec.length, "L") == 0) print(read<long double>(offset));
+                else                               print(read<double>(offset));
+            }
+            else if (c == 'c') print(read<int>(offset));
+            else if (c == 's') print(read_string(offset));
+            else if (c == 'p') print(read<void*>(offset));
+        });
+
+        if (out.empty() || out.back() != '\n')
+            out += '\n';
+    }
+};
+
+class log_sink
+{
+    static constexpr size_t ring_size = 512;
+    static constexpr auto flush_interval = std::chrono::milliseconds(10);
+
+    struct producer_t
+    {
+        spsc_ring<log_record_t, ring_size> ring;
+        std::atomic<bool> exited;
+
+        producer_t():
+            exited(false)
+        {}
+    };
+
+    // Marks the thread's producer as exited so the sink can release it once drained
+    struct producer_handle_t
+    {
+        std::shared_ptr<producer_t> producer;
+
+        ~producer_handle_t()
+        {
+            if (producer != nullptr)
+                producer->exited = true;
+        }
+    };
+
+    std::mutex _producers_mutex;
+    std::vector<std::shared_ptr<producer_t>> _producers;
+
+    // Only one consumer at a time: the background thread or a synchronous flush
+    std::mutex _consumer_mutex;
+    std::string _batch;
+    uint64_t _reported_dropped;
+
+    // The writer thread is started by the first pushed record, the producers only check _stop
+    std::once_flag _thread_started;
+    std::mutex _thread_mutex;
+    std::condition_variable _thread_cv;
+    std::thread _thread;
+    std::atomic<bool> _stop;
+
+    producer_t& get_producer()
+    {
+        thread_local producer_handle_t handle;
+        if (handle.producer == nullptr)
+        {
+            handle.producer = std::make_shared<producer_t>();
+
+            std::lock_guard<std::mutex> lk(_producers_mutex);
+            _producers.emplace_back(handle.producer);
+        }
+
+        return *handle.producer;
+    }
+
+    // Must hold _consumer_mutex, returns the number of records written
+    size_t drain()
+    {
+        std::vector<std::shared_ptr<producer_t>> producers;
+        {
+            std::lock_guard<std::mutex> lk(_producers_mutex);
+            producers = _producers;
+        }
+
+        size_t count = 0;
+        bool default_sink = (Log::get_log_func() == Log::default_log_func);
+        for (auto& producer : producers)
+        {
+            for (log_record_t* record = producer->ring.front(); record != nullptr; record = producer->ring.front())
+            {
+                if (default_sink)
+                {
+                    record->format_to(_batch);
+                }
+                else
+                {
+                    std::string message;
+                    record->format_to(message);
+                    Log::get_log_func()(Log::get_log_user_param(), record->lv, message.c_str());
+                }
+                producer->ring.pop();
+                ++count;
+            }
+        }
+
+        uint64_t dropped = Log::dropped_count.load(std::memory_order_relaxed);
+        if (dropped != _reported_dropped)
+        {
+            char message[128];
+            snprintf(message, sizeof(message), "Log sink overflow, %llu messages dropped\n", static_cast<unsigned long long>(dropped - _reported_dropped));
+            _reported_dropped = dropped;
+            if (default_sink)
+                _batch += message;
+            else
+                Log::get_log_func()(Log::get_log_user_param(), Log::LogLevel::WARN, message);
+        }
+
+        if (!_batch.empty())
+        {
+            write_default_sinks(_batch.c_str(), _batch.length());
+            _batch.clear();
+        }
+
+        {// Release the producers of the threads that exited
+            std::lock_guard<std::mutex> lk(_producers_mutex);
+            _producers.erase(std::remove_if(_producers.begin(), _producers.end(), [](std::shared_ptr<producer_t> const& producer)
+            {
+                return producer->exited && producer->ring.empty();
+            }), _producers.end());
+        }
+
+        return count;
+    }
+
+    void sink_thread()
+    {
+        std::unique_lock<std::mutex> lk(_thread_mutex);
+        while (!_stop)
+        {
+            lk.unlock();
+            {
+                std::lock_guard<std::mutex> consumer_lk(_consumer_mutex);
+                drain();
+            }
+            lk.lock();
+            _thread_cv.wait_for(lk, flush_interval, [this]() { return _stop.load(); });
+        }
+    }
+
+public:
+    log_sink():
+        _reported_dropped(0),
+        _stop(false)
+    {}
+
+    ~log_sink()
+    {
+        stop();
+    }
+
+    static log_sink& inst()
+    {
+        static log_sink sink;
+        return sink;
+    }
+
+    bool push(Log::LogLevel lv, const char* format, va_list argptr)
+    {
+        if (_stop.load(std::memory_order_acquire))
+            return false;
+
+        std::call_once(_thread_started, [this]()
+        {
+            _thread = std::thread(&log_sink::sink_thread, this);
+        });
+
+        log_record_t record;
+        record.lv = lv;
+        record.serialize(format, argptr);
+        auto& ring = get_producer().ring;
+        if (!ring.push(std::move(record)))
+        {
+            ++Log::dropped_count;
+        }
+        else
+        {
+            ++Log::queued_count;
+            // Don't wait for the next flush interval when a burst is filling the ring
+            if (ring.size() == ring_size / 2)
+                _thread_cv.notify_one();
+        }
+
+        return true;
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lk(_consumer_mutex);
+        drain();
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lk(_thread_mutex);
+            _stop = true;
+        }
+        // Waits for a push starting the thread, none can start it after this
+        std::call_once(_thread_started, []() {});
+        _thread_cv.notify_all();
+        if (_thread.joinable())
+            _thread.join();
+
+        flush();
+    }
+};
+
+decltype(Log::queued_count)  Log::queued_count(0);
+decltype(Log::dropped_count) Log::dropped_count(0);
+
+///////////////////////////////////////////////////////////////////////////////
+//                              Synchronous path                             //
+///////////////////////////////////////////////////////////////////////////////
 bool Log::_trace(const char* format, va_list argptr)
 {
     std::string fmt = format;
@@ -62,17 +519,40 @@ bool Log::_trace(const char* format, va_list argptr)
     va_list argptr2;
     va_copy(argptr2, argptr);
 
-    int len = vsnprintf(nullptr, 0, fmt.c_str(), argptr);
-    char* buffer = new char[++len];
+    char stack_buffer[1024];
+    int len = vsnprintf(stack_buffer, sizeof(stack_buffer), fmt.c_str(), argptr);
+    if (len < 0)
+    {
+        va_end(argptr2);
+        return false;
+    }
+
+    if (static_cast<size_t>(len) < sizeof(stack_buffer))
+    {
+        _log_func(_log_user_param, _log_level, stack_buffer);
+    }
+    else
+    {
+        std::string buffer(len, '\0');
+        vsnprintf(&buffer[0], len + 1, fmt.c_str(), argptr2);
+        _log_func(_log_user_param, _log_level, buffer.c_str());
+    }
 
-    vsnprintf(buffer, len, fmt.c_str(), argptr2);
-    va_end(argptr);
     va_end(argptr2);
+    return true;
+}
 
-    _log_func(_log_user_param, _log_level, buffer);
+void Log::set_async(bool async)
+{
+    if (!async)
+        flush();
 
-    delete[]buffer;
-    return true;
+    _async = async;
+}
+
+void Log::flush()
+{
+    log_sink::inst().flush();
 }
 
 void Log::Format(LogLevel lv, const char* format, ...)
@@ -81,7 +561,13 @@ void Log::Format(LogLevel lv, const char* format, ...)
     {
         va_list argptr;
         va_start(argptr, format);
-        _trace(format, argptr);
+        // Fatal messages are written right away, we are probably about to crash
+        if (!_async || lv >= LogLevel::FATAL || !log_sink::inst().push(lv, format, argptr))
+        {
+            flush();
+            _trace(format, argptr);
+        }
+        va_end(argptr);
     }
 }
 
@@ -19,9 +19,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
+#include <string_view>
 #include <thread>
 
+// Messages below this level are compiled out, set it with -DEMU_LOG_MIN_LEVEL=INFO
+#ifndef EMU_LOG_MIN_LEVEL
+    #define EMU_LOG_MIN_LEVEL TRACE
+#endif
+
 class Log
 {
 public:
@@ -53,6 +60,8 @@ public:
         }
     }
 
+    static constexpr LogLevel min_level = LogLevel::EMU_LOG_MIN_LEVEL;
+
     using log_func_t = void(*)(void* user_param, Log::LogLevel lv, const char* log_message);
 
     static void default_log_func(void* user_param, Log::LogLevel lv, const char* log_message);
@@ -61,6 +70,11 @@ private:
     static void*           _log_user_param;
     static Log::LogLevel   _log_level;
     static Log::log_func_t _log_func;
+    static std::atomic<bool> _async;
+    static std::atomic<uint64_t> queued_count;
+    static std::atomic<uint64_t> dropped_count;
+
+    friend class log_sink;
 
     Log()                      = delete;
     Log(Log const&)            = delete;
@@ -71,28 +85,40 @@ private:
     static bool _trace(const char* format, va_list argptr);
 
     LogLevel _lv;
-    std::string _func_name;
+    const char* _func_name; // Points to a static function_name_t, nullptr if the level is disabled
 
 public:
 #ifndef DISABLE_LOG
     Log(LogLevel lv, const char* func_name):
         _lv(lv),
-        _func_name(func_name)
+        _func_name(is_enabled(lv) ? func_name : nullptr)
     {
-        auto tid = std::this_thread::get_id();
-        Log::Format(_lv, "(%lx)%s - %s ENTRY", *reinterpret_cast<uint32_t*>(&tid), Log::loglevel_to_str(_lv), _func_name.c_str());
+        if (_func_name != nullptr)
+        {
+            auto tid = std::this_thread::get_id();
+            Log::Format(_lv, "(%lx)%s - %s ENTRY", *reinterpret_cast<uint32_t*>(&tid), Log::loglevel_to_str(_lv), _func_name);
+        }
     }
 
     ~Log()
     {
-        auto tid = std::this_thread::get_id();
-        Log::Format(_lv, "(%lx)%s - %s EXIT", *reinterpret_cast<uint32_t*>(&tid), Log::loglevel_to_str(_lv), _func_name.c_str());
+        if (_func_name != nullptr)
+        {
+            auto tid = std::this_thread::get_id();
+            Log::Format(_lv, "(%lx)%s - %s EXIT", *reinterpret_cast<uint32_t*>(&tid), Log::loglevel_to_str(_lv), _func_name);
+        }
+    }
+
+    // Checked before building anything, the first test is folded by the compiler when lv is a constant
+    static inline bool is_enabled(LogLevel lv)
+    {
+        return lv >= min_level && lv >= _log_level && _log_level < LogLevel::MAX;
     }
 
     static inline Log::LogLevel get_loglevel()
     {
         return _log_level;
-}
+    }
 
     static inline void set_loglevel(LogLevel lv)
     {
@@ -105,6 +131,33 @@ public:
         return _log_func;
     }
 
+    static inline void* get_log_user_param()
+    {
+        return _log_user_param;
+    }
+
+    // Messages are formatted and written by a background thread, except FATAL ones
+    static inline bool get_async()
+    {
+        return _async;
+    }
+
+    static void set_async(bool async);
+
+    // Synchronously writes all the pending messages, call it before crashing
+    static void flush();
+
+    // Messages lost because their thread's ring was full
+    static inline uint64_t get_dropped_count()
+    {
+        return dropped_count;
+    }
+
+    static inline uint64_t get_queued_count()
+    {
+        return queued_count;
+    }
+
     static inline log_func_t set_log_func(log_func_t log_func, void* user_param)
     {
         auto old_func = log_func;
@@ -113,14 +166,21 @@ public:
         return old_func;
     }
 #else
-    STEAM_LOG(LogLevel lv, const char* func_name) {}
+    Log(LogLevel lv, const char* func_name) {}
     ~Log() {}
 
+    static constexpr bool is_enabled(LogLevel lv) { return false; }
+
     static void dummy_log_func(Log::LogLevel lv, const char* log_message) { (void)lv; (void)log_message; }
     static inline Log::LogLevel get_loglevel() { return LogLevel::OFF; }
     static inline void set_loglevel(LogLevel lv) {}
     static inline log_func_t get_log_func() { return dummy_log_func; }
     static inline log_func_t set_log_func(log_func_t log_func) { return dummy_log_func; }
+    static inline bool get_async() { return false; }
+    static inline void set_async(bool async) {}
+    static inline void flush() {}
+    static inline uint64_t get_dropped_count() { return 0; }
+    static inline uint64_t get_queued_count() { return 0; }
 #endif
 
     static inline const char* loglevel_to_str()
@@ -144,37 +204,73 @@ public:
         #define __32BITS__
     #endif
 
-    #if defined(__WINDOWS_32__) || defined(__WINDOWS_64__)
-        #define __MY_FUNCTION__ __FUNCTION__
-    #else
-
-    inline std::string className(const std::string& prettyFunction)
+    // Qualified function name extracted at compile time, so logging sites don't build any string
+    template<size_t N>
+    struct function_name_t
     {
-        size_t colons = prettyFunction.rfind("::");
-        if (colons == std::string::npos)
-            return "";
-        size_t begin = prettyFunction.substr(0, colons).rfind(" ") + 1;
-        size_t end = colons - begin;
+        char _name[N];
+        size_t _len;
 
-        return prettyFunction.substr(begin, end);
-    }
+        constexpr function_name_t(const char(&pretty_function)[N]):
+            _name{},
+            _len(0)
+        {
+            // The name is the last word before the first parameter list: "void Class::Func(int) [with T = int]"
+            size_t begin = 0;
+            size_t end = N - 1;
+            int depth = 0;
+            for (size_t i = 0; i < N - 1; ++i)
+            {
+                char c = pretty_function[i];
+                if (c == '<')
+                {
+                    ++depth;
+                }
+                else if (c == '>')
+                {
+                    --depth;
+                }
+                else if (depth == 0 && c == ' ')
+                {
+                    begin = i + 1;
+                }
+                else if (depth == 0 && c == '(')
+                {
+                    // operator() has its own parenthesis before the parameter list
+                    if (i >= 8 && pretty_function[i - 8] == 'o' && pretty_function[i + 1] == ')' && pretty_function[i + 2] == '(')
+                        i += 2;
 
-    #define __CLASS_NAME__ className(__PRETTY_FUNCTION__)
+                    end = i;
+                    break;
+                }
+            }
 
-    inline std::string fq_func(std::string const& classname, std::string const& funcname)
-    {
-        if (classname.empty())
-            return funcname;
+            for (size_t i = begin; i < end; ++i)
+                _name[_len++] = pretty_function[i];
 
-        return classname + "::" + funcname;
-    }
+            _name[_len] = '\0';
+        }
 
-    #define __MY_FUNCTION__ fq_func(__CLASS_NAME__, __FUNCTION__).c_str()
+        constexpr const char* c_str() const { return _name; }
+        constexpr std::string_view view() const { return std::string_view(_name, _len); }
+    };
 
+    #if defined(__WINDOWS_32__) || defined(__WINDOWS_64__)
+        #define __EMU_PRETTY_FUNCTION__ __FUNCTION__
+    #else
+        #define __EMU_PRETTY_FUNCTION__ __PRETTY_FUNCTION__
     #endif
 
-    #define APP_LOG(lv, fmt, ...) Log::Format(lv, "(%lx)%s - %s: " fmt, std::this_thread::get_id(), Log::loglevel_to_str(lv), __MY_FUNCTION__, ##__VA_ARGS__)
-    #define TRACE_FUNC() Log __func_trace_log(Log::LogLevel::TRACE, __MY_FUNCTION__)
+    #define EMU_DECLARE_FUNCTION_NAME() static constexpr function_name_t<sizeof(__EMU_PRETTY_FUNCTION__)> __emu_function_name(__EMU_PRETTY_FUNCTION__)
+
+    #define APP_LOG(lv, fmt, ...) do {\
+        if (Log::is_enabled(lv))\
+        {\
+            EMU_DECLARE_FUNCTION_NAME();\
+            Log::Format(lv, "(%lx)%s - %s: " fmt, std::this_thread::get_id(), Log::loglevel_to_str(lv), __emu_function_name.c_str(), ##__VA_ARGS__);\
+        }\
+    } while(0)
+    #define TRACE_FUNC() EMU_DECLARE_FUNCTION_NAME(); Log __func_trace_log(Log::LogLevel::TRACE, __emu_function_name.c_str())
 #else //!DISABLE_LOG
     #define APP_LOG(...)
     #define TRACE_FUNC()
@@ -23,17 +23,150 @@
 
 constexpr static std::chrono::seconds cleanup_timeout(60);
 
-Callback_Manager::Callback_Manager()
+Callback_Manager::Callback_Manager():
+    _max_tick_budget(0),
+    _tick_stats{},
+    _frame_cursor(nullptr),
+    _timer_cursor(0),
+    _timer_time(std::chrono::steady_clock::now())
 {}
 
 Callback_Manager::~Callback_Manager()
 {
+    for (auto& slot : _timer_wheel)
+        slot.clear();
+    _ready_callbacks.clear();
+    _waiting_callbacks.clear();
+    _polling_callbacks.clear();
+}
+
+frame_result_list& Callback_Manager::get_schedule_list(FrameResult* res)
+{
+    switch (res->_schedule)
+    {
+        case callback_schedule_t::timer  : return _timer_wheel[res->_timer_slot];
+        case callback_schedule_t::ready  : return _ready_callbacks;
+        case callback_schedule_t::waiting: return _waiting_callbacks;
+        case callback_schedule_t::polling:
+        default                          : return _polling_callbacks;
+    }
+}
+
+void Callback_Manager::schedule_callback(pFrameResult_t const& res, callback_schedule_t schedule)
+{
+    res->_schedule = schedule;
+    get_schedule_list(res.get()).push_back(res);
+}
+
+void Callback_Manager::unschedule_callback(FrameResult* res)
+{
+    if (res->_schedule == callback_schedule_t::none || res->_schedule == callback_schedule_t::running)
+    {
+        res->_schedule = callback_schedule_t::none;
+        return;
+    }
+
+    frame_result_list& list = get_schedule_list(res);
+    res->_schedule = callback_schedule_t::none;
+    list.erase(res);
+}
+
+void Callback_Manager::schedule_timer(pFrameResult_t const& res, std::chrono::steady_clock::time_point wakeup_time, std::chrono::steady_clock::time_point now)
+{
+    res->_wakeup_time = wakeup_time;
+    if (wakeup_time <= now)
+    {
+        schedule_callback(res, callback_schedule_t::ready);
+        return;
+    }
+
+    // Wakeups past the wheel horizon go in the last slot and are put back in the wheel when it expires
+    auto ticks = std::max<int64_t>((wakeup_time - _timer_time) / timer_resolution, 0);
+    res->_timer_slot = (_timer_cursor + std::min<size_t>(ticks, timer_slots - 1)) % timer_slots;
+    schedule_callback(res, callback_schedule_t::timer);
+}
+
+void Callback_Manager::advance_timer_wheel(std::chrono::steady_clock::time_point now)
+{
+    int64_t elapsed = (now - _timer_time) / timer_resolution;
+    if (elapsed <= 0)
+        return;
+
+    frame_result_list expired;
+    size_t slots = std::min<size_t>(elapsed, timer_slots);
+    for (size_t i = 0; i < slots; ++i)
+        expired.splice_back(_timer_wheel[(_timer_cursor + i) % timer_slots]);
+
+    _timer_cursor = (_timer_cursor + elapsed) % timer_slots;
+    _timer_time += elapsed * timer_resolution;
+
+    while (!expired.empty())
+    {
+        pFrameResult_t res(expired.front());
+        expired.erase(res.get());
+        schedule_timer(res, res->_wakeup_time, now);
+    }
+}
+
+void Callback_Manager::park_callback(pFrameResult_t const& res, std::chrono::steady_clock::time_point now)
+{
+    if (res->_polling)
+    {
+        schedule_callback(res, callback_schedule_t::polling);
+    }
+    else if (res->_timeout.count() != 0)
+    {// Its timeout might have been reached already if RunCallbacks didn't handle it, don't spin on it: retry on the next slot
+        schedule_timer(res, std::max(res->created_time + res->_timeout, now + timer_resolution), now);
+    }
+    else
+    {
+        schedule_callback(res, callback_schedule_t::waiting);
+    }
+}
+
+void Callback_Manager::start_callback(pFrameResult_t const& res)
+{
+    unschedule_callback(res.get());
+    res->_schedule = callback_schedule_t::running;
+    res->_wakeup = false;
+}
+
+void Callback_Manager::finish_callback(pFrameResult_t const& res, bool done, callback_schedule_t schedule, std::chrono::steady_clock::time_point now)
+{
+    res->_schedule = callback_schedule_t::none;
+    // Its interface might have been unregistered while it was running
+    if (done || _callbacks_to_run.count(res->_owner) == 0)
+        return;
+
+    if (schedule == callback_schedule_t::polling)
+        schedule_callback(res, callback_schedule_t::polling);
+    else if (res->_wakeup)
+        schedule_callback(res, callback_schedule_t::ready);
+    else
+        park_callback(res, now);
+}
+
+// Called without holding local_mutex: the interface and the game callback can call back into the manager
+bool Callback_Manager::run_callback(pFrameResult_t const& res)
+{
+    IRunCallback* frame = res->_owner;
+    if (res->done || frame->RunCallbacks(res))
+    {
+        APP_LOG(Log::LogLevel::DEBUG, "Callback ready: %s", get_callback_name(res->ICallback()).c_str());
+        if (res->GetFunc() != nullptr)
+            res->GetFunc()(res->GetFuncParam());
+
+        frame->FreeCallback(res);
+        return true;
+    }
+
+    return false;
 }
 
 void Callback_Manager::register_frame(IRunCallback* obj)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     _frames_to_run.emplace(obj);
 }
@@ -41,7 +174,7 @@ void Callback_Manager::register_frame(IRunCallback* obj)
 void Callback_Manager::unregister_frame(IRunCallback* obj)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     _frames_to_run.erase(obj);
 }
@@ -49,34 +182,85 @@ void Callback_Manager::unregister_frame(IRunCallback* obj)
 void Callback_Manager::register_callbacks(IRunCallback* obj)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
-    _callbacks_to_run[obj];
+    _callbacks_to_run.emplace(obj);
 }
 
 void Callback_Manager::unregister_callbacks(IRunCallback* obj)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
+
+    _callbacks_to_run.erase(obj);
+
+    auto remove_results = [obj](frame_result_list& results)
+    {
+        for (FrameResult* res = results.front(); res != nullptr;)
+        {
+            if (res->_owner == obj)
+            {
+                res->_schedule = callback_schedule_t::none;
+                res = results.erase(res);
+            }
+            else
+            {
+                res = frame_result_list::next(res);
+            }
+        }
+    };
 
-    auto it = _callbacks_to_run.find(obj);
-    if (it != _callbacks_to_run.end())
-        _callbacks_to_run.erase(it);
+    for (auto& slot : _timer_wheel)
+        remove_results(slot);
+    remove_results(_ready_callbacks);
+    remove_results(_waiting_callbacks);
+    remove_results(_polling_callbacks);
 }
 
 bool Callback_Manager::add_callback(IRunCallback* obj, pFrameResult_t res)
 {
     //TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
-    _callbacks_to_run[obj].push_back(res);
+    res->_owner = obj;
+    schedule_timer(res, res->created_time + res->ok_timeout, std::chrono::steady_clock::now());
     return true;
 }
 
+void Callback_Manager::ready_callback(pFrameResult_t const& res)
+{
+    LOCAL_LOCK();
+
+    switch (res->_schedule)
+    {
+        case callback_schedule_t::waiting:
+            unschedule_callback(res.get());
+            schedule_callback(res, callback_schedule_t::ready);
+            break;
+
+        case callback_schedule_t::timer:
+            // Still in its ok_timeout, it will run when it expires
+            if (res->CallbackOKTimeout())
+            {
+                unschedule_callback(res.get());
+                schedule_callback(res, callback_schedule_t::ready);
+            }
+            break;
+
+        case callback_schedule_t::running:
+            // Don't lose the wakeup if its RunCallbacks didn't see the result
+            res->_wakeup = true;
+            break;
+
+        // Already runs on the next tick or not added yet
+        default: break;
+    }
+}
+
 EOS_NotificationId Callback_Manager::add_notification(IRunCallback* obj, pFrameResult_t res)
 {
     //TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     static EOS_NotificationId notif_id = 1;
 
@@ -88,35 +272,52 @@ EOS_NotificationId Callback_Manager::add_notification(IRunCallback* obj, pFrameR
 bool Callback_Manager::remove_notification(IRunCallback* obj, EOS_NotificationId id)
 {
     //TRACE_FUNC();
-    GLOBAL_LOCK();
+    pFrameResult_t res;
+    {
+        LOCAL_LOCK();
 
-    auto& notifs = _notifications[obj];
-    auto it = notifs.find(id);
-    if (it == notifs.end())
-        return false;
+        auto& notifs = _notifications[obj];
+        auto it = notifs.find(id);
+        if (it == notifs.end())
+            return false;
 
-    obj->FreeCallback(it->second);
-    notifs.erase(it);
+        res = std::move(it->second);
+        notifs.erase(it);
+    }
 
+    obj->FreeCallback(res);
     return true;
 }
 
 void Callback_Manager::remove_all_notifications(IRunCallback* obj)
 {
-    auto it = _notifications.find(obj);
-    if (it != _notifications.end())
+    std::map<EOS_NotificationId, pFrameResult_t> notifs;
     {
-        for (auto& res : it->second)
-        {
-            obj->FreeCallback(res.second);
-        }
+        LOCAL_LOCK();
+
+        auto it = _notifications.find(obj);
+        if (it == _notifications.end())
+            return;
 
+        notifs = std::move(it->second);
         _notifications.erase(it);
+
+        _posted_notifications.erase(std::remove_if(_posted_notifications.begin(), _posted_notifications.end(), [obj](posted_notification_t const& posted)
+        {
+            return posted.obj == obj;
+        }), _posted_notifications.end());
+    }
+
+    for (auto& res : notifs)
+    {
+        obj->FreeCallback(res.second);
     }
 }
 
 pFrameResult_t Callback_Manager::get_notification(IRunCallback* obj, EOS_NotificationId id)
 {
+    LOCAL_LOCK();
+
     auto& notifs = _notifications[obj];
     auto it = notifs.find(id);
     if (it != notifs.end())
@@ -127,6 +328,8 @@ pFrameResult_t Callback_Manager::get_notification(IRunCallback* obj, EOS_Notific
 
 std::vector<pFrameResult_t> Callback_Manager::get_notifications(IRunCallback* obj, int callback_id)
 {
+    LOCAL_LOCK();
+
     std::vector<pFrameResult_t> results;
 
     auto& notifs = _notifications[obj];
@@ -141,58 +344,182 @@ std::vector<pFrameResult_t> Callback_Manager::get_notifications(IRunCallback* ob
     return results;
 }
 
+void Callback_Manager::post_notifications(IRunCallback* obj, int callback_id, std::function<void(FrameResult&)> fill)
+{
+    LOCAL_LOCK();
+
+    _posted_notifications.emplace_back(posted_notification_t{ obj, callback_id, std::move(fill) });
+}
+
+bool Callback_Manager::tick_budget_exhausted() const
+{
+    return _max_tick_budget.count() && (std::chrono::steady_clock::now() - _frame_start_time) >= _max_tick_budget;
+}
+
+void Callback_Manager::run_ready_callbacks()
+{
+    auto now = std::chrono::steady_clock::now();
+    {
+        LOCAL_LOCK();
+        advance_timer_wheel(now);
+    }
+
+    // Results readied by a callback we run here are run in this tick too
+    for (bool first = true; first || !tick_budget_exhausted(); first = false)
+    {
+        pFrameResult_t res;
+        {
+            LOCAL_LOCK();
+            if (_ready_callbacks.empty())
+                break;
+
+            res = pFrameResult_t(_ready_callbacks.front());
+            start_callback(res);
+        }
+
+        bool done = run_callback(res);
+
+        LOCAL_LOCK();
+        finish_callback(res, done, callback_schedule_t::ready, now);
+    }
+}
+
+void Callback_Manager::run_polling_callbacks()
+{
+    auto now = std::chrono::steady_clock::now();
+    size_t count;
+    {
+        LOCAL_LOCK();
+        count = _polling_callbacks.size();
+    }
+
+    // Rotate the list so the transfers we didn't get to this tick are the first ones on the next tick
+    for (; count > 0; --count)
+    {
+        pFrameResult_t res;
+        {
+            LOCAL_LOCK();
+            if (_polling_callbacks.empty())
+                break;
+
+            res = pFrameResult_t(_polling_callbacks.front());
+            start_callback(res);
+        }
+
+        bool done = run_callback(res);
+        {
+            LOCAL_LOCK();
+            finish_callback(res, done, callback_schedule_t::polling, now);
+        }
+
+        if (tick_budget_exhausted())
+        {
+            _tick_stats.deferred_callbacks += count - 1;
+            break;
+        }
+    }
+}
+
+void Callback_Manager::run_network()
+{
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (_max_tick_budget.count())
+        deadline = _frame_start_time + _max_tick_budget;
+
+    _tick_stats.network_deferred = GetNetwork().CBRunFrame(0, Network_Message_pb::MessagesCase::MESSAGES_NOT_SET, deadline);
+}
+
 void Callback_Manager::run_frames()
 {
-    //TRACE_FUNC();
-    GLOBAL_LOCK();
+    {
+        LOCAL_LOCK();
+        _frames_snapshot.assign(_frames_to_run.begin(), _frames_to_run.end());
+    }
+
+    if (_frames_snapshot.empty())
+        return;
 
-    for (auto& frame : _frames_to_run)
+    // The snapshot is sorted like _frames_to_run
+    auto it = std::lower_bound(_frames_snapshot.begin(), _frames_snapshot.end(), _frame_cursor);
+    for (size_t count = _frames_snapshot.size(); count > 0; --count)
     {
+        if (it == _frames_snapshot.end())
+            it = _frames_snapshot.begin();
+
+        IRunCallback* frame = *it++;
         frame->CBRunFrame();
-        //if (_max_tick_budget.count() && (std::chrono::steady_clock::now() - _frame_start_time) > _max_tick_budget)
-        //{
-        //    APP_LOG(Log::LogLevel::WARN, "Exiting because of budget");
-        //    return;
-        //}
+
+        if (tick_budget_exhausted())
+        {
+            _tick_stats.deferred_frames = count - 1;
+            break;
+        }
     }
 
-    GetNetwork().CBRunFrame(0);
+    _frame_cursor = (it == _frames_snapshot.end() ? nullptr : *it);
 }
 
-void Callback_Manager::run_callbacks()
+// Called without holding local_mutex, the notifications are looked up when fired so a removed one is never called
+void Callback_Manager::run_posted_notifications()
 {
-    //TRACE_FUNC();
-    GLOBAL_LOCK();
+    std::vector<posted_notification_t> posted;
+    {
+        LOCAL_LOCK();
+        posted.swap(_posted_notifications);
+    }
 
-    // For each callback registerer object
-    for (auto& callback : _callbacks_to_run)
+    for (auto& notification : posted)
     {
-        IRunCallback* frame = callback.first;
-        std::list<pFrameResult_t>& results = callback.second;
-        for (auto result_it = results.begin(); result_it != results.end();)
+        std::vector<pFrameResult_t> notifs = std::move(get_notifications(notification.obj, notification.callback_id));
+        for (auto& notif : notifs)
         {
-            pFrameResult_t& res = *result_it;
-            if (res->CallbackOKTimeout())
-            {
-                if (res->done || frame->RunCallbacks(res))
-                {
-                    APP_LOG(Log::LogLevel::DEBUG, "Callback ready: %s", get_callback_name(res->ICallback()).c_str());
-                    if (res->GetFunc() != nullptr)
-                        res->GetFunc()(res->GetFuncParam());
-
-                    frame->FreeCallback(res);
-                    result_it = results.erase(result_it);
-                }
-                else
-                    ++result_it;
-            }
-            else
-                ++result_it;
+            notification.fill(*notif);
+            notif->GetFunc()(notif->GetFuncParam());
         }
-        //if (_max_tick_budget.count() && (std::chrono::steady_clock::now() - _frame_start_time) > _max_tick_budget)
-        //{
-        //    APP_LOG(Log::LogLevel::WARN, "Exiting because of budget");
-        //    return;
-        //}
     }
-}
\ No newline at end of file
+}
+
+void Callback_Manager::tick()
+{
+    //TRACE_FUNC();
+    PROFILED_LOCK(std::unique_lock<std::recursive_mutex>, tick_lk, _tick_mutex);
+
+    _frame_start_time = std::chrono::steady_clock::now();
+    _tick_stats.deferred_callbacks = 0;
+    _tick_stats.deferred_frames = 0;
+    _tick_stats.network_deferred = false;
+
+    // Completions first, housekeeping last
+    run_ready_callbacks();
+    if (!tick_budget_exhausted())
+    {
+        run_network();
+        run_ready_callbacks();
+    }
+    // Notifications are events, they are not deferred by the budget
+    run_posted_notifications();
+    run_polling_callbacks();
+    run_frames();
+    run_posted_notifications();
+
+    auto tick_time = std::chrono::steady_clock::now() - _frame_start_time;
+    _tick_stats.tick_time = std::chrono::duration_cast<std::chrono::microseconds>(tick_time);
+    {
+        LOCAL_LOCK();
+        _tick_stats.deferred_callbacks += _ready_callbacks.size();
+    }
+    ++_tick_stats.ticks;
+
+    if (_tick_stats.deferred_callbacks || _tick_stats.deferred_frames || _tick_stats.network_deferred)
+        ++_tick_stats.deferred_ticks;
+
+    if (_max_tick_budget.count() && tick_time > _max_tick_budget)
+    {
+        auto overrun = std::chrono::duration_cast<std::chrono::microseconds>(tick_time - _max_tick_budget);
+        ++_tick_stats.overrun_ticks;
+        _tick_stats.max_overrun = std::max(_tick_stats.max_overrun, overrun);
+        APP_LOG(Log::LogLevel::DEBUG, "Tick overrun by %lld us (budget %u ms, %zu callbacks and %zu frames deferred)",
+            static_cast<long long>(overrun.count()), static_cast<unsigned>(_max_tick_budget.count()),
+            _tick_stats.deferred_callbacks, _tick_stats.deferred_frames);
+    }
+}
@@ -35,17 +35,88 @@ public:
     virtual void FreeCallback(pFrameResult_t res) = 0;
 };
 
+// Results are not polled on every tick: they sit in a timer wheel until their ok_timeout expires,
+// then they are run once and, if not done yet, wait for their producer to call ready_callback.
+// A tick only visits the results that became ready, expired or asked to be polled.
+//
+// When the game sets a TickBudgetInMilliseconds, a tick runs its work by priority and stops once the budget is spent:
+//   1. ready results (completions)
+//   2. network messages, then the results they completed and the notifications posted so far
+//   3. polling results (file transfers)
+//   4. interfaces CBRunFrame (housekeeping), then the notifications they posted
+// Every step makes some progress on each tick and resumes where the previous tick stopped, so the low priority work isn't starved.
 class Callback_Manager
 {
+public:
+    struct tick_stats_t
+    {
+        // Last tick
+        std::chrono::microseconds tick_time;
+        size_t deferred_callbacks; // Ready or polling results left for the next tick
+        size_t deferred_frames;    // Interfaces CBRunFrame left for the next tick
+        bool network_deferred;     // Network messages left for the next tick
+
+        // Since startup
+        uint64_t ticks;
+        uint64_t overrun_ticks;    // Ticks that took longer than the budget
+        uint64_t deferred_ticks;   // Ticks that left work for the next tick
+        std::chrono::microseconds max_overrun;
+    };
+
+private:
+    static constexpr auto timer_resolution = std::chrono::milliseconds(10);
+    static constexpr size_t timer_slots = 256;
+
     std::chrono::steady_clock::time_point _frame_start_time;
     std::chrono::milliseconds _max_tick_budget;
 
+    tick_stats_t _tick_stats;
+
+    // Serializes the ticks, held while running the interfaces frames and the games callbacks
+    std::recursive_mutex _tick_mutex;
+    // Protects everything else, never held while calling out of the manager
+    std::recursive_mutex local_mutex;
+
     std::set<IRunCallback*> _frames_to_run;
-    std::map<IRunCallback*, std::list<pFrameResult_t>> _callbacks_to_run;
+    // Copy of _frames_to_run, so a frame can be run without holding local_mutex
+    std::vector<IRunCallback*> _frames_snapshot;
+    // Next frame to run, frames are ordered by address so it stays valid if that frame is unregistered
+    IRunCallback* _frame_cursor;
+    std::set<IRunCallback*> _callbacks_to_run;
+    // Slot _timer_cursor holds the results expiring in [_timer_time, _timer_time + timer_resolution[
+    std::array<frame_result_list, timer_slots> _timer_wheel;
+    size_t _timer_cursor;
+    std::chrono::steady_clock::time_point _timer_time;
+    frame_result_list _ready_callbacks;
+    frame_result_list _waiting_callbacks;
+    frame_result_list _polling_callbacks;
     //std::map<IRunFrame*, std::list<pFrameResult_t>> _next_callbacks_to_run;
     std::map<IRunCallback*, std::map<EOS_NotificationId, pFrameResult_t>> _notifications;
 
-    std::recursive_mutex local_mutex;
+    struct posted_notification_t
+    {
+        IRunCallback* obj;
+        int callback_id;
+        std::function<void(FrameResult&)> fill;
+    };
+    // Notifications posted by the interfaces, fired by the tick once their lock is released
+    std::vector<posted_notification_t> _posted_notifications;
+
+    frame_result_list& get_schedule_list(FrameResult* res);
+    void schedule_callback(pFrameResult_t const& res, callback_schedule_t schedule);
+    void unschedule_callback(FrameResult* res);
+    void schedule_timer(pFrameResult_t const& res, std::chrono::steady_clock::time_point wakeup_time, std::chrono::steady_clock::time_point now);
+    void advance_timer_wheel(std::chrono::steady_clock::time_point now);
+    void park_callback(pFrameResult_t const& res, std::chrono::steady_clock::time_point now);
+    void start_callback(pFrameResult_t const& res);
+    void finish_callback(pFrameResult_t const& res, bool done, callback_schedule_t schedule, std::chrono::steady_clock::time_point now);
+    bool run_callback(pFrameResult_t const& res);
+
+    void run_ready_callbacks();
+    void run_polling_callbacks();
+    void run_network();
+    void run_frames();
+    void run_posted_notifications();
 
 public:
     
@@ -59,26 +130,30 @@ public:
     void unregister_callbacks(IRunCallback* obj);
     
     bool add_callback(IRunCallback* obj, pFrameResult_t res);
+    // Call it when a result waiting on a network reply or an event is done, it will run on the next tick
+    void ready_callback(pFrameResult_t const& res);
 
     EOS_NotificationId add_notification(IRunCallback* obj, pFrameResult_t res);
     bool remove_notification(IRunCallback* obj, EOS_NotificationId id);
     void remove_all_notifications(IRunCallback* obj);
     pFrameResult_t get_notification(IRunCallback* obj, EOS_NotificationId id);
     std::vector<pFrameResult_t> get_notifications(IRunCallback* obj, int callback_id);
-    
-    
-    void run_frames();
-    void run_callbacks();
+    // Fires the callback_id notifications of obj on the tick, fill sets the data of each one right before it is called.
+    // Safe to call while holding the interface lock, the game callbacks never run under it.
+    void post_notifications(IRunCallback* obj, int callback_id, std::function<void(FrameResult&)> fill);
 
     inline void set_max_tick_budget(uint32_t milliseconds)
     {
         _max_tick_budget = std::chrono::milliseconds{ milliseconds };
     }
 
-    inline void tick()
+    // Lets a RunCallbacks do several steps (file chunks) in a tick, always false without a tick budget
+    bool tick_budget_exhausted() const;
+
+    inline tick_stats_t const& get_tick_stats() const
     {
-        _frame_start_time = std::chrono::steady_clock::now();
-        run_frames();
-        run_callbacks();
+        return _tick_stats;
     }
+
+    void tick();
 };
\ No newline at end of file
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "chunk_prefetcher.h"
+
+constexpr decltype(chunk_prefetcher::default_depth) chunk_prefetcher::default_depth;
+
+chunk_prefetcher::chunk_prefetcher(io_pool& pool, mapped_file_cache* mapped_files, uint32_t chunk_size, size_t depth):
+    _pool(pool),
+    _mapped_files(mapped_files),
+    _mapping_offset(0),
+    _mapped_chunk{},
+    _chunk_size(chunk_size),
+    _depth(std::max<size_t>(depth, 1)),
+    _reading(false),
+    _finished(false),
+    _failed(false),
+    _closed(false)
+{}
+
+bool chunk_prefetcher::start(std::string const& file_path, std::function<void()> on_ready)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    if (_mapped_files != nullptr)
+    {
+        _mapping = _mapped_files->acquire(file_path);
+        if (_mapping != nullptr)
+            return true;
+    }
+
+    _file = FileManager::open_read(file_path, std::ios::binary);
+    if (!_file)
+    {
+        _failed = true;
+        _finished = true;
+        return false;
+    }
+
+    _on_ready = std::move(on_ready);
+    schedule_read();
+    return true;
+}
+
+void chunk_prefetcher::schedule_read()
+{
+    if (_reading || _finished || _closed || _ready.size() >= _depth)
+        return;
+
+    _reading = true;
+    auto self = shared_from_this();
+    _pool.post([self]() { self->read_job(); });
+}
+
+void chunk_prefetcher::read_job()
+{
+    for (;;)
+    {
+        std::vector<uint8_t> buffer;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (_finished || _closed || _ready.size() >= _depth)
+            {
+                _reading = false;
+                return;
+            }
+
+            if (!_free_buffers.empty())
+            {
+                buffer = std::move(_free_buffers.back());
+                _free_buffers.pop_back();
+            }
+        }
+
+        buffer.resize(_chunk_size);
+        _file.read(reinterpret_cast<char*>(buffer.data()), _chunk_size);
+        size_t read_len = static_cast<size_t>(_file.gcount());
+        bool failed = _file.bad();
+        // Peek so a file ending on a chunk boundary doesn't need an empty last chunk
+        bool last = (read_len != _chunk_size || _file.peek() == std::ifstream::traits_type::eof());
+
+        std::function<void()> on_ready;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (failed)
+            {
+                _failed = true;
+                _finished = true;
+            }
+            else
+            {
+                const uint8_t* data = buffer.data();
+                _ready.emplace_back(chunk_t{ data, read_len, last, std::move(buffer) });
+                _finished = last;
+            }
+
+            if (!_closed)
+                on_ready = _on_ready;
+        }
+
+        if (on_ready)
+            on_ready();
+    }
+}
+
+chunk_prefetcher::chunk_t* chunk_prefetcher::front()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    if (_mapping != nullptr)
+    {
+        if (_closed || _mapping_offset >= _mapping->size())
+            return nullptr;
+
+        size_t size = std::min<size_t>(_chunk_size, _mapping->size() - _mapping_offset);
+        _mapped_chunk.data = _mapping->data() + _mapping_offset;
+        _mapped_chunk.size = size;
+        _mapped_chunk.last = (_mapping_offset + size == _mapping->size());
+        return &_mapped_chunk;
+    }
+
+    // deque::emplace_back doesn't move the existing elements
+    return _ready.empty() ? nullptr : &_ready.front();
+}
+
+void chunk_prefetcher::pop()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    if (_mapping != nullptr)
+    {
+        _mapping_offset += _mapped_chunk.size;
+        return;
+    }
+
+    if (_ready.empty())
+        return;
+
+    _free_buffers.emplace_back(std::move(_ready.front().buffer));
+    _ready.pop_front();
+    schedule_read();
+}
+
+bool chunk_prefetcher::failed()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _failed;
+}
+
+void chunk_prefetcher::close()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _closed = true;
+    _on_ready = nullptr;
+    _ready.clear();
+    // The mapping stays alive while another read of the same file uses it
+    _mapping.reset();
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+#include "io_pool.h"
+#include "mapped_file.h"
+
+// Reads a file chunk by chunk on the io_pool, keeping up to depth chunks ahead of the game.
+// The game thread only hands out the chunks that are ready, it never reads the file itself.
+// When the file can be mapped, the chunks point straight into the mapping and nothing is read nor copied.
+class chunk_prefetcher :
+    public std::enable_shared_from_this<chunk_prefetcher>
+{
+public:
+    struct chunk_t
+    {
+        const uint8_t* data;
+        size_t size;
+        bool last;
+        // Owns data when the chunk was read with buffered I/O, empty for a mapped chunk
+        std::vector<uint8_t> buffer;
+    };
+
+private:
+    io_pool& _pool;
+    mapped_file_cache* _mapped_files;
+    // Set when the file is mapped, the chunks are then views into it
+    std::shared_ptr<mapped_file> _mapping;
+    size_t _mapping_offset;
+    chunk_t _mapped_chunk;
+    std::mutex _mutex;
+    // Only used by the read job, there is never more than one at a time
+    std::ifstream _file;
+    std::deque<chunk_t> _ready;
+    std::vector<std::vector<uint8_t>> _free_buffers;
+    std::function<void()> _on_ready;
+    uint32_t _chunk_size;
+    size_t _depth;
+    bool _reading;
+    bool _finished;
+    bool _failed;
+    bool _closed;
+
+    // _mutex must be held
+    void schedule_read();
+    void read_job();
+
+public:
+    // A double buffer: one chunk for the game while the next one is read
+    static constexpr size_t default_depth = 2;
+
+    // mapped_files can be nullptr to always use buffered I/O
+    chunk_prefetcher(io_pool& pool, mapped_file_cache* mapped_files, uint32_t chunk_size, size_t depth = default_depth);
+
+    // Opens the file and starts prefetching, on_ready is called from an I/O thread each time a chunk is ready.
+    // A mapped file has all its chunks ready once started, on_ready is never called for it
+    bool start(std::string const& file_path, std::function<void()> on_ready);
+    // The oldest ready chunk or nullptr, it stays valid until pop()
+    chunk_t* front();
+    void pop();
+    // The file couldn't be read, no more chunk will come
+    bool failed();
+    // Stops the prefetching, a running read can still call on_ready once
+    void close();
+};
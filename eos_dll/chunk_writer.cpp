@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "chunk_writer.h"
+
+constexpr decltype(chunk_writer::default_depth) chunk_writer::default_depth;
+
+chunk_writer::chunk_writer(io_pool& pool, mapped_file_cache* mapped_files, size_t buffer_size, size_t depth):
+    _pool(pool),
+    _mapped_files(mapped_files),
+    _buffer_size(buffer_size),
+    _depth(std::max<size_t>(depth, 1)),
+    _allocated(0),
+    _writing(false),
+    _completing(false),
+    _finished(false),
+    _failed(false),
+    _closed(false),
+    _file_info{}
+{}
+
+bool chunk_writer::start(std::string const& file_path, std::string const& temp_path, std::function<void()> on_ready)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    _file_path = file_path;
+    _temp_path = temp_path;
+    _file = FileManager::open_write(_temp_path, std::ios::binary | std::ios::trunc);
+    if (!_file)
+    {
+        _failed = true;
+        _finished = true;
+        return false;
+    }
+
+    _on_ready = std::move(on_ready);
+    return true;
+}
+
+void chunk_writer::schedule_write()
+{
+    if (_writing || _finished || _closed || (_pending.empty() && !_completing))
+        return;
+
+    _writing = true;
+    auto self = shared_from_this();
+    _pool.post([self]() { self->write_job(); });
+}
+
+void chunk_writer::write_job()
+{
+    for (;;)
+    {
+        chunk_t chunk;
+        bool last;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (_closed && !_completing && !_finished)
+            {// Abandoned, nobody will pick the file
+                _writing = false;
+                _finished = true;
+                _failed = true;
+                _file.close();
+                FileManager::delete_file(_temp_path);
+                return;
+            }
+
+            if (_finished || (_pending.empty() && !_completing))
+            {
+                _writing = false;
+                return;
+            }
+
+            // Nothing left to write and the game completed the request
+            last = _pending.empty();
+            if (!last)
+            {
+                chunk = std::move(_pending.front());
+                _pending.pop_front();
+            }
+        }
+
+        bool failed;
+        if (last)
+        {
+            failed = !commit();
+        }
+        else
+        {
+            _file.write(reinterpret_cast<const char*>(chunk.buffer.data()), chunk.size);
+            _hash.update(chunk.buffer.data(), static_cast<MD5::size_type>(chunk.size));
+            failed = _file.fail();
+        }
+
+        std::function<void()> on_ready;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (!chunk.buffer.empty())
+                _free_buffers.emplace_back(std::move(chunk.buffer));
+
+            if (failed)
+            {
+                _failed = true;
+                _finished = true;
+                _file.close();
+                FileManager::delete_file(_temp_path);
+            }
+            else if (last)
+            {
+                _finished = true;
+            }
+
+            if (!_closed)
+                on_ready = _on_ready;
+        }
+
+        if (on_ready)
+            on_ready();
+    }
+}
+
+bool chunk_writer::commit()
+{
+    _file.close();
+    if (_file.fail())
+        return false;
+
+    // Don't report the file as written before it reached the disk
+    if (!FileManager::sync_file(_temp_path) || !FileManager::file_info(_temp_path, _file_info))
+        return false;
+
+    // Windows can't replace a mapped file, the reads still running keep their own mapping
+    if (_mapped_files != nullptr)
+        _mapped_files->invalidate(_file_path);
+
+    if (!FileManager::rename_file(_temp_path, _file_path))
+        return false;
+
+    _md5sum = _hash.finalize().hexdigest();
+    return true;
+}
+
+uint8_t* chunk_writer::buffer()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    if (_finished || _closed || _completing)
+        return nullptr;
+
+    if (_current.empty())
+    {
+        if (!_free_buffers.empty())
+        {
+            _current = std::move(_free_buffers.back());
+            _free_buffers.pop_back();
+        }
+        else if (_allocated < _depth)
+        {
+            ++_allocated;
+        }
+        else
+        {
+            return nullptr;
+        }
+
+        _current.resize(_buffer_size);
+    }
+
+    return _current.data();
+}
+
+void chunk_writer::push(size_t size)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    // An empty chunk keeps its buffer for the next one
+    if (_current.empty() || size == 0)
+        return;
+
+    _pending.emplace_back(chunk_t{ std::move(_current), std::min(size, _buffer_size) });
+    _current = std::vector<uint8_t>();
+    schedule_write();
+}
+
+void chunk_writer::complete()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _completing = true;
+    schedule_write();
+}
+
+bool chunk_writer::completing()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _completing;
+}
+
+bool chunk_writer::finished()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _finished;
+}
+
+bool chunk_writer::failed()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _failed;
+}
+
+FileManager::file_info_t const& chunk_writer::file_info() const
+{
+    return _file_info;
+}
+
+std::string const& chunk_writer::md5sum() const
+{
+    return _md5sum;
+}
+
+void chunk_writer::close()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _closed = true;
+    _on_ready = nullptr;
+    _current = std::vector<uint8_t>();
+
+    // The game completed the request: the pending chunks are still written and the file replaced
+    if (_completing)
+        return;
+
+    _pending.clear();
+    // A running write job cleans up itself
+    if (!_writing && !_finished)
+    {
+        _finished = true;
+        _failed = true;
+        _file.close();
+        FileManager::delete_file(_temp_path);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+#include "io_pool.h"
+#include "mapped_file.h"
+
+// Writes a file chunk by chunk on the io_pool and hashes it on the way, the game thread only fills the buffers.
+// The chunks go to a temporary file that replaces the destination once complete,
+// so a failed or canceled write never leaves a partial file behind.
+class chunk_writer :
+    public std::enable_shared_from_this<chunk_writer>
+{
+    struct chunk_t
+    {
+        std::vector<uint8_t> buffer;
+        size_t size;
+    };
+
+    io_pool& _pool;
+    mapped_file_cache* _mapped_files;
+    std::mutex _mutex;
+    // Only used by the write job, there is never more than one at a time
+    std::ofstream _file;
+    MD5 _hash;
+    std::string _file_path;
+    std::string _temp_path;
+    // The buffer handed out by buffer(), game thread only
+    std::vector<uint8_t> _current;
+    std::deque<chunk_t> _pending;
+    std::vector<std::vector<uint8_t>> _free_buffers;
+    std::function<void()> _on_ready;
+    size_t _buffer_size;
+    size_t _depth;
+    size_t _allocated;
+    bool _writing;
+    bool _completing;
+    bool _finished;
+    bool _failed;
+    bool _closed;
+    FileManager::file_info_t _file_info;
+    std::string _md5sum;
+
+    // _mutex must be held
+    void schedule_write();
+    void write_job();
+    // Closes, syncs and renames the temporary file, returns false if any of it failed
+    bool commit();
+
+public:
+    // A double buffer: one chunk filled by the game while the previous one is written
+    static constexpr size_t default_depth = 2;
+
+    // mapped_files can be nullptr, otherwise the destination mapping is dropped before it is replaced
+    chunk_writer(io_pool& pool, mapped_file_cache* mapped_files, size_t buffer_size, size_t depth = default_depth);
+
+    // Creates the temporary file, on_ready is called from an I/O thread each time a buffer is free again and once finished
+    bool start(std::string const& file_path, std::string const& temp_path, std::function<void()> on_ready);
+    // A buffer of buffer_size bytes to fill, nullptr while all of them are waiting to be written
+    uint8_t* buffer();
+    // Queues the buffer returned by buffer(), size bytes of it were filled
+    void push(size_t size);
+    // No more chunk will come, the destination is replaced once they are all written
+    void complete();
+    bool completing();
+    // The file was written or the write failed, no more chunk is accepted
+    bool finished();
+    bool failed();
+    // Valid once finished without failure, the info and the md5 of the new file
+    FileManager::file_info_t const& file_info() const;
+    std::string const& md5sum() const;
+    // Abandons the write and deletes the temporary file, unless complete() was called. A running write can still call on_ready once
+    void close();
+};
@@ -45,6 +45,8 @@
     #include <sys/types.h>
     #include <sys/ioctl.h> // get iface broadcast
     #include <sys/stat.h>  // stats on a file (is directory, size, mtime)
+    #include <fcntl.h>     // open a file descriptor (fsync)
+    #include <sys/mman.h>  // mmap the storage files
 
     #include <dirent.h> // go open directories
     #include <dlfcn.h>  // dlopen (like dll for linux)
@@ -101,6 +103,7 @@ using fifo_json = nlohmann::basic_json<my_fifo_map>;
 
 #include <thread>
 #include <mutex>
+#include <shared_mutex>
 #include <limits>
 #include <chrono>
 #include <locale>
@@ -108,6 +111,7 @@ using fifo_json = nlohmann::basic_json<my_fifo_map>;
 #include <random>
 #include <string>
 #include <vector>
+#include <array>
 #include <list>
 #include <queue>
 #include <map>
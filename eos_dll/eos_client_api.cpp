@@ -27,13 +27,7 @@ EOSSDK_Client::EOSSDK_Client():
 {}
 
 EOSSDK_Client::~EOSSDK_Client()
-{
-    for (auto& id : _epicuserids)
-        delete id.second;
-
-    for (auto& id : _productuserids)
-        delete id.second;
-}
+{}
 
 EOSSDK_Client& EOSSDK_Client::Inst()
 {
@@ -43,42 +37,18 @@ EOSSDK_Client& EOSSDK_Client::Inst()
 
 EOS_EpicAccountId EOSSDK_Client::get_epicuserid(std::string const& userid)
 {
-    EOS_EpicAccountId res;
     if (userid.empty())
         return GetInvalidEpicUserId();
 
-    auto it = _epicuserids.find(userid);
-    if (it == _epicuserids.end())
-    {
-        EOS_EpicAccountId& accountid = _epicuserids[userid];
-        accountid = new EOS_EpicAccountIdDetails;
-        accountid->from_string(userid);
-        res = accountid;
-    }
-    else
-        res = it->second;
-
-    return res;
+    return _epicuserids.get(userid);
 }
 
 EOS_ProductUserId EOSSDK_Client::get_productuserid(std::string const& userid)
 {
-    EOS_ProductUserId res;
     if (userid.empty())
         return GetInvalidProductUserId();
 
-    auto it = _productuserids.find(userid);
-    if (it == _productuserids.end())
-    {
-        EOS_ProductUserId& accountid = _productuserids[userid];
-        accountid = new EOS_ProductUserIdDetails;
-        accountid->from_string(userid);
-        res = accountid;
-    }
-    else
-        res = it->second;
-
-    return res;
+    return _productuserids.get(userid);
 }
 
 /**
@@ -473,12 +443,7 @@ EOS_DECLARE_FUNC(EOS_Bool) EOS_EpicAccountId_IsValid(EOS_EpicAccountId AccountId
     if (AccountId == nullptr)
         return EOS_FALSE;
 
-    auto& user_ids = EOSSDK_Client::Inst()._epicuserids;
-    auto it = std::find_if(user_ids.begin(), user_ids.end(), [AccountId](std::pair<std::string const, EOS_EpicAccountId>& user_id)
-    {
-        return user_id.second == AccountId;
-    });
-    if (it == user_ids.end())
+    if (!EOSSDK_Client::Inst()._epicuserids.contains(AccountId))
     {
         APP_LOG(Log::LogLevel::WARN, "Epic User Id (%p) not found in the cache, wrong parameter returned in a function ?", AccountId);
         return EOS_FALSE;
@@ -513,12 +478,7 @@ EOS_DECLARE_FUNC(EOS_EResult) EOS_EpicAccountId_ToString(EOS_EpicAccountId Accou
     if (AccountId == nullptr || !AccountId->IsValid())
         return EOS_EResult::EOS_InvalidUser;
 
-    auto& user_ids = EOSSDK_Client::Inst()._epicuserids;
-    auto it = std::find_if(user_ids.begin(), user_ids.end(), [AccountId](std::pair<std::string const, EOS_EpicAccountId>& user_id)
-    {
-        return user_id.second == AccountId;
-    });
-    if (it == user_ids.end())
+    if (!EOSSDK_Client::Inst()._epicuserids.contains(AccountId))
     {
         APP_LOG(Log::LogLevel::WARN, "Epic User Id (%p) not found in the cache, wrong parameter returned in a function ?", AccountId);
         return EOS_EResult::EOS_InvalidUser;
@@ -559,12 +519,7 @@ EOS_DECLARE_FUNC(EOS_Bool) EOS_ProductUserId_IsValid(EOS_ProductUserId AccountId
     if (AccountId == nullptr)
         return EOS_FALSE;
 
-    auto& product_ids = EOSSDK_Client::Inst()._productuserids;
-    auto it = std::find_if(product_ids.begin(), product_ids.end(), [AccountId]( std::pair<std::string const, EOS_ProductUserId>& product_id)
-    {
-        return product_id.second == AccountId;
-    });
-    if (it == product_ids.end())
+    if (!EOSSDK_Client::Inst()._productuserids.contains(AccountId))
     {
         APP_LOG(Log::LogLevel::WARN, "Product User Id (%p) not found in the cache, wrong parameter returned in a function ?", AccountId);
         return EOS_FALSE;
@@ -595,12 +550,7 @@ EOS_DECLARE_FUNC(EOS_EResult) EOS_ProductUserId_ToString(EOS_ProductUserId Accou
     if (AccountId == nullptr || !AccountId->IsValid())
         return EOS_EResult::EOS_InvalidUser;
 
-    auto& product_ids = EOSSDK_Client::Inst()._productuserids;
-    auto it = std::find_if(product_ids.begin(), product_ids.end(), [AccountId]( std::pair<std::string const, EOS_ProductUserId>& product_id)
-    {
-        return product_id.second == AccountId;
-    });
-    if (it == product_ids.end())
+    if (!EOSSDK_Client::Inst()._productuserids.contains(AccountId))
     {
         APP_LOG(Log::LogLevel::WARN, "Product User Id (%p) not found in the cache, wrong parameter returned in a function ?", AccountId);
         return EOS_EResult::EOS_InvalidUser;
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "common_includes.h"
+#include "id_registry.h"
 
 class EOSSDK_Client
 {
@@ -54,8 +55,8 @@ public:
 
     bool _sdk_initialized;
 
-    std::map<std::string, EOS_EpicAccountId> _epicuserids;
-    std::map<std::string, EOS_ProductUserId> _productuserids;
+    id_registry<EOS_EpicAccountIdDetails> _epicuserids;
+    id_registry<EOS_ProductUserIdDetails> _productuserids;
 
     int32_t api_version;
     std::string _product_name;
@@ -1,217 +1,132 @@
 #include "eos_epicaccountiddetails.h"
 
-EOS_EpicAccountIdDetails::EOS_EpicAccountIdDetails():
-    _idstr(sdk::NULL_USER_ID),
-    _valid(false)
-{}
-
-EOS_EpicAccountIdDetails::EOS_EpicAccountIdDetails(EOS_EpicAccountIdDetails && other) noexcept :
-    _idstr(std::move(other._idstr)),
-    _valid(std::move(other._valid))
-{}
-
-EOS_EpicAccountIdDetails::~EOS_EpicAccountIdDetails()
-{}
-
-EOS_EpicAccountIdDetails& EOS_EpicAccountIdDetails::operator=(EOS_EpicAccountIdDetails && other) noexcept
+bool id128_t::parse(const char* str, size_t len, id128_t& out)
 {
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    _idstr = std::move(other._idstr);
-    _valid = other._valid;
-    return *this;
-}
+    if (len != 32)
+        return false;
 
-EOS_Bool EOS_EpicAccountIdDetails::IsValid()
-{
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    return _valid;
-}
-
-EOS_EResult EOS_EpicAccountIdDetails::ToString(char* outBuffer, int32_t* outBufferSize)
-{
-    std::lock_guard<std::mutex> lk(_local_mutex);
-
-    if (outBuffer == nullptr || outBufferSize == nullptr)
-        return EOS_EResult::EOS_InvalidParameters;
-
-    size_t len = _idstr.length() + 1;
-    if (*outBufferSize < len)
+    uint64_t parts[2] = {};
+    for (size_t i = 0; i < 32; ++i)
     {
-        *outBufferSize = static_cast<int32_t>(len);
-        return EOS_EResult::EOS_LimitExceeded;
+        char c = str[i];
+        uint64_t nibble;
+        if (c >= '0' && c <= '9')
+            nibble = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            nibble = c - 'a' + 10;
+        else
+            return false;
+
+        parts[i / 16] = (parts[i / 16] << 4) | nibble;
     }
 
-    strncpy(outBuffer, _idstr.c_str(), len);
-    *outBufferSize = static_cast<int32_t>(len);
-    return EOS_EResult::EOS_Success;
+    out.high = parts[0];
+    out.low = parts[1];
+    return true;
 }
 
-void EOS_EpicAccountIdDetails::FromString(const char* accountIdStr)
+std::string id128_t::to_string() const
 {
-    if (accountIdStr != nullptr)
-    {
-        from_string(accountIdStr);
-    }
-    else
+    static constexpr char hex_chars[] = "0123456789abcdef";
+
+    std::string res(32, '0');
+    for (size_t i = 0; i < 16; ++i)
     {
-        std::lock_guard<std::mutex> lk(_local_mutex);
-        _valid = false;
-        _idstr = sdk::NULL_USER_ID;
+        res[15 - i] = hex_chars[(high >> (i * 4)) & 0xf];
+        res[31 - i] = hex_chars[(low  >> (i * 4)) & 0xf];
     }
-}
-
-void EOS_EpicAccountIdDetails::from_string(std::string const& accountIdStr)
-{
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    _idstr = accountIdStr;
-    validate();
-}
 
-std::string const& EOS_EpicAccountIdDetails::to_string()
-{
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    return _idstr;
+    return res;
 }
 
-void EOS_EpicAccountIdDetails::validate()
+// Strips the "0x" prefix and checks the id is made of hex chars
+static bool validate_id(std::string& idstr)
 {
-    auto it = _idstr.begin();
-    _valid = false;
+    auto it = idstr.begin();
 
-    if (_idstr.length() > 2 &&
-        _idstr[0] == '0' &&
-        _idstr[1] == 'x')
+    if (idstr.length() > 2 &&
+        idstr[0] == '0' &&
+        idstr[1] == 'x')
     {
-        it = _idstr.erase(_idstr.begin(), _idstr.begin() + 2);
+        it = idstr.erase(idstr.begin(), idstr.begin() + 2);
     }
 
     // Don't change this for now, some ids are not 32 chars long
-    if (it != _idstr.end())
-    {
-        if (std::string(it, _idstr.end()) == sdk::NULL_USER_ID)
-            return;
+    if (it == idstr.end() || idstr == sdk::NULL_USER_ID)
+        return false;
 
-        _valid = true;
-        for (; it != _idstr.end(); ++it)
+    for (; it != idstr.end(); ++it)
+    {
+        char c = *it;
+        if ((c < '0' || c > '9') &&
+            (c < 'A' || c > 'F') &&
+            (c < 'a' || c > 'f')
+            )
         {
-            char c = *it;
-            if ((c < '0' || c > '9') &&
-                (c < 'A' || c > 'F') &&
-                (c < 'a' || c > 'f')
-                )
-            {
-                _valid = false;
-                return;
-            }
+            return false;
         }
     }
-}
-
-/////////////////////////////////////////////////////////
-
-EOS_ProductUserIdDetails::EOS_ProductUserIdDetails() :
-    _idstr(),
-    _valid(false)
-{}
 
-EOS_ProductUserIdDetails::EOS_ProductUserIdDetails(EOS_ProductUserIdDetails&& other) noexcept :
-    _idstr(std::move(other._idstr)),
-    _valid(std::move(other._valid))
-{}
-
-EOS_ProductUserIdDetails::~EOS_ProductUserIdDetails()
-{}
-
-EOS_ProductUserIdDetails& EOS_ProductUserIdDetails::operator=(EOS_ProductUserIdDetails&& other) noexcept
-{
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    _idstr = std::move(other._idstr);
-    _valid = other._valid;
-    return *this;
-}
-
-EOS_Bool EOS_ProductUserIdDetails::IsValid()
-{
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    return _valid;
+    return true;
 }
 
-EOS_EResult EOS_ProductUserIdDetails::ToString(char* outBuffer, int32_t* outBufferSize)
+static EOS_EResult copy_id_string(std::string const& idstr, char* outBuffer, int32_t* outBufferSize)
 {
-    std::lock_guard<std::mutex> lk(_local_mutex);
-
     if (outBuffer == nullptr || outBufferSize == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
 
-    size_t len = _idstr.length() + 1;
+    size_t len = idstr.length() + 1;
     if (*outBufferSize < len)
     {
         *outBufferSize = static_cast<int32_t>(len);
         return EOS_EResult::EOS_LimitExceeded;
     }
 
-    strncpy(outBuffer, _idstr.c_str(), len);
+    strncpy(outBuffer, idstr.c_str(), len);
     *outBufferSize = static_cast<int32_t>(len);
     return EOS_EResult::EOS_Success;
 }
 
-void EOS_ProductUserIdDetails::FromString(const char* accountIdStr)
+EOS_EpicAccountIdDetails::EOS_EpicAccountIdDetails(std::string const& accountIdStr):
+    _idstr(accountIdStr),
+    _id{}
 {
-    if (accountIdStr != nullptr)
-    {
-        from_string(accountIdStr);
-    }
-    else
-    {
-        std::lock_guard<std::mutex> lk(_local_mutex);
-        _idstr = sdk::NULL_USER_ID;
-        _valid = false;
-    }
+    _valid = validate_id(_idstr);
+    _canonical = id128_t::parse(_idstr.c_str(), _idstr.length(), _id);
 }
 
-std::string const& EOS_ProductUserIdDetails::to_string()
+EOS_EpicAccountIdDetails::~EOS_EpicAccountIdDetails()
+{}
+
+EOS_Bool EOS_EpicAccountIdDetails::IsValid() const
 {
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    return _idstr;
+    return _valid;
 }
 
-void EOS_ProductUserIdDetails::from_string(std::string const& accountIdStr)
+EOS_EResult EOS_EpicAccountIdDetails::ToString(char* outBuffer, int32_t* outBufferSize) const
 {
-    std::lock_guard<std::mutex> lk(_local_mutex);
-    _idstr = accountIdStr;
-    validate();
+    return copy_id_string(_idstr, outBuffer, outBufferSize);
 }
 
-void EOS_ProductUserIdDetails::validate()
+/////////////////////////////////////////////////////////
+
+EOS_ProductUserIdDetails::EOS_ProductUserIdDetails(std::string const& accountIdStr):
+    _idstr(accountIdStr),
+    _id{}
 {
-    auto it = _idstr.begin();
-    _valid = false;
+    _valid = validate_id(_idstr);
+    _canonical = id128_t::parse(_idstr.c_str(), _idstr.length(), _id);
+}
 
-    if (_idstr.length() > 2 &&
-        _idstr[0] == '0' &&
-        _idstr[1] == 'x')
-    {
-        it = _idstr.erase(_idstr.begin(), _idstr.begin() + 2);
-    }
+EOS_ProductUserIdDetails::~EOS_ProductUserIdDetails()
+{}
 
-    // Don't change this for now, some ids are not 32 chars long
-    if (it != _idstr.end())
-    {
-        if (std::string(it, _idstr.end()) == sdk::NULL_USER_ID)
-            return;
+EOS_Bool EOS_ProductUserIdDetails::IsValid() const
+{
+    return _valid;
+}
 
-        _valid = true;
-        for (; it != _idstr.end(); ++it)
-        {
-            char c = *it;
-            if ((c < '0' || c > '9') &&
-                (c < 'A' || c > 'F') &&
-                (c < 'a' || c > 'f')
-                )
-            {
-                _valid = false;
-                return;
-            }
-        }
-    }
-}
\ No newline at end of file
+EOS_EResult EOS_ProductUserIdDetails::ToString(char* outBuffer, int32_t* outBufferSize) const
+{
+    return copy_id_string(_idstr, outBuffer, outBufferSize);
+}
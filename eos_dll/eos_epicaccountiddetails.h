@@ -20,10 +20,10 @@
 #pragma once
 
 #include "common_includes.h"
-#include <mutex>
-
 
 class EOSSDK_Client;
+template<typename IdDetails>
+class id_registry;
 
 namespace sdk
 {
@@ -33,63 +33,76 @@ namespace sdk
     static constexpr size_t max_productid_length = EOS_PRODUCTUSERID_MAX_LENGTH + 1;
 }
 
+// Binary form of an id written as 32 lower case hex chars, the form generate_account_id() produces
+struct id128_t
+{
+    uint64_t high;
+    uint64_t low;
+
+    // Returns false if str is not in the canonical form
+    static bool parse(const char* str, size_t len, id128_t& out);
+    // Canonical form
+    std::string to_string() const;
+
+    inline size_t hash() const { return static_cast<size_t>((high ^ (low * 0x9E3779B97F4A7C15ULL)) * 0xBF58476D1CE4E5B9ULL); }
+
+    inline bool operator ==(id128_t const& other) const { return high == other.high && low == other.low; }
+    inline bool operator !=(id128_t const& other) const { return !(*this == other); }
+};
+
+// Ids are interned by id_registry and never change once created, they can be read from any thread without locking.
 struct EOS_EpicAccountIdDetails
 {
-    friend class EOSSDK_Client;
+    friend class id_registry<EOS_EpicAccountIdDetails>;
 
 private:
-    std::mutex _local_mutex;
     std::string _idstr;
+    id128_t _id;
+    bool _canonical;
     bool _valid;
 
-    EOS_EpicAccountIdDetails();
-    EOS_EpicAccountIdDetails(EOS_EpicAccountIdDetails &&) noexcept;
-
-    EOS_EpicAccountIdDetails& operator=(EOS_EpicAccountIdDetails&&) noexcept;
-
-    void FromString(const char* accountIdStr);
-    void from_string(std::string const& accountIdStr);
-    void validate();
+    EOS_EpicAccountIdDetails(std::string const& accountIdStr);
+    EOS_EpicAccountIdDetails(EOS_EpicAccountIdDetails const&) = delete;
+    EOS_EpicAccountIdDetails& operator=(EOS_EpicAccountIdDetails const&) = delete;
 
     ~EOS_EpicAccountIdDetails();
 public:
-    
-
-    EOS_Bool IsValid();
-    EOS_EResult ToString(char* outBuffer, int32_t* outBufferSize);
+    EOS_Bool IsValid() const;
+    EOS_EResult ToString(char* outBuffer, int32_t* outBufferSize) const;
 
-    std::string const& to_string();
+    inline std::string const& to_string() const { return _idstr; }
+    // Only meaningful if is_canonical()
+    inline id128_t const& to_id128() const { return _id; }
+    inline bool is_canonical() const { return _canonical; }
 
-    inline bool operator ==(EOS_EpicAccountIdDetails const& other) { return (_idstr == other._idstr); }
-    inline bool operator !=(EOS_EpicAccountIdDetails const& other) { return !(*this == other); }
+    inline bool operator ==(EOS_EpicAccountIdDetails const& other) const { return (_idstr == other._idstr); }
+    inline bool operator !=(EOS_EpicAccountIdDetails const& other) const { return !(*this == other); }
 };
 
 struct EOS_ProductUserIdDetails
 {
-    friend class EOSSDK_Client;
+    friend class id_registry<EOS_ProductUserIdDetails>;
 
 private:
-    std::mutex _local_mutex;
     std::string _idstr;
+    id128_t _id;
+    bool _canonical;
     bool _valid;
 
-    EOS_ProductUserIdDetails();
-    EOS_ProductUserIdDetails(EOS_ProductUserIdDetails&&) noexcept;
-
-    EOS_ProductUserIdDetails& operator=(EOS_ProductUserIdDetails&&) noexcept;
-
-    void FromString(const char* accountIdStr);
-    void from_string(std::string const& accountIdStr);
-    void validate();
+    EOS_ProductUserIdDetails(std::string const& accountIdStr);
+    EOS_ProductUserIdDetails(EOS_ProductUserIdDetails const&) = delete;
+    EOS_ProductUserIdDetails& operator=(EOS_ProductUserIdDetails const&) = delete;
 
     ~EOS_ProductUserIdDetails();
 public:
-    
-    EOS_Bool IsValid();
-    EOS_EResult ToString(char* outBuffer, int32_t* outBufferSize);
+    EOS_Bool IsValid() const;
+    EOS_EResult ToString(char* outBuffer, int32_t* outBufferSize) const;
 
-    std::string const& to_string();
+    inline std::string const& to_string() const { return _idstr; }
+    // Only meaningful if is_canonical()
+    inline id128_t const& to_id128() const { return _id; }
+    inline bool is_canonical() const { return _canonical; }
 
-    inline bool operator ==(EOS_ProductUserIdDetails const& other) { return (_idstr == other._idstr); }
-    inline bool operator !=(EOS_ProductUserIdDetails const& other) { return !(*this == other); }
-};
\ No newline at end of file
+    inline bool operator ==(EOS_ProductUserIdDetails const& other) const { return (_idstr == other._idstr); }
+    inline bool operator !=(EOS_ProductUserIdDetails const& other) const { return !(*this == other); }
+};
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Emulator only P2P functions, they are not part of the Epic SDK.
+// Games built against the emulator can resolve them with GetProcAddress/dlsym.
+
+#include <eos_p2p_types.h>
+
+#define EOS_P2P_RECEIVEPACKETSEXT_API_LATEST 1
+/**
+ * Structure containing information about the packets to receive
+ */
+EOS_STRUCT(EOS_P2P_ReceivePacketsExtOptions, (
+	/** API Version: Set this to EOS_P2P_RECEIVEPACKETSEXT_API_LATEST. */
+	int32_t ApiVersion;
+	/** The Product User ID of the user who is receiving the packets */
+	EOS_ProductUserId LocalUserId;
+	/** An optional channel to request the data for. If NULL, we're retrieving the packets from any channel */
+	const uint8_t* RequestedChannel;
+	/** The maximum number of packets to receive, OutPackets must hold at least that many entries */
+	uint32_t MaxPackets;
+	/** The size of the OutData buffer, all the packets data are written back to back in it */
+	uint32_t MaxDataSizeBytes;
+));
+
+/**
+ * Description of a packet received by EOS_P2P_ReceivePacketsExt
+ */
+EOS_STRUCT(EOS_P2P_ReceivedPacketExt, (
+	/** The Remote User who sent the data */
+	EOS_ProductUserId PeerId;
+	/** The Socket ID of the data that was sent */
+	EOS_P2P_SocketId SocketId;
+	/** The channel the data was sent on */
+	uint8_t Channel;
+	/** Where the packet data starts in OutData */
+	uint32_t DataOffset;
+	/** The packet data size */
+	uint32_t DataLengthBytes;
+));
+
+/**
+ * Receive as many packets as possible for the local user in a single call.
+ * Packets are returned in the same order as EOS_P2P_ReceivePacket would return them. It stops when MaxPackets
+ * packets were received or when the next packet doesn't fit in the remaining space of OutData.
+ * If the first packet is bigger than OutData, it is truncated like EOS_P2P_ReceivePacket does.
+ *
+ * @param Options Information about who is receiving the packets, and how much can be stored safely
+ * @param OutPackets Array of at least MaxPackets entries, filled with the received packets descriptions
+ * @param OutData Buffer of MaxDataSizeBytes bytes that receives the packets data
+ * @param OutPacketCount The number of packets written to OutPackets
+ * @param OutBytesWritten The amount of bytes written to OutData
+ * @return EOS_EResult::EOS_Success - If at least one packet was received
+ *         EOS_EResult::EOS_InvalidParameters - If input was invalid
+ *         EOS_EResult::EOS_NotFound - If there are no packets available for the requesting user
+ */
+EOS_DECLARE_FUNC(EOS_EResult) EOS_P2P_ReceivePacketsExt(EOS_HP2P Handle, const EOS_P2P_ReceivePacketsExtOptions* Options, EOS_P2P_ReceivedPacketExt* OutPackets, void* OutData, uint32_t* OutPacketCount, uint32_t* OutBytesWritten);
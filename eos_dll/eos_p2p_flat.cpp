@@ -48,6 +48,15 @@ EOS_DECLARE_FUNC(EOS_EResult) EOS_P2P_ReceivePacket(EOS_HP2P Handle, const EOS_P
     return pInst->ReceivePacket(Options, OutPeerId, OutSocketId, OutChannel, OutData, OutBytesWritten);
 }
 
+EOS_DECLARE_FUNC(EOS_EResult) EOS_P2P_ReceivePacketsExt(EOS_HP2P Handle, const EOS_P2P_ReceivePacketsExtOptions* Options, EOS_P2P_ReceivedPacketExt* OutPackets, void* OutData, uint32_t* OutPacketCount, uint32_t* OutBytesWritten)
+{
+    if (Handle == nullptr)
+        return EOS_EResult::EOS_InvalidParameters;
+
+    auto pInst = reinterpret_cast<EOSSDK_P2P*>(Handle);
+    return pInst->ReceivePacketsExt(Options, OutPackets, OutData, OutPacketCount, OutBytesWritten);
+}
+
 EOS_DECLARE_FUNC(EOS_NotificationId) EOS_P2P_AddNotifyPeerConnectionRequest(EOS_HP2P Handle, const EOS_P2P_AddNotifyPeerConnectionRequestOptions* Options, void* ClientData, EOS_P2P_OnIncomingConnectionRequestCallback ConnectionRequestHandler)
 {
     if (Handle == nullptr)
@@ -625,7 +625,7 @@ EOS_EResult EOSSDK_Achievements::CopyAchievementDefinitionV2ByAchievementId(cons
 void EOSSDK_Achievements::QueryPlayerAchievements(const EOS_Achievements_QueryPlayerAchievementsOptions* Options, void* ClientData, const EOS_Achievements_OnQueryPlayerAchievementsCompleteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -688,7 +688,7 @@ void EOSSDK_Achievements::QueryPlayerAchievements(const EOS_Achievements_QueryPl
 uint32_t EOSSDK_Achievements::GetPlayerAchievementCount(const EOS_Achievements_GetPlayerAchievementCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->UserId == nullptr || Options->UserId != GetEOS_Connect().get_myself()->first)
         return 0;
@@ -711,7 +711,7 @@ uint32_t EOSSDK_Achievements::GetPlayerAchievementCount(const EOS_Achievements_G
 EOS_EResult EOSSDK_Achievements::CopyPlayerAchievementByIndex(const EOS_Achievements_CopyPlayerAchievementByIndexOptions* Options, EOS_Achievements_PlayerAchievement** OutAchievement)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (Options->ApiVersion) {
         case EOS_ACHIEVEMENTS_COPYPLAYERACHIEVEMENTBYINDEX_API_002:
@@ -759,7 +759,7 @@ EOS_EResult EOSSDK_Achievements::CopyPlayerAchievementByIndex(const EOS_Achievem
 EOS_EResult EOSSDK_Achievements::CopyPlayerAchievementByAchievementId(const EOS_Achievements_CopyPlayerAchievementByAchievementIdOptions* Options, EOS_Achievements_PlayerAchievement** OutAchievement)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (Options->ApiVersion) {
         case EOS_ACHIEVEMENTS_COPYPLAYERACHIEVEMENTBYACHIEVEMENTID_API_002:
@@ -815,7 +815,7 @@ EOS_EResult EOSSDK_Achievements::CopyPlayerAchievementByAchievementId(const EOS_
 void EOSSDK_Achievements::UnlockAchievements(const EOS_Achievements_UnlockAchievementsOptions* Options, void* ClientData, const EOS_Achievements_OnUnlockAchievementsCompleteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -868,7 +868,7 @@ void EOSSDK_Achievements::UnlockAchievements(const EOS_Achievements_UnlockAchiev
 uint32_t EOSSDK_Achievements::GetUnlockedAchievementCount(const EOS_Achievements_GetUnlockedAchievementCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->UserId != GetEOS_Connect().get_myself()->first)
         return 0;
@@ -905,7 +905,7 @@ uint32_t EOSSDK_Achievements::GetUnlockedAchievementCount(const EOS_Achievements
 EOS_EResult EOSSDK_Achievements::CopyUnlockedAchievementByIndex(const EOS_Achievements_CopyUnlockedAchievementByIndexOptions* Options, EOS_Achievements_UnlockedAchievement** OutAchievement)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->UserId != GetEOS_Connect().get_myself()->first || Options->AchievementIndex >= _unlocked_achievements.size())
     {
@@ -934,7 +934,7 @@ EOS_EResult EOSSDK_Achievements::CopyUnlockedAchievementByIndex(const EOS_Achiev
 EOS_EResult EOSSDK_Achievements::CopyUnlockedAchievementByAchievementId(const EOS_Achievements_CopyUnlockedAchievementByAchievementIdOptions* Options, EOS_Achievements_UnlockedAchievement** OutAchievement)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->UserId != GetEOS_Connect().get_myself()->first || Options->AchievementId == nullptr)
     {
@@ -1100,7 +1100,7 @@ bool EOSSDK_Achievements::RunCallbacks(pFrameResult_t res)
 
 void EOSSDK_Achievements::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
@@ -28,6 +28,8 @@ namespace sdk
     class EOSSDK_Achievements :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
         static const std::string achievements_filename;
         static const std::string achievements_db_filename;
 
@@ -81,7 +81,7 @@ EOSSDK_Auth::~EOSSDK_Auth()
 void EOSSDK_Auth::Login(const EOS_Auth_LoginOptions* Options, void* ClientData, const EOS_Auth_OnLoginCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -160,7 +160,7 @@ void EOSSDK_Auth::Login(const EOS_Auth_LoginOptions* Options, void* ClientData,
 void EOSSDK_Auth::Logout(const EOS_Auth_LogoutOptions* Options, void* ClientData, const EOS_Auth_OnLogoutCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -202,7 +202,7 @@ void EOSSDK_Auth::Logout(const EOS_Auth_LogoutOptions* Options, void* ClientData
 void EOSSDK_Auth::LinkAccount(const EOS_Auth_LinkAccountOptions* Options, void* ClientData, const EOS_Auth_OnLinkAccountCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -238,7 +238,7 @@ void EOSSDK_Auth::LinkAccount(const EOS_Auth_LinkAccountOptions* Options, void*
 void EOSSDK_Auth::DeletePersistentAuth(const EOS_Auth_DeletePersistentAuthOptions* Options, void* ClientData, const EOS_Auth_OnDeletePersistentAuthCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -272,7 +272,7 @@ void EOSSDK_Auth::DeletePersistentAuth(const EOS_Auth_DeletePersistentAuthOption
 void EOSSDK_Auth::VerifyUserAuth(const EOS_Auth_VerifyUserAuthOptions* Options, void* ClientData, const EOS_Auth_OnVerifyUserAuthCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -302,7 +302,7 @@ void EOSSDK_Auth::VerifyUserAuth(const EOS_Auth_VerifyUserAuthOptions* Options,
 int32_t EOSSDK_Auth::GetLoggedInAccountsCount()
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return (_logged_in ? 1 : 0);
 }
@@ -317,7 +317,7 @@ int32_t EOSSDK_Auth::GetLoggedInAccountsCount()
 EOS_EpicAccountId EOSSDK_Auth::GetLoggedInAccountByIndex(int32_t Index)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Index == 0)
         return Settings::Inst().userid;
@@ -335,7 +335,7 @@ EOS_EpicAccountId EOSSDK_Auth::GetLoggedInAccountByIndex(int32_t Index)
 EOS_ELoginStatus EOSSDK_Auth::GetLoginStatus(EOS_EpicAccountId LocalUserId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (LocalUserId == Settings::Inst().userid)
         return (_logged_in ? EOS_ELoginStatus::EOS_LS_LoggedIn : EOS_ELoginStatus::EOS_LS_NotLoggedIn);
@@ -369,7 +369,7 @@ EOS_EResult EOSSDK_Auth::CopyUserAuthTokenOld(EOS_AccountId LocalUserId, EOS_Aut
 EOS_EResult EOSSDK_Auth::CopyUserAuthToken(const EOS_Auth_CopyUserAuthTokenOptions* Options, EOS_EpicAccountId LocalUserId, EOS_Auth_Token** OutUserAuthToken)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options->ApiVersion > EOS_AUTH_COPYUSERAUTHTOKEN_API_LATEST)
         return EOS_EResult::EOS_VersionMismatch;
@@ -449,7 +449,7 @@ EOS_NotificationId EOSSDK_Auth::AddNotifyLoginStatusChangedOld(void* ClientData,
 EOS_NotificationId EOSSDK_Auth::AddNotifyLoginStatusChanged(const EOS_Auth_AddNotifyLoginStatusChangedOptions* Options, void* ClientData, const EOS_Auth_OnLoginStatusChangedCallback Notification)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Notification == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -470,7 +470,7 @@ EOS_NotificationId EOSSDK_Auth::AddNotifyLoginStatusChanged(const EOS_Auth_AddNo
 void EOSSDK_Auth::RemoveNotifyLoginStatusChanged(EOS_NotificationId InId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     GetCB_Manager().remove_notification(this, InId);
 }
@@ -490,14 +490,14 @@ bool EOSSDK_Auth::RunNetwork(Network_Message_pb const& msg)
 
 bool EOSSDK_Auth::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;
 }
 
 void EOSSDK_Auth::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     //switch (res->res.m_iCallback)
     {
@@ -36,6 +36,8 @@ namespace sdk
         public IRunCallback,
         public IRunNetwork
     {
+        std::recursive_mutex local_mutex;
+
         bool _logged_in;
         std::string _access_token;
         std::chrono::system_clock::time_point _access_expires;
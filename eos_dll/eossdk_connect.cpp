@@ -114,6 +114,7 @@ void EOSSDK_Connect::Login(const EOS_Connect_LoginOptions* Options, void* Client
     res->done = true;
     GetCB_Manager().add_callback(this, res);
 
+    UNIQUE_LOCK(users_lk, users_mutex);
     get_myself()->second.connected = true;
 }
 
@@ -141,6 +142,7 @@ void EOSSDK_Connect::CreateUser(const EOS_Connect_CreateUserOptions* Options, vo
     res->done = true;
     GetCB_Manager().add_callback(this, res);
 
+    UNIQUE_LOCK(users_lk, users_mutex);
     get_myself()->second.connected = true;
 }
 
@@ -502,6 +504,7 @@ EOS_ProductUserId EOSSDK_Connect::GetExternalAccountMapping(const EOS_Connect_Ge
     if (Options == nullptr || Options->TargetExternalUserId == nullptr || Options->AccountIdType != EOS_EExternalAccountType::EOS_EAT_EPIC)
         return GetInvalidProductUserId();
 
+    SHARED_LOCK(users_lk, users_mutex);
     for (auto const& user : _users)
     {
         if (user.second.infos.userid() == Options->TargetExternalUserId)
@@ -617,7 +620,7 @@ EOS_ELoginStatus EOSSDK_Connect::GetLoginStatus(EOS_ProductUserId LocalUserId)
 EOS_NotificationId EOSSDK_Connect::AddNotifyAuthExpiration(const EOS_Connect_AddNotifyAuthExpirationOptions* Options, void* ClientData, const EOS_Connect_OnAuthExpirationCallback Notification)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Notification == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -640,7 +643,7 @@ EOS_NotificationId EOSSDK_Connect::AddNotifyAuthExpiration(const EOS_Connect_Add
 void EOSSDK_Connect::RemoveNotifyAuthExpiration(EOS_NotificationId InId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     GetCB_Manager().remove_notification(this, InId);
 }
@@ -658,7 +661,7 @@ void EOSSDK_Connect::RemoveNotifyAuthExpiration(EOS_NotificationId InId)
 EOS_NotificationId EOSSDK_Connect::AddNotifyLoginStatusChanged(const EOS_Connect_AddNotifyLoginStatusChangedOptions* Options, void* ClientData, const EOS_Connect_OnLoginStatusChangedCallback Notification)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Notification == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -683,7 +686,7 @@ EOS_NotificationId EOSSDK_Connect::AddNotifyLoginStatusChanged(const EOS_Connect
 void EOSSDK_Connect::RemoveNotifyLoginStatusChanged(EOS_NotificationId InId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     GetCB_Manager().remove_notification(this, InId);
 }
@@ -701,7 +704,7 @@ void EOSSDK_Connect::RemoveNotifyLoginStatusChanged(EOS_NotificationId InId)
 uint32_t EOSSDK_Connect::GetProductUserExternalAccountCount(const EOS_Connect_GetProductUserExternalAccountCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return 0;
 }
@@ -723,7 +726,7 @@ uint32_t EOSSDK_Connect::GetProductUserExternalAccountCount(const EOS_Connect_Ge
 EOS_EResult EOSSDK_Connect::CopyProductUserExternalAccountByIndex(const EOS_Connect_CopyProductUserExternalAccountByIndexOptions* Options, EOS_Connect_ExternalAccountInfo** OutExternalAccountInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return EOS_EResult::EOS_NotFound;
 }
@@ -745,7 +748,7 @@ EOS_EResult EOSSDK_Connect::CopyProductUserExternalAccountByIndex(const EOS_Conn
 EOS_EResult EOSSDK_Connect::CopyProductUserExternalAccountByAccountType(const EOS_Connect_CopyProductUserExternalAccountByAccountTypeOptions* Options, EOS_Connect_ExternalAccountInfo** OutExternalAccountInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return EOS_EResult::EOS_NotFound;
 }
@@ -767,7 +770,7 @@ EOS_EResult EOSSDK_Connect::CopyProductUserExternalAccountByAccountType(const EO
 EOS_EResult EOSSDK_Connect::CopyProductUserExternalAccountByAccountId(const EOS_Connect_CopyProductUserExternalAccountByAccountIdOptions* Options, EOS_Connect_ExternalAccountInfo** OutExternalAccountInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return EOS_EResult::EOS_NotFound;
 }
@@ -789,7 +792,7 @@ EOS_EResult EOSSDK_Connect::CopyProductUserExternalAccountByAccountId(const EOS_
 EOS_EResult EOSSDK_Connect::CopyProductUserInfo(const EOS_Connect_CopyProductUserInfoOptions* Options, EOS_Connect_ExternalAccountInfo** OutExternalAccountInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return EOS_EResult::EOS_NotFound;
 }
@@ -839,7 +842,7 @@ bool EOSSDK_Connect::send_connect_infos(Network::peer_t const& peerid, Connect_I
 bool EOSSDK_Connect::on_peer_connect(Network_Message_pb const& msg, Network_Peer_Connect_pb const& peer)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    UNIQUE_LOCK(users_lk, users_mutex);
 
     EOS_ProductUserId product_id = GetProductUserId(msg.source_id());
     auto& user = _users[product_id];
@@ -853,7 +856,6 @@ bool EOSSDK_Connect::on_peer_connect(Network_Message_pb const& msg, Network_Peer
 bool EOSSDK_Connect::on_peer_disconnect(Network_Message_pb const& msg, Network_Peer_Disconnect_pb const& peer)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
 
     // Presence need to know when a user disconnects
     GetEOS_Presence().on_peer_disconnect(msg, peer);
@@ -861,6 +863,7 @@ bool EOSSDK_Connect::on_peer_disconnect(Network_Message_pb const& msg, Network_P
     GetEOS_Sessions().on_peer_disconnect(msg, peer);
     GetEOS_P2P().on_peer_disconnect(msg, peer);
 
+    UNIQUE_LOCK(users_lk, users_mutex);
     EOS_ProductUserId product_id = GetProductUserId(msg.source_id());
     _users[product_id].connected = false;
     _users[product_id].authentified = false;
@@ -871,7 +874,7 @@ bool EOSSDK_Connect::on_peer_disconnect(Network_Message_pb const& msg, Network_P
 bool EOSSDK_Connect::on_connect_infos_request(Network_Message_pb const& msg, Connect_Request_Info_pb const& req)
 {
     //TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     Connect_Infos_pb* infos = new Connect_Infos_pb;
 
@@ -883,32 +886,37 @@ bool EOSSDK_Connect::on_connect_infos_request(Network_Message_pb const& msg, Con
 bool EOSSDK_Connect::on_connect_infos(Network_Message_pb const& msg, Connect_Infos_pb const& infos)
 {
     //TRACE_FUNC();
-    GLOBAL_LOCK();
+    bool authentified = false;
+    {// Don't hold users_mutex while notifying the other interfaces
+        UNIQUE_LOCK(users_lk, users_mutex);
 
-    auto& user = _users[GetProductUserId(msg.source_id())];
+        auto& user = _users[GetProductUserId(msg.source_id())];
+        if (!user.connected)
+            return true;
 
-    if (user.connected)
-    {
         user.infos = infos;
         user.last_infos = std::chrono::steady_clock::now();
         if (!user.authentified)
         {
             user.authentified = true;
-
-            Network_Peer_Connect_pb connect;
-            GetEOS_Presence().on_peer_connect(msg, connect);
-            GetEOS_P2P().on_peer_connect(msg, connect);
+            authentified = true;
         }
+    }
 
-        std::vector<pFrameResult_t> notifs = std::move(GetCB_Manager().get_notifications(&GetEOS_Friends(), EOS_Friends_OnFriendsUpdateInfo::k_iCallback));
-        for (auto& notif : notifs)
-        {
-            EOS_Friends_OnFriendsUpdateInfo& ofui = notif->GetCallback<EOS_Friends_OnFriendsUpdateInfo>();
-            ofui.TargetUserId = GetEpicUserId(user.infos.userid());
-            notif->GetFunc()(notif->GetFuncParam());
-        }
+    if (authentified)
+    {
+        Network_Peer_Connect_pb connect;
+        GetEOS_Presence().on_peer_connect(msg, connect);
+        GetEOS_P2P().on_peer_connect(msg, connect);
     }
 
+    EOS_EpicAccountId friend_id = GetEpicUserId(infos.userid());
+    GetCB_Manager().post_notifications(&GetEOS_Friends(), EOS_Friends_OnFriendsUpdateInfo::k_iCallback, [friend_id](FrameResult& notif)
+    {
+        EOS_Friends_OnFriendsUpdateInfo& ofui = notif.GetCallback<EOS_Friends_OnFriendsUpdateInfo>();
+        ofui.TargetUserId = friend_id;
+    });
+
     return true;
 }
 
@@ -917,7 +925,7 @@ bool EOSSDK_Connect::on_connect_infos(Network_Message_pb const& msg, Connect_Inf
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_Connect::CBRunFrame()
 {
-    GLOBAL_LOCK();
+    UNIQUE_LOCK(users_lk, users_mutex);
 
     if (!get_myself()->second.connected)
         return true;
@@ -978,14 +986,14 @@ bool EOSSDK_Connect::RunNetwork(Network_Message_pb const& msg)
 
 bool EOSSDK_Connect::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;
 }
 
 void EOSSDK_Connect::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     //switch (res->res.m_iCallback)
     //{
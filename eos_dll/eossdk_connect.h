@@ -37,6 +37,8 @@ namespace sdk
         public IRunCallback,
         public IRunNetwork
     {
+        std::recursive_mutex local_mutex;
+
         static constexpr std::chrono::milliseconds user_infos_rate = std::chrono::milliseconds(3000);
 
         std::string _device_id;
@@ -44,6 +46,9 @@ namespace sdk
     public:
         std::string _username; // This is used for leaderboards thing ?
 
+        // Read _users under a shared lock and write it under an exclusive one, users are never removed so iterators stay valid.
+        // Never call another interface while holding it.
+        std::shared_mutex users_mutex;
         nlohmann::fifo_map<EOS_ProductUserId, user_state_t> _users;
 
         EOSSDK_Connect();
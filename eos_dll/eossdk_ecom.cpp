@@ -130,7 +130,7 @@ EOS_EResult EOSSDK_Ecom::copy_entitlement(typename decltype(_queried_entitlement
 void EOSSDK_Ecom::QueryOwnership(const EOS_Ecom_QueryOwnershipOptions* Options, void* ClientData, const EOS_Ecom_OnQueryOwnershipCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -229,7 +229,7 @@ void EOSSDK_Ecom::QueryOwnership(const EOS_Ecom_QueryOwnershipOptions* Options,
 void EOSSDK_Ecom::QueryOwnershipToken(const EOS_Ecom_QueryOwnershipTokenOptions* Options, void* ClientData, const EOS_Ecom_OnQueryOwnershipTokenCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -285,7 +285,7 @@ void EOSSDK_Ecom::QueryOwnershipToken(const EOS_Ecom_QueryOwnershipTokenOptions*
 void EOSSDK_Ecom::QueryEntitlements(const EOS_Ecom_QueryEntitlementsOptions* Options, void* ClientData, const EOS_Ecom_OnQueryEntitlementsCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -360,7 +360,7 @@ void EOSSDK_Ecom::QueryEntitlements(const EOS_Ecom_QueryEntitlementsOptions* Opt
 void EOSSDK_Ecom::QueryOffers(const EOS_Ecom_QueryOffersOptions* Options, void* ClientData, const EOS_Ecom_OnQueryOffersCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -390,7 +390,7 @@ void EOSSDK_Ecom::QueryOffers(const EOS_Ecom_QueryOffersOptions* Options, void*
 void EOSSDK_Ecom::Checkout(const EOS_Ecom_CheckoutOptions* Options, void* ClientData, const EOS_Ecom_OnCheckoutCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -429,7 +429,7 @@ void EOSSDK_Ecom::Checkout(const EOS_Ecom_CheckoutOptions* Options, void* Client
 void EOSSDK_Ecom::RedeemEntitlements(const EOS_Ecom_RedeemEntitlementsOptions* Options, void* ClientData, const EOS_Ecom_OnRedeemEntitlementsCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     APP_LOG(Log::LogLevel::INFO, "TODO");
 
     if (CompletionDelegate == nullptr)
@@ -461,7 +461,7 @@ void EOSSDK_Ecom::RedeemEntitlements(const EOS_Ecom_RedeemEntitlementsOptions* O
 uint32_t EOSSDK_Ecom::GetEntitlementsCount(const EOS_Ecom_GetEntitlementsCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     if (Options == nullptr)
         return 0;
@@ -481,7 +481,7 @@ uint32_t EOSSDK_Ecom::GetEntitlementsCount(const EOS_Ecom_GetEntitlementsCountOp
 uint32_t EOSSDK_Ecom::GetEntitlementsByNameCount(const EOS_Ecom_GetEntitlementsByNameCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     APP_LOG(Log::LogLevel::INFO, "EntitlementName: %s", Options->EntitlementName == nullptr ? "<No Name>" : Options->EntitlementName);
 
@@ -519,7 +519,7 @@ uint32_t EOSSDK_Ecom::GetEntitlementsByNameCount(const EOS_Ecom_GetEntitlementsB
 EOS_EResult EOSSDK_Ecom::CopyEntitlementByIndex(const EOS_Ecom_CopyEntitlementByIndexOptions* Options, EOS_Ecom_Entitlement** OutEntitlement)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->EntitlementIndex >= _queried_entitlements.size() || OutEntitlement == nullptr)
     {
@@ -551,7 +551,7 @@ EOS_EResult EOSSDK_Ecom::CopyEntitlementByIndex(const EOS_Ecom_CopyEntitlementBy
 EOS_EResult EOSSDK_Ecom::CopyEntitlementByNameAndIndex(const EOS_Ecom_CopyEntitlementByNameAndIndexOptions* Options, EOS_Ecom_Entitlement** OutEntitlement)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->EntitlementName == nullptr || OutEntitlement == nullptr)
     {
@@ -598,7 +598,7 @@ EOS_EResult EOSSDK_Ecom::CopyEntitlementByNameAndIndex(const EOS_Ecom_CopyEntitl
 EOS_EResult EOSSDK_Ecom::CopyEntitlementById(const EOS_Ecom_CopyEntitlementByIdOptions* Options, EOS_Ecom_Entitlement** OutEntitlement)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     APP_LOG(Log::LogLevel::INFO, "Entitlement id: %s", Options->EntitlementId == nullptr ? "<no id>" : Options->EntitlementId);
 
@@ -631,7 +631,7 @@ uint32_t EOSSDK_Ecom::GetOfferCount(const EOS_Ecom_GetOfferCountOptions* Options
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return 0;
 }
@@ -655,7 +655,7 @@ EOS_EResult EOSSDK_Ecom::CopyOfferByIndex(const EOS_Ecom_CopyOfferByIndexOptions
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutOffer);
     return EOS_EResult::EOS_NotFound;
@@ -680,7 +680,7 @@ EOS_EResult EOSSDK_Ecom::CopyOfferById(const EOS_Ecom_CopyOfferByIdOptions* Opti
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutOffer);
     return EOS_EResult::EOS_NotFound;
@@ -695,7 +695,7 @@ uint32_t EOSSDK_Ecom::GetOfferItemCount(const EOS_Ecom_GetOfferItemCountOptions*
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return 0;
 }
@@ -719,7 +719,7 @@ EOS_EResult EOSSDK_Ecom::CopyOfferItemByIndex(const EOS_Ecom_CopyOfferItemByInde
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutItem);
     return EOS_EResult::EOS_NotFound;
@@ -744,7 +744,7 @@ EOS_EResult EOSSDK_Ecom::CopyItemById(const EOS_Ecom_CopyItemByIdOptions* Option
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutItem);
     return EOS_EResult::EOS_NotFound;
@@ -759,7 +759,7 @@ uint32_t EOSSDK_Ecom::GetOfferImageInfoCount(const EOS_Ecom_GetOfferImageInfoCou
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return 0;
 }
@@ -781,7 +781,7 @@ EOS_EResult EOSSDK_Ecom::CopyOfferImageInfoByIndex(const EOS_Ecom_CopyOfferImage
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutImageInfo);
     return EOS_EResult::EOS_NotFound;
@@ -796,7 +796,7 @@ uint32_t EOSSDK_Ecom::GetItemImageInfoCount(const EOS_Ecom_GetItemImageInfoCount
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return 0;
 }
@@ -818,7 +818,7 @@ EOS_EResult EOSSDK_Ecom::CopyItemImageInfoByIndex(const EOS_Ecom_CopyItemImageIn
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutImageInfo);
     return EOS_EResult::EOS_NotFound;
@@ -833,7 +833,7 @@ uint32_t EOSSDK_Ecom::GetItemReleaseCount(const EOS_Ecom_GetItemReleaseCountOpti
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return 0;
 }
@@ -855,7 +855,7 @@ EOS_EResult EOSSDK_Ecom::CopyItemReleaseByIndex(const EOS_Ecom_CopyItemReleaseBy
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutRelease);
     return EOS_EResult::EOS_NotFound;
@@ -873,7 +873,7 @@ uint32_t EOSSDK_Ecom::GetTransactionCount(const EOS_Ecom_GetTransactionCountOpti
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     return 0;
 }
@@ -894,7 +894,7 @@ EOS_EResult EOSSDK_Ecom::CopyTransactionByIndex(const EOS_Ecom_CopyTransactionBy
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutTransaction);
     return EOS_EResult::EOS_NotFound;
@@ -916,7 +916,7 @@ EOS_EResult EOSSDK_Ecom::CopyTransactionById(const EOS_Ecom_CopyTransactionByIdO
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::INFO, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutTransaction);
     return EOS_EResult::EOS_NotFound;
@@ -932,14 +932,14 @@ bool EOSSDK_Ecom::CBRunFrame()
 
 bool EOSSDK_Ecom::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;
 }
 
 void EOSSDK_Ecom::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
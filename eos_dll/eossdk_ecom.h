@@ -42,6 +42,8 @@ namespace sdk
     class EOSSDK_Ecom :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
         static const std::string catalog_filename;
         static const std::string entitlements_filename;
 
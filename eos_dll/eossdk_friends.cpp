@@ -56,7 +56,7 @@ EOSSDK_Friends::~EOSSDK_Friends()
 void EOSSDK_Friends::QueryFriends(const EOS_Friends_QueryFriendsOptions* Options, void* ClientData, const EOS_Friends_OnQueryFriendsCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -70,6 +70,7 @@ void EOSSDK_Friends::QueryFriends(const EOS_Friends_QueryFriendsOptions* Options
 
     _friends.clear();
 
+    SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
     for (auto user_it = GetEOS_Connect().get_other_users(); user_it != GetEOS_Connect().get_end_users(); ++user_it)
     {
         if (user_it->second.authentified)
@@ -93,7 +94,7 @@ void EOSSDK_Friends::QueryFriends(const EOS_Friends_QueryFriendsOptions* Options
 void EOSSDK_Friends::SendInvite(const EOS_Friends_SendInviteOptions* Options, void* ClientData, const EOS_Friends_OnSendInviteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -128,7 +129,7 @@ void EOSSDK_Friends::SendInvite(const EOS_Friends_SendInviteOptions* Options, vo
 void EOSSDK_Friends::AcceptInvite(const EOS_Friends_AcceptInviteOptions* Options, void* ClientData, const EOS_Friends_OnAcceptInviteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -163,7 +164,7 @@ void EOSSDK_Friends::AcceptInvite(const EOS_Friends_AcceptInviteOptions* Options
 void EOSSDK_Friends::RejectInvite(const EOS_Friends_RejectInviteOptions* Options, void* ClientData, const EOS_Friends_OnRejectInviteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -199,7 +200,7 @@ void EOSSDK_Friends::RejectInvite(const EOS_Friends_RejectInviteOptions* Options
 int32_t EOSSDK_Friends::GetFriendsCount(const EOS_Friends_GetFriendsCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return static_cast<int32_t>(_friends.size());
 }
@@ -218,7 +219,7 @@ int32_t EOSSDK_Friends::GetFriendsCount(const EOS_Friends_GetFriendsCountOptions
 EOS_EpicAccountId EOSSDK_Friends::GetFriendAtIndex(const EOS_Friends_GetFriendAtIndexOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->Index >= _friends.size())
         return nullptr;
@@ -244,7 +245,7 @@ EOS_EpicAccountId EOSSDK_Friends::GetFriendAtIndex(const EOS_Friends_GetFriendAt
 EOS_EFriendsStatus EOSSDK_Friends::GetStatus(const EOS_Friends_GetStatusOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->TargetUserId == nullptr)
         return EOS_EFriendsStatus::EOS_FS_NotFriends;
@@ -267,7 +268,7 @@ EOS_EFriendsStatus EOSSDK_Friends::GetStatus(const EOS_Friends_GetStatusOptions*
 EOS_NotificationId EOSSDK_Friends::AddNotifyFriendsUpdate(const EOS_Friends_AddNotifyFriendsUpdateOptions* Options, void* ClientData, const EOS_Friends_OnFriendsUpdateCallback FriendsUpdateHandler)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (FriendsUpdateHandler == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -292,7 +293,7 @@ EOS_NotificationId EOSSDK_Friends::AddNotifyFriendsUpdate(const EOS_Friends_AddN
 void EOSSDK_Friends::RemoveNotifyFriendsUpdate(EOS_NotificationId NotificationId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     GetCB_Manager().remove_notification(this, NotificationId);
 }
@@ -28,6 +28,8 @@ namespace sdk
     class EOSSDK_Friends :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
         std::set<EOS_EpicAccountId> _friends;
 
     public:
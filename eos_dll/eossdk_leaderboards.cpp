@@ -365,14 +365,14 @@ bool EOSSDK_Leaderboards::CBRunFrame()
 
 bool EOSSDK_Leaderboards::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;
 }
 
 void EOSSDK_Leaderboards::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     //switch (res->res.m_iCallback)
     {
@@ -28,6 +28,8 @@ namespace sdk
     class EOSSDK_Leaderboards :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
     public:
         EOSSDK_Leaderboards();
         ~EOSSDK_Leaderboards();
@@ -80,133 +80,166 @@ bool compare_attribute_values(T&& v1, EOS_EOnlineComparisonOp op, T&& v2, std::s
     return res;
 }
 
-std::vector<lobby_state_t*> EOSSDK_Lobby::get_lobbies_from_attributes(google::protobuf::Map<std::string, Lobby_Search_Parameter> const& parameters)
+static bool lobby_matches(lobby_state_t const& lobby, google::protobuf::Map<std::string, Lobby_Search_Parameter> const& parameters)
 {
-    std::vector<lobby_state_t*> res;
-    for (auto& lobby : _lobbies)
+    bool found = true;
+    for (auto& param : parameters)
     {
-        bool found = true;
-        for (auto& param : parameters)
+        // Well known parameters
+        switchstr(param.first)
         {
-            // Well known parameters
-            switchstr(param.first)
+            casestr(EOS_LOBBY_SEARCH_MINCURRENTMEMBERS) :
             {
-                casestr(EOS_LOBBY_SEARCH_MINCURRENTMEMBERS) :
-                {
-                    auto it = param.second.param().find(utils::GetEnumValue(EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL));
-                    if (it != param.second.param().end())
-                    {// Wrong comparison type should never happen, it's already tested in the search.
-                        switch(it->second.value_case())
-                        {// Wrong parameter type should never happen, it's already tested in the search.
-                            case Session_Attr_Value::ValueCase::kI:
-                            {
-                                int64_t lobby_current_members = lobby.second.infos.members_size();
-                                int64_t min_current_members = it->second.i();
-                                found = compare_attribute_values(lobby_current_members, EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL, min_current_members, param.first);
-                            }
-                            break;
+                auto it = param.second.param().find(utils::GetEnumValue(EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL));
+                if (it != param.second.param().end())
+                {// Wrong comparison type should never happen, it's already tested in the search.
+                    switch(it->second.value_case())
+                    {// Wrong parameter type should never happen, it's already tested in the search.
+                        case Lobby_Attr_Value::ValueCase::kI:
+                        {
+                            int64_t lobby_current_members = lobby.infos.members_size();
+                            int64_t min_current_members = it->second.i();
+                            found = compare_attribute_values(lobby_current_members, EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL, min_current_members, param.first);
+                        }
+                        break;
 
-                            default:
-                            {
-                                APP_LOG(Log::LogLevel::INFO, "Triied " EOS_LOBBY_SEARCH_MINCURRENTMEMBERS " with a comparator different than EOS_CO_GREATERTHANOREQUAL: FIX ME!");
-                                found = false;
-                            }
+                        default:
+                        {
+                            APP_LOG(Log::LogLevel::INFO, "Triied " EOS_LOBBY_SEARCH_MINCURRENTMEMBERS " with a comparator different than EOS_CO_GREATERTHANOREQUAL: FIX ME!");
+                            found = false;
                         }
                     }
                 }
-                break;
+            }
+            break;
 
-                casestr(EOS_LOBBY_SEARCH_MINSLOTSAVAILABLE) :
-                {
-                    auto it = param.second.param().find(utils::GetEnumValue(EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL));
-                    if (it != param.second.param().end())
-                    {// Wrong comparison type should never happen, it's already tested in the search.
-                        switch(it->second.value_case())
-                        {// Wrong parameter type should never happen, it's already tested in the search.
-                            case Session_Attr_Value::ValueCase::kI:
-                            {
-                                int64_t lobby_slots_available = static_cast<int64_t>(lobby.second.infos.max_lobby_member()) - lobby.second.infos.members_size();
-                                int64_t min_slots_available = it->second.i();
-                                found = compare_attribute_values(lobby_slots_available, EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL, min_slots_available, param.first);
-                            }
-                            break;
+            casestr(EOS_LOBBY_SEARCH_MINSLOTSAVAILABLE) :
+            {
+                auto it = param.second.param().find(utils::GetEnumValue(EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL));
+                if (it != param.second.param().end())
+                {// Wrong comparison type should never happen, it's already tested in the search.
+                    switch(it->second.value_case())
+                    {// Wrong parameter type should never happen, it's already tested in the search.
+                        case Lobby_Attr_Value::ValueCase::kI:
+                        {
+                            int64_t lobby_slots_available = static_cast<int64_t>(lobby.infos.max_lobby_member()) - lobby.infos.members_size();
+                            int64_t min_slots_available = it->second.i();
+                            found = compare_attribute_values(lobby_slots_available, EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL, min_slots_available, param.first);
+                        }
+                        break;
 
-                            default:
-                            {
-                                APP_LOG(Log::LogLevel::INFO, "Triied " EOS_LOBBY_SEARCH_MINSLOTSAVAILABLE " with a comparator different than EOS_CO_GREATERTHANOREQUAL: FIX ME!");
-                                found = false;
-                            }
+                        default:
+                        {
+                            APP_LOG(Log::LogLevel::INFO, "Triied " EOS_LOBBY_SEARCH_MINSLOTSAVAILABLE " with a comparator different than EOS_CO_GREATERTHANOREQUAL: FIX ME!");
+                            found = false;
                         }
                     }
                 }
-                break;
+            }
+            break;
 
-                default:
-                    auto it = lobby.second.infos.attributes().find(param.first);
-                    if (it == lobby.second.infos.attributes().end())
+            casestr(EOS_LOBBY_SEARCH_BUCKET_ID) :
+            {
+                for (auto& comparisons : param.second.param())
+                {
+                    if (comparisons.second.value_case() != Lobby_Attr_Value::ValueCase::kS)
                     {
                         found = false;
+                        break;
                     }
-                    else
+
+                    std::string const& bucket_id = lobby.infos.bucket_id();
+                    std::string const& s_search = comparisons.second.s();
+                    found = compare_attribute_values(bucket_id, static_cast<EOS_EOnlineComparisonOp>(comparisons.first), s_search, param.first);
+                    if (!found)
+                        break;
+                }
+            }
+            break;
+
+            default:
+                auto it = lobby.infos.attributes().find(param.first);
+                if (it == lobby.infos.attributes().end())
+                {
+                    found = false;
+                }
+                else
+                {
+                    for (auto& comparisons : param.second.param())
                     {
-                        for (auto& comparisons : param.second.param())
+                        // comparisons.first// Comparison type
+                        if (comparisons.second.value_case() != it->second.value().value_case())
                         {
-                            // comparisons.first// Comparison type
-                            if (comparisons.second.value_case() != it->second.value().value_case())
-                            {
-                                found = false;
-                                break;
-                            }
+                            found = false;
+                            break;
+                        }
 
-                            EOS_EOnlineComparisonOp comp = static_cast<EOS_EOnlineComparisonOp>(comparisons.first);
+                        EOS_EOnlineComparisonOp comp = static_cast<EOS_EOnlineComparisonOp>(comparisons.first);
 
-                            switch (comparisons.second.value_case())
+                        switch (comparisons.second.value_case())
+                        {
+                            case Lobby_Attr_Value::ValueCase::kB:
+                            {
+                                bool b_session = it->second.value().b();
+                                bool b_search = comparisons.second.b();
+                                found = compare_attribute_values(b_session, comp, b_search, param.first);
+                            }
+                            break;
+                            case Lobby_Attr_Value::ValueCase::kI:
+                            {
+                                int64_t i_lobby = it->second.value().i();
+                                int64_t i_search = comparisons.second.i();
+                                found = compare_attribute_values(i_lobby, comp, i_search, param.first);
+                            }
+                            break;
+                            case Lobby_Attr_Value::ValueCase::kD:
                             {
-                                case Session_Attr_Value::ValueCase::kB:
-                                {
-                                    bool b_session = it->second.value().b();
-                                    bool b_search = comparisons.second.b();
-                                    found = compare_attribute_values(b_session, comp, b_search, param.first);
-                                }
-                                break;
-                                case Session_Attr_Value::ValueCase::kI:
-                                {
-                                    int64_t i_lobby = it->second.value().i();
-                                    int64_t i_search = comparisons.second.i();
-                                    found = compare_attribute_values(i_lobby, comp, i_search, param.first);
-                                }
-                                break;
-                                case Session_Attr_Value::ValueCase::kD:
-                                {
-                                    double d_lobby = it->second.value().d();
-                                    double d_search = comparisons.second.d();
-                                    found = compare_attribute_values(d_lobby, comp, d_search, param.first);
-                                }
-                                break;
-                                case Session_Attr_Value::ValueCase::kS:
-                                {
-                                    std::string const& s_lobby = it->second.value().s();
-                                    std::string const& s_search = comparisons.second.s();
-                                    found = compare_attribute_values(s_lobby, comp, s_search, param.first);
-                                }
-                                break;
+                                double d_lobby = it->second.value().d();
+                                double d_search = comparisons.second.d();
+                                found = compare_attribute_values(d_lobby, comp, d_search, param.first);
                             }
+                            break;
+                            case Lobby_Attr_Value::ValueCase::kS:
+                            {
+                                std::string const& s_lobby = it->second.value().s();
+                                std::string const& s_search = comparisons.second.s();
+                                found = compare_attribute_values(s_lobby, comp, s_search, param.first);
+                            }
+                            break;
                         }
+
+                        if (!found)
+                            break;
                     }
-            }
-            if (found == false)
-            {
-                APP_LOG(Log::LogLevel::DEBUG, "This lobby didn't match: %s", lobby.second.infos.lobby_id().c_str());
-                break;
-            }
+                }
         }
-
-        if (found)
+        if (found == false)
         {
-            res.emplace_back(&lobby.second);
+            APP_LOG(Log::LogLevel::DEBUG, "This lobby didn't match: %s", lobby.infos.lobby_id().c_str());
+            break;
         }
     }
 
+    return found;
+}
+
+std::vector<lobby_state_t*> EOSSDK_Lobby::get_lobbies_from_attributes(google::protobuf::Map<std::string, Lobby_Search_Parameter> const& parameters)
+{
+    std::vector<lobby_state_t*> res;
+    std::vector<lobby_state_t*> candidates;
+    if (!_lobbies_index.find_candidates(parameters, candidates))
+    {// Nothing indexed to start from, test every lobby
+        candidates.reserve(_lobbies.size());
+        for (auto& lobby : _lobbies)
+            candidates.emplace_back(&lobby.second);
+    }
+
+    for (auto lobby : candidates)
+    {
+        if (lobby_matches(*lobby, parameters))
+            res.emplace_back(lobby);
+    }
+
     return res;
 }
 
@@ -261,14 +294,12 @@ void EOSSDK_Lobby::notify_lobby_update(lobby_state_t* lobby)
 {
     assert(lobby != nullptr);
 
-    std::vector<pFrameResult_t> notifs(std::move(GetCB_Manager().get_notifications(this, EOS_Lobby_LobbyUpdateReceivedCallbackInfo::k_iCallback)));
-    for (auto& notif : notifs)
+    std::string lobby_id = lobby->infos.lobby_id();
+    GetCB_Manager().post_notifications(this, EOS_Lobby_LobbyUpdateReceivedCallbackInfo::k_iCallback, [lobby_id](FrameResult& notif)
     {
-        EOS_Lobby_LobbyUpdateReceivedCallbackInfo& lurci = notif->GetCallback<EOS_Lobby_LobbyUpdateReceivedCallbackInfo>();
-        strncpy(const_cast<char*>(lurci.LobbyId), lobby->infos.lobby_id().c_str(), max_accountid_length);
-
-        notif->GetFunc()(notif->GetFuncParam());
-    }
+        EOS_Lobby_LobbyUpdateReceivedCallbackInfo& lurci = notif.GetCallback<EOS_Lobby_LobbyUpdateReceivedCallbackInfo>();
+        strncpy(const_cast<char*>(lurci.LobbyId), lobby_id.c_str(), max_accountid_length);
+    });
 }
 
 void EOSSDK_Lobby::notify_lobby_member_status_update(std::string const& member, EOS_ELobbyMemberStatus new_status, lobby_state_t* lobby)
@@ -276,16 +307,14 @@ void EOSSDK_Lobby::notify_lobby_member_status_update(std::string const& member,
     assert(lobby != nullptr);
 
     EOS_ProductUserId member_id = GetProductUserId(member);
-    std::vector<pFrameResult_t> notifs(std::move(GetCB_Manager().get_notifications(this, EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo::k_iCallback)));
-    for (auto& notif : notifs)
+    std::string lobby_id = lobby->infos.lobby_id();
+    GetCB_Manager().post_notifications(this, EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo::k_iCallback, [lobby_id, member_id, new_status](FrameResult& notif)
     {
-        EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo& lmsrci = notif->GetCallback<EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo>();
-        strncpy(const_cast<char*>(lmsrci.LobbyId), lobby->infos.lobby_id().c_str(), max_accountid_length);
+        EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo& lmsrci = notif.GetCallback<EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo>();
+        strncpy(const_cast<char*>(lmsrci.LobbyId), lobby_id.c_str(), max_accountid_length);
         lmsrci.TargetUserId = member_id;
         lmsrci.CurrentStatus = new_status;
-
-        notif->GetFunc()(notif->GetFuncParam());
-    }
+    });
 }
 
 void EOSSDK_Lobby::notify_lobby_member_update(std::string const& member, lobby_state_t* lobby)
@@ -293,26 +322,23 @@ void EOSSDK_Lobby::notify_lobby_member_update(std::string const& member, lobby_s
     assert(lobby != nullptr);
 
     EOS_ProductUserId member_id = GetProductUserId(member);
-    std::vector<pFrameResult_t> notifs(std::move(GetCB_Manager().get_notifications(this, EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo::k_iCallback)));
-    for (auto& notif : notifs)
+    std::string lobby_id = lobby->infos.lobby_id();
+    GetCB_Manager().post_notifications(this, EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo::k_iCallback, [lobby_id, member_id](FrameResult& notif)
     {
-        EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo& lmurci = notif->GetCallback<EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo>();
-        strncpy(const_cast<char*>(lmurci.LobbyId), lobby->infos.lobby_id().c_str(), max_accountid_length);
+        EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo& lmurci = notif.GetCallback<EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo>();
+        strncpy(const_cast<char*>(lmurci.LobbyId), lobby_id.c_str(), max_accountid_length);
         lmurci.TargetUserId = member_id;
-        notif->GetFunc()(notif->GetFuncParam());
-    }
+    });
 }
 
 void EOSSDK_Lobby::notify_lobby_invite_received(std::string const& invite_id, EOS_ProductUserId from_id)
 {
-    std::vector<pFrameResult_t> notifs(std::move(GetCB_Manager().get_notifications(this, EOS_Lobby_LobbyInviteReceivedCallbackInfo::k_iCallback)));
-    for (auto& notif : notifs)
+    GetCB_Manager().post_notifications(this, EOS_Lobby_LobbyInviteReceivedCallbackInfo::k_iCallback, [invite_id, from_id](FrameResult& notif)
     {
-        EOS_Lobby_LobbyInviteReceivedCallbackInfo& lirci = notif->GetCallback<EOS_Lobby_LobbyInviteReceivedCallbackInfo>();
+        EOS_Lobby_LobbyInviteReceivedCallbackInfo& lirci = notif.GetCallback<EOS_Lobby_LobbyInviteReceivedCallbackInfo>();
         strncpy(const_cast<char*>(lirci.InviteId), invite_id.c_str(), max_accountid_length);
         lirci.TargetUserId = from_id;
-        notif->GetFunc()(notif->GetFuncParam());
-    }
+    });
 }
 
 /**
@@ -403,6 +429,7 @@ void EOSSDK_Lobby::CreateLobby(const EOS_Lobby_CreateLobbyOptions* Options, void
             infos.infos.set_permission_level(utils::GetEnumValue(opts->PermissionLevel));
             (*infos.infos.mutable_members())[GetEOS_Connect().get_myself()->first->to_string()];
             infos.state = lobby_state_t::created;
+            _lobbies_index.update(&infos);
 
             clci.ResultCode = EOS_EResult::EOS_Success;
         }
@@ -591,6 +618,7 @@ void EOSSDK_Lobby::LeaveLobby(const EOS_Lobby_LeaveLobbyOptions* Options, void*
             // TODO: If we're the owner, destroy the lobby ?
             send_lobby_member_leave(GetEOS_Connect().get_myself()->first->to_string(), &it->second, EOS_ELobbyMemberStatus::EOS_LMS_LEFT);
             llci.ResultCode = EOS_EResult::EOS_Success;
+            _lobbies_index.remove(&it->second);
             _lobbies.erase(it);
         }
         else
@@ -701,6 +729,7 @@ void EOSSDK_Lobby::UpdateLobby(const EOS_Lobby_UpdateLobbyOptions* Options, void
                 if (i_am_owner(pLobby))
                 {
                     pLobby->infos = pLobbyModif->_infos;
+                    _lobbies_index.update(pLobby);
                     ulci.ResultCode = EOS_EResult::EOS_Success;
                     send_lobby_update(pLobby);
 
@@ -1709,7 +1738,7 @@ bool EOSSDK_Lobby::send_lobby_member_promote(Network::peer_t const& member_id, l
 bool EOSSDK_Lobby::on_peer_disconnect(Network_Message_pb const& msg, Network_Peer_Disconnect_pb const& peer)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     for (auto& lobby : _lobbies)
     {
@@ -1745,7 +1774,7 @@ bool EOSSDK_Lobby::on_peer_disconnect(Network_Message_pb const& msg, Network_Pee
 bool EOSSDK_Lobby::on_lobby_update(Network_Message_pb const& msg, Lobby_Update_pb const& update)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     lobby_state_t* pLobby = get_lobby_by_id(update.lobby_id());
 
@@ -1754,6 +1783,7 @@ bool EOSSDK_Lobby::on_lobby_update(Network_Message_pb const& msg, Lobby_Update_p
         pLobby->infos.set_max_lobby_member(update.max_lobby_member());
         pLobby->infos.set_permission_level(update.permission_level());
         *pLobby->infos.mutable_attributes() = update.attributes();
+        _lobbies_index.update(pLobby);
 
         notify_lobby_update(pLobby);
     }
@@ -1764,7 +1794,7 @@ bool EOSSDK_Lobby::on_lobby_update(Network_Message_pb const& msg, Lobby_Update_p
 bool EOSSDK_Lobby::on_lobby_member_update(Network_Message_pb const& msg, Lobby_Member_Update_pb const& update)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     lobby_state_t* pLobby = get_lobby_by_id(update.lobby_id());
 
@@ -1782,7 +1812,7 @@ bool EOSSDK_Lobby::on_lobby_member_update(Network_Message_pb const& msg, Lobby_M
 bool EOSSDK_Lobby::on_lobbies_search(Network_Message_pb const& msg, Lobbies_Search_pb const& search)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     Lobbies_Search_response_pb* resp = new Lobbies_Search_response_pb;
     resp->set_search_id(search.search_id());
@@ -1826,7 +1856,7 @@ bool EOSSDK_Lobby::on_lobbies_search(Network_Message_pb const& msg, Lobbies_Sear
 bool EOSSDK_Lobby::on_lobby_join_request(Network_Message_pb const& msg, Lobby_Join_Request_pb const& req)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     lobby_state_t* pLobby = get_lobby_by_id(req.lobby_id());
     
@@ -1871,13 +1901,14 @@ bool EOSSDK_Lobby::on_lobby_join_request(Network_Message_pb const& msg, Lobby_Jo
 bool EOSSDK_Lobby::on_lobby_join_response(Network_Message_pb const& msg, Lobby_Join_Response_pb const& resp)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     auto it = _joins_requests.find(resp.join_id());
     if (it != _joins_requests.end())
     {
         EOS_Lobby_JoinLobbyCallbackInfo& jlci = it->second.cb->GetCallback<EOS_Lobby_JoinLobbyCallbackInfo>();
         it->second.cb->done = true;
+        GetCB_Manager().ready_callback(it->second.cb);
 
         if ((EOS_EResult)resp.reason() == EOS_EResult::EOS_Success)
         {
@@ -1885,6 +1916,7 @@ bool EOSSDK_Lobby::on_lobby_join_response(Network_Message_pb const& msg, Lobby_J
             auto& lobby = _lobbies[resp.infos().lobby_id()];
             lobby.infos = resp.infos();
             lobby.state = lobby_state_t::joined;
+            _lobbies_index.update(&lobby);
             add_member_to_lobby(msg.dest_id(), &lobby);
         }
         else
@@ -1901,7 +1933,7 @@ bool EOSSDK_Lobby::on_lobby_join_response(Network_Message_pb const& msg, Lobby_J
 bool EOSSDK_Lobby::on_lobby_invite(Network_Message_pb const& msg, Lobby_Invite_pb const& invite)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     lobby_invite_t new_invite;
     new_invite.peer_id = GetProductUserId(msg.source_id());
@@ -1917,7 +1949,7 @@ bool EOSSDK_Lobby::on_lobby_invite(Network_Message_pb const& msg, Lobby_Invite_p
 bool EOSSDK_Lobby::on_lobby_member_join(Network_Message_pb const& msg, Lobby_Member_Join_pb const& join)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     lobby_state_t* pLobby = get_lobby_by_id(join.lobby_id());
     if (pLobby != nullptr)
@@ -1932,7 +1964,7 @@ bool EOSSDK_Lobby::on_lobby_member_join(Network_Message_pb const& msg, Lobby_Mem
 bool EOSSDK_Lobby::on_lobby_member_leave(Network_Message_pb const& msg, Lobby_Member_Leave_pb const& leave)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     lobby_state_t* pLobby = get_lobby_by_id(leave.lobby_id());
     if (pLobby != nullptr && remove_member_from_lobby(leave.member_id(), pLobby))
@@ -1961,6 +1993,7 @@ bool EOSSDK_Lobby::on_lobby_member_leave(Network_Message_pb const& msg, Lobby_Me
             {
                 if (GetProductUserId(leave.member_id()) == Settings::Inst().productuserid)
                 {// If I am the one behing kicked
+                    _lobbies_index.remove(pLobby);
                     _lobbies.erase(leave.lobby_id());
                 }
             }
@@ -1974,7 +2007,7 @@ bool EOSSDK_Lobby::on_lobby_member_leave(Network_Message_pb const& msg, Lobby_Me
 bool EOSSDK_Lobby::on_lobby_member_promote(Network_Message_pb const& msg, Lobby_Member_Promote_pb const& promote)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     lobby_state_t* pLobby = get_lobby_by_id(promote.lobby_id());
     if (pLobby != nullptr && is_member_in_lobby(promote.member_id(), pLobby))
@@ -1992,35 +2025,43 @@ bool EOSSDK_Lobby::on_lobby_member_promote(Network_Message_pb const& msg, Lobby_
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_Lobby::CBRunFrame()
 {
-    GLOBAL_LOCK();
-
-    auto now = std::chrono::steady_clock::now();
-    for (auto it = _joins_requests.begin(); it != _joins_requests.end();)
+    // The searches unregister their network listeners when deleted, that can't be done holding our lock
+    std::vector<EOSSDK_LobbySearch*> released_searchs;
     {
-        if ((now - it->second.cb->created_time) > join_timeout)
-        {
-            it->second.cb->done = true;
-            it = _joins_requests.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
-    }
+        LOCAL_LOCK();
 
-    for (auto it = _lobbies_searchs.begin(); it != _lobbies_searchs.end();)
-    {
-        if ((*it)->released())
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = _joins_requests.begin(); it != _joins_requests.end();)
         {
-            delete *it;
-            it = _lobbies_searchs.erase(it);
+            if ((now - it->second.cb->created_time) > join_timeout)
+            {
+                it->second.cb->done = true;
+                GetCB_Manager().ready_callback(it->second.cb);
+                it = _joins_requests.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
         }
-        else
+
+        for (auto it = _lobbies_searchs.begin(); it != _lobbies_searchs.end();)
         {
-            ++it;
+            if ((*it)->released())
+            {
+                released_searchs.emplace_back(*it);
+                it = _lobbies_searchs.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
         }
     }
 
+    for (auto search : released_searchs)
+        delete search;
+
     return true;
 }
 
@@ -2062,14 +2103,14 @@ bool EOSSDK_Lobby::RunNetwork(Network_Message_pb const& msg)
 
 bool EOSSDK_Lobby::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;;
 }
 
 void EOSSDK_Lobby::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
@@ -22,6 +22,7 @@
 #include "common_includes.h"
 #include "callback_manager.h"
 #include "network.h"
+#include "lobby_index.h"
 
 namespace sdk
 {
@@ -147,10 +148,14 @@ namespace sdk
         public IRunCallback,
         public IRunNetwork
     {
+        std::recursive_mutex local_mutex;
+
         static int32_t join_id;
         constexpr static auto join_timeout = std::chrono::milliseconds(5000);
 
         std::unordered_map<std::string, lobby_state_t>  _lobbies;
+        // Must be updated each time a lobby is added, removed or its attributes change
+        lobby_index                                     _lobbies_index;
         std::list<EOSSDK_LobbySearch*>                  _lobbies_searchs;
         nlohmann::fifo_map<std::string, lobby_invite_t> _lobby_invites;
         std::unordered_map<int32_t, lobby_join_t>       _joins_requests;
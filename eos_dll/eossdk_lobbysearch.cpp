@@ -99,6 +99,7 @@ void EOSSDK_LobbySearch::Find(const EOS_LobbySearch_FindOptions* Options, void*
     else
     {
         _search_cb = res;
+        _search_cb->SetTimeout(search_timeout);
         _search_infos.set_search_id(search_id++);
         send_lobbies_search(&_search_infos);
     }
@@ -344,6 +345,10 @@ bool EOSSDK_LobbySearch::on_lobbies_search_response(Network_Message_pb const& ms
     if (_search_cb.get() != nullptr && resp.search_id() == _search_infos.search_id())
     {
         _search_peers.erase(msg.source_id());
+        if (_search_peers.empty())
+        {// Everybody answered, don't wait for the timeout
+            GetCB_Manager().ready_callback(_search_cb);
+        }
         if (_results.size() < _max_results)
         {
             for (auto const& lobby : resp.lobbies())
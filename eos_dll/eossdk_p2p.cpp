@@ -27,6 +27,214 @@ namespace sdk
 
 decltype(EOSSDK_P2P::connecting_timeout) EOSSDK_P2P::connecting_timeout;
 decltype(EOSSDK_P2P::connection_timeout) EOSSDK_P2P::connection_timeout;
+decltype(p2p_reliability_t::min_rto)       p2p_reliability_t::min_rto;
+decltype(p2p_reliability_t::max_rto)       p2p_reliability_t::max_rto;
+decltype(p2p_reliability_t::max_packets_ahead) p2p_reliability_t::max_packets_ahead;
+decltype(EOSSDK_P2P::reliable_max_retries) EOSSDK_P2P::reliable_max_retries;
+decltype(EOSSDK_P2P::max_selective_acks)   EOSSDK_P2P::max_selective_acks;
+
+static inline bool epoch_is_newer(uint32_t epoch, uint32_t current)
+{
+    return static_cast<int32_t>(epoch - current) > 0;
+}
+
+p2p_reliability_t::p2p_reliability_t():
+    // Epoch 0 is sent in the handshake by the peers that don't know about epochs
+    send_epoch(std::max<uint32_t>(static_cast<uint32_t>(get_gen()()), 1)),
+    next_send_sequence(1),
+    srtt(0),
+    rttvar(0),
+    rto(std::chrono::milliseconds(250)),
+    recv_started(false),
+    recv_epoch(0),
+    next_recv_sequence(1)
+{}
+
+void p2p_reliability_t::reset_send()
+{
+    // A new epoch tells the remote peer to drop its receive state
+    if (++send_epoch == 0)
+        send_epoch = 1;
+
+    next_send_sequence = 1;
+    next_send_order.clear();
+    unacked_packets.clear();
+}
+
+void p2p_reliability_t::reset_recv(uint32_t epoch)
+{
+    recv_started = true;
+    recv_epoch = epoch;
+    next_recv_sequence = 1;
+    recv_sequences_ahead.clear();
+    next_recv_order.clear();
+    out_of_order_packets.clear();
+}
+
+void p2p_reliability_t::restart_recv(uint32_t epoch)
+{
+    if (epoch == 0)
+    {// Old peer, its next reliable packet starts the stream whatever its epoch
+        recv_started = false;
+        recv_sequences_ahead.clear();
+        next_recv_order.clear();
+        out_of_order_packets.clear();
+    }
+    else if (!recv_started || epoch != recv_epoch)
+    {// The epoch of a restarted peer is random, it can look older than the one we had
+        reset_recv(epoch);
+    }
+}
+
+void p2p_reliability_t::add_rtt_sample(std::chrono::microseconds rtt)
+{
+    if (srtt.count() == 0)
+    {
+        srtt = rtt;
+        rttvar = rtt / 2;
+    }
+    else
+    {
+        auto delta = srtt - rtt;
+        rttvar = (rttvar * 3 + std::chrono::microseconds(std::abs(delta.count()))) / 4;
+        srtt = (srtt * 7 + rtt) / 8;
+    }
+
+    rto = srtt + rttvar * 4;
+    rto = std::max<std::chrono::microseconds>(rto, min_rto);
+    rto = std::min<std::chrono::microseconds>(rto, max_rto);
+}
+
+static inline uint32_t lowest_bit_index(uint64_t bits)
+{
+#if defined(__WINDOWS__)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+p2p_in_channels_t::p2p_in_channels_t():
+    _dropped_packets(0),
+    _has_removed_peers(false)
+{
+    for (auto& queue : _queues)
+        queue.store(nullptr, std::memory_order_relaxed);
+    for (auto& ready : _ready_channels)
+        ready.store(0, std::memory_order_relaxed);
+}
+
+p2p_in_channels_t::~p2p_in_channels_t()
+{
+    for (auto& queue : _queues)
+        delete queue.load(std::memory_order_relaxed);
+}
+
+void p2p_in_channels_t::set_ready(uint8_t channel)
+{
+    _ready_channels[channel / 64].fetch_or(uint64_t(1) << (channel % 64));
+}
+
+void p2p_in_channels_t::clear_ready(uint8_t channel)
+{
+    _ready_channels[channel / 64].fetch_and(~(uint64_t(1) << (channel % 64)));
+}
+
+bool p2p_in_channels_t::push(P2P_Data_Message_pb&& msg)
+{
+    uint8_t channel = static_cast<uint8_t>(msg.channel());
+    queue_t* queue = _queues[channel].load(std::memory_order_acquire);
+    if (queue == nullptr)
+    {
+        queue = new queue_t;
+        _queues[channel].store(queue, std::memory_order_release);
+    }
+
+    if (!queue->push(std::move(msg)))
+    {
+        _dropped_packets.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    set_ready(channel);
+    return true;
+}
+
+P2P_Data_Message_pb* p2p_in_channels_t::front(int32_t channel)
+{
+    if (_has_removed_peers.load(std::memory_order_acquire))
+        drop_removed_peers();
+
+    if (channel != -1)
+    {
+        queue_t* queue = _queues[static_cast<uint8_t>(channel)].load(std::memory_order_acquire);
+        return queue == nullptr ? nullptr : queue->front();
+    }
+
+    for (size_t i = 0; i < _ready_channels.size(); ++i)
+    {
+        for (uint64_t bits = _ready_channels[i].load(); bits != 0; bits &= bits - 1)
+        {
+            uint8_t ready_channel = static_cast<uint8_t>(i * 64 + lowest_bit_index(bits));
+            P2P_Data_Message_pb* msg = _queues[ready_channel].load(std::memory_order_acquire)->front();
+            if (msg != nullptr)
+                return msg;
+        }
+    }
+
+    return nullptr;
+}
+
+void p2p_in_channels_t::pop(uint8_t channel)
+{
+    queue_t* queue = _queues[channel].load(std::memory_order_acquire);
+    queue->pop();
+    if (queue->empty())
+    {
+        clear_ready(channel);
+        // The producer might have pushed between the check and the clear
+        if (!queue->empty())
+            set_ready(channel);
+    }
+}
+
+void p2p_in_channels_t::remove_peer(std::string const& user_id)
+{
+    std::lock_guard<std::mutex> lk(_removed_peers_mutex);
+    _removed_peers.emplace_back(user_id);
+    _has_removed_peers.store(true, std::memory_order_release);
+}
+
+void p2p_in_channels_t::drop_removed_peers()
+{
+    std::vector<std::string> removed_peers;
+    {
+        std::lock_guard<std::mutex> lk(_removed_peers_mutex);
+        removed_peers.swap(_removed_peers);
+        _has_removed_peers.store(false, std::memory_order_relaxed);
+    }
+
+    for (size_t channel = 0; channel < max_channels; ++channel)
+    {
+        queue_t* queue = _queues[channel].load(std::memory_order_acquire);
+        if (queue == nullptr)
+            continue;
+
+        queue->remove_if([&removed_peers](P2P_Data_Message_pb const& msg)
+        {
+            return std::find(removed_peers.begin(), removed_peers.end(), msg.user_id()) != removed_peers.end();
+        });
+
+        if (queue->empty())
+        {
+            clear_ready(static_cast<uint8_t>(channel));
+            if (!queue->empty())
+                set_ready(static_cast<uint8_t>(channel));
+        }
+    }
+}
 
 EOSSDK_P2P::EOSSDK_P2P():
     next_requested_channel(-1),
@@ -55,9 +263,249 @@ void EOSSDK_P2P::set_p2p_state_connected(EOS_ProductUserId remote_id, p2p_state_
     state.status = p2p_state_t::status_e::connected;
     for (auto& out_msgs : state.p2p_out_messages)
     {// Send all previously stored messages
-        send_p2p_data(remote_id->to_string(), &out_msgs);
+        send_p2p_packet(remote_id, state, out_msgs);
+    }
+    state.p2p_out_messages.clear();
+}
+
+uint32_t EOSSDK_P2P::receive_p2p_packets(int32_t channel, uint32_t max_packets, EOS_P2P_ReceivedPacketExt* out_packets, uint8_t* out_data, uint32_t max_data_size, uint32_t& bytes_written)
+{
+    uint32_t count = 0;
+    bytes_written = 0;
+
+    for (P2P_Data_Message_pb* msg; count < max_packets && (msg = _p2p_in_messages.front(channel)) != nullptr; ++count)
+    {
+        std::string const& data = msg->data();
+        uint32_t length = static_cast<uint32_t>(data.length());
+        if (length > (max_data_size - bytes_written))
+        {
+            if (count != 0)
+                break;
+
+            // Like ReceivePacket, a single packet is truncated
+            length = max_data_size;
+        }
+
+        auto& packet = out_packets[count];
+        packet.PeerId = GetProductUserId(msg->user_id());
+        packet.SocketId.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
+        msg->socket_name().copy(packet.SocketId.SocketName, sizeof(EOS_P2P_SocketId::SocketName));
+        packet.SocketId.SocketName[32] = 0;
+        packet.Channel = static_cast<uint8_t>(msg->channel());
+        packet.DataOffset = bytes_written;
+        packet.DataLengthBytes = length;
+
+        memcpy(out_data + bytes_written, data.data(), length);
+        bytes_written += length;
+
+        _p2p_in_messages.pop(packet.Channel);
+    }
+
+    return count;
+}
+
+bool EOSSDK_P2P::post_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb& data)
+{
+    if (!Settings::Inst().p2p_coalesce_packets)
+        return send_p2p_data(remote_id->to_string(), &data);
+
+    // Serialized size + field tag and length in the batch
+    size_t size = data.ByteSizeLong() + 4;
+    if ((state.out_batch_size + size) > max_batch_size)
+        flush_p2p_batch(remote_id, state);
+
+    if (size > max_batch_size)
+    {// Too big to share a datagram, the batch was flushed so the order is kept
+        return send_p2p_data(remote_id->to_string(), &data);
+    }
+
+    *state.out_batch.add_messages() = data;
+    state.out_batch_size += size;
+    return true;
+}
+
+void EOSSDK_P2P::flush_p2p_batch(EOS_ProductUserId remote_id, p2p_state_t& state)
+{
+    switch (state.out_batch.messages_size())
+    {
+        case 0: return;
+        // No need for the batch envelope, this also keeps single packets readable by peers without batch support
+        case 1: send_p2p_data(remote_id->to_string(), state.out_batch.mutable_messages(0)); break;
+        default: send_p2p_data_batch(remote_id->to_string(), &state.out_batch);
+    }
+
+    state.out_batch.clear_messages();
+    state.out_batch_size = 0;
+}
+
+bool EOSSDK_P2P::queue_p2p_in_message(P2P_Data_Message_pb&& data)
+{
+    if (!_p2p_in_messages.push(std::move(data)))
+    {
+        APP_LOG(Log::LogLevel::WARN, "P2P channel %d queue is full (%llu packets refused so far)", data.channel(), (unsigned long long)_p2p_in_messages.dropped_packets());
+        return false;
+    }
+
+    return true;
+}
+
+void EOSSDK_P2P::queue_p2p_held_messages(p2p_state_t& state, int32_t channel)
+{
+    auto& reliable = state.reliability;
+    uint32_t& next_order = reliable.next_recv_order[channel];
+    auto& pending = reliable.out_of_order_packets[channel];
+    for (auto it = pending.begin(); it != pending.end() && it->first == next_order; ++next_order)
+    {
+        if (!queue_p2p_in_message(std::move(it->second)))
+        {// Already acknowledged, keep it until the game makes room in the queue
+            break;
+        }
+        it = pending.erase(it);
+    }
+}
+
+void EOSSDK_P2P::prepare_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb& data)
+{
+    EOS_EPacketReliability reliability = static_cast<EOS_EPacketReliability>(data.reliability());
+    if (reliability == EOS_EPacketReliability::EOS_PR_UnreliableUnordered)
+        return;
+
+    if (GetNetwork().get_peer_protocol_version(remote_id->to_string()) < Network::p2p_reliability_protocol_version)
+    {// Older peers never ack, the packet is sent once like an unreliable one
+        return;
+    }
+
+    auto& reliable = state.reliability;
+    data.set_epoch(reliable.send_epoch);
+    data.set_sequence(reliable.next_send_sequence++);
+    if (reliability == EOS_EPacketReliability::EOS_PR_ReliableOrdered)
+        data.set_order(reliable.next_send_order[data.channel()]++);
+}
+
+bool EOSSDK_P2P::send_p2p_packet(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb& data)
+{
+    // Sequenced when it actually leaves, the peer is paired by then and its protocol version is known
+    prepare_p2p_data(remote_id, state, data);
+
+    bool res = post_p2p_data(remote_id, state, data);
+    if (data.sequence() != 0)
+    {// Keep reliable packets until they are acknowledged
+        auto now = std::chrono::steady_clock::now();
+        state.reliability.unacked_packets.emplace(data.sequence(), p2p_reliable_packet_t{ data, now, now, 0 });
+    }
+    return res;
+}
+
+void EOSSDK_P2P::receive_reliable_p2p_data(p2p_state_t& state, P2P_Data_Message_pb const& data)
+{
+    auto& reliable = state.reliability;
+    if (!reliable.recv_started || epoch_is_newer(data.epoch(), reliable.recv_epoch))
+    {// The peer (re)started its reliable stream
+        reliable.reset_recv(data.epoch());
+    }
+    else if (data.epoch() != reliable.recv_epoch)
+    {// Late packet from a previous stream
+        return;
+    }
+
+    uint32_t sequence = data.sequence();
+    if (sequence < reliable.next_recv_sequence || reliable.recv_sequences_ahead.count(sequence) != 0)
+    {// Duplicate, our ack didn't make it, it will be sent again
+        return;
+    }
+
+    bool ordered = data.reliability() == static_cast<int32_t>(EOS_EPacketReliability::EOS_PR_ReliableOrdered);
+    if ((sequence != reliable.next_recv_sequence && reliable.recv_sequences_ahead.size() >= p2p_reliability_t::max_packets_ahead) ||
+        (ordered && data.order() != reliable.next_recv_order[data.channel()] && reliable.out_of_order_packets[data.channel()].size() >= p2p_reliability_t::max_packets_ahead))
+    {// Too many packets waiting for a missing one, don't ack this one so it is sent again
+        return;
+    }
+
+    // Only acknowledge the packet once it is stored, either queued for the game or held for the missing ones
+    if (ordered && data.order() != reliable.next_recv_order[data.channel()])
+    {// Hold it until the missing packets arrive
+        reliable.out_of_order_packets[data.channel()].emplace(data.order(), data);
+    }
+    else if (!queue_p2p_in_message(P2P_Data_Message_pb(data)))
+    {// The game queue is full, don't ack this one so it is sent again
+        return;
+    }
+    else if (ordered)
+    {
+        ++reliable.next_recv_order[data.channel()];
+        queue_p2p_held_messages(state, data.channel());
+    }
+
+    if (sequence == reliable.next_recv_sequence)
+    {
+        ++reliable.next_recv_sequence;
+        for (auto it = reliable.recv_sequences_ahead.begin(); it != reliable.recv_sequences_ahead.end() && *it == reliable.next_recv_sequence; )
+        {
+            ++reliable.next_recv_sequence;
+            it = reliable.recv_sequences_ahead.erase(it);
+        }
+    }
+    else
+    {
+        reliable.recv_sequences_ahead.insert(sequence);
     }
+}
+
+bool EOSSDK_P2P::resend_reliable_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state)
+{
+    auto& reliable = state.reliability;
+    if (reliable.unacked_packets.empty())
+        return true;
+
+    auto now = std::chrono::steady_clock::now();
+    std::string peer_id = remote_id->to_string();
+    for (auto it = reliable.unacked_packets.begin(); it != reliable.unacked_packets.end(); )
+    {
+        auto& packet = it->second;
+        // Exponential backoff on each retransmission
+        std::chrono::microseconds timeout = std::min<std::chrono::microseconds>(reliable.rto * (1 << std::min<uint32_t>(packet.retries, 6)), p2p_reliability_t::max_rto);
+        if ((now - packet.last_send) < timeout)
+        {
+            ++it;
+            continue;
+        }
+
+        if (packet.retries >= reliable_max_retries)
+        {// The peer can't deliver the packets after this one without it
+            APP_LOG(Log::LogLevel::WARN, "Reliable packet %u to %s not acknowledged after %u retries", it->first, peer_id.c_str(), packet.retries);
+            return false;
+        }
+
+        ++packet.retries;
+        packet.last_send = now;
+        post_p2p_data(remote_id, state, packet.data);
+        ++it;
+    }
+
+    return true;
+}
+
+void EOSSDK_P2P::close_timed_out_p2p_connection(EOS_ProductUserId remote_id, p2p_state_t& state)
+{
+    state.status = p2p_state_t::status_e::closed;
     state.p2p_out_messages.clear();
+    state.out_batch.clear_messages();
+    state.out_batch_size = 0;
+    state.reliability.reset_send();
+    state.reliability.restart_recv(0);
+
+    // Let the peer drop its side of the stream too, in case it can still hear us
+    send_p2p_connetion_close(remote_id->to_string(), new P2P_Connection_Close_pb);
+
+    std::string socket_name = state.socket_name;
+    GetCB_Manager().post_notifications(this, EOS_P2P_OnRemoteConnectionClosedInfo::k_iCallback, [remote_id, socket_name](FrameResult& notif)
+    {
+        EOS_P2P_OnRemoteConnectionClosedInfo& orcci = notif.GetCallback<EOS_P2P_OnRemoteConnectionClosedInfo>();
+        orcci.RemoteUserId = remote_id;
+        strncpy(const_cast<char*>(orcci.SocketId->SocketName), socket_name.c_str(), sizeof(orcci.SocketId->SocketName));
+        const_cast<char*>(orcci.SocketId->SocketName)[sizeof(orcci.SocketId->SocketName) - 1] = '\0';
+        orcci.Reason = EOS_EConnectionClosedReason::EOS_CCR_TimedOut;
+    });
 }
 
 /**
@@ -79,17 +527,29 @@ void EOSSDK_P2P::set_p2p_state_connected(EOS_ProductUserId remote_id, p2p_state_
 EOS_EResult EOSSDK_P2P::SendPacket(const EOS_P2P_SendPacketOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     if (Options == nullptr || Options->RemoteUserId == nullptr || Options->Data == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
 
+    EOS_EPacketReliability reliability = EOS_EPacketReliability::EOS_PR_UnreliableUnordered;
+    if (Options->ApiVersion >= EOS_P2P_SENDPACKET_API_002)
+        reliability = Options->Reliability;
+
     p2p_state_t& p2p_state = _p2p_connections[Options->RemoteUserId];
+    if (p2p_state.status == p2p_state_t::status_e::closed)
+    {// New connection, start a new reliable stream
+        p2p_state.reliability.reset_send();
+    }
+
     P2P_Data_Message_pb data;
     data.set_data(reinterpret_cast<const char*>(Options->Data), Options->DataLengthBytes);
     data.set_channel(Options->Channel);
     data.set_socket_name(Options->SocketId->SocketName);
-    data.set_user_id(Options->LocalUserId->to_string());
+    // The receiver gets it from the message source id
+    if (GetNetwork().get_peer_protocol_version(Options->RemoteUserId->to_string()) < Network::binary_ids_protocol_version)
+        data.set_user_id(Options->LocalUserId->to_string());
+    data.set_reliability(static_cast<int32_t>(reliability));
 
     switch(p2p_state.status)
     {
@@ -102,7 +562,7 @@ EOS_EResult EOSSDK_P2P::SendPacket(const EOS_P2P_SendPacketOptions* Options)
 
         case p2p_state_t::status_e::connected:
         {// We're connected, send the message now
-            send_p2p_data(Options->RemoteUserId->to_string(), &data);
+            send_p2p_packet(Options->RemoteUserId, p2p_state, data);
         }
         break;
 
@@ -125,6 +585,7 @@ EOS_EResult EOSSDK_P2P::SendPacket(const EOS_P2P_SendPacketOptions* Options)
 
             P2P_Connect_Request_pb* req = new P2P_Connect_Request_pb;
             req->set_socket_name(p2p_state.socket_name);
+            req->set_epoch(p2p_state.reliability.send_epoch);
             send_p2p_connection_request(Options->RemoteUserId->to_string(), req);
         }
     }
@@ -145,38 +606,16 @@ EOS_EResult EOSSDK_P2P::SendPacket(const EOS_P2P_SendPacketOptions* Options)
 EOS_EResult EOSSDK_P2P::GetNextReceivedPacketSize(const EOS_P2P_GetNextReceivedPacketSizeOptions* Options, uint32_t* OutPacketSizeBytes)
 {
     //TRACE_FUNC();
-    std::lock_guard<std::recursive_mutex> lk(local_mutex);
+    // No lock, the inbound queues are safe to read while the P2P frame pushes packets
 
     if (Options == nullptr || OutPacketSizeBytes == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
 
-    bool has_packet = false;
-    if (Options->RequestedChannel == nullptr)
-    {
-        for (auto& in_msgs : _p2p_in_messages)
-        {
-            if (!in_msgs.second.empty())
-            {
-                auto& front = in_msgs.second.front();
-                *OutPacketSizeBytes = static_cast<uint32_t>(front.data().length());
-                next_requested_channel = front.channel();
-                has_packet = true;
-            }
-        }
-    }
-    else
-    {
-        next_requested_channel = *Options->RequestedChannel;
-        auto& in_msgs = _p2p_in_messages[next_requested_channel];
-        if (!in_msgs.empty())
-        {
-            *OutPacketSizeBytes = static_cast<uint32_t>(in_msgs.front().data().length());
-            has_packet = true;
-        }
-    }
-
-    if (has_packet)
+    P2P_Data_Message_pb* msg = _p2p_in_messages.front(Options->RequestedChannel == nullptr ? -1 : *Options->RequestedChannel);
+    if (msg != nullptr)
     {
+        *OutPacketSizeBytes = static_cast<uint32_t>(msg->data().length());
+        next_requested_channel.store(msg->channel(), std::memory_order_relaxed);
         return EOS_EResult::EOS_Success;
     }
     
@@ -199,7 +638,7 @@ EOS_EResult EOSSDK_P2P::GetNextReceivedPacketSize(const EOS_P2P_GetNextReceivedP
  */
 EOS_EResult EOSSDK_P2P::ReceivePacket(const EOS_P2P_ReceivePacketOptions* Options, EOS_ProductUserId* OutPeerId, EOS_P2P_SocketId* OutSocketId, uint8_t* OutChannel, void* OutData, uint32_t* OutBytesWritten)
 {
-    std::lock_guard<std::recursive_mutex> lk(local_mutex);
+    // No lock, see GetNextReceivedPacketSize
 
     if (Options == nullptr || OutPeerId == nullptr || OutSocketId == nullptr ||
         OutChannel == nullptr || OutData == nullptr || OutBytesWritten == nullptr)
@@ -208,43 +647,40 @@ EOS_EResult EOSSDK_P2P::ReceivePacket(const EOS_P2P_ReceivePacketOptions* Option
     }
 
     if (Options->RequestedChannel != nullptr)
-        next_requested_channel = *Options->RequestedChannel;
+        next_requested_channel.store(*Options->RequestedChannel, std::memory_order_relaxed);
 
-    std::list<P2P_Data_Message_pb> *queue = nullptr;
-    if (next_requested_channel == -1)
-    {// No channel, get the next available message
-        auto it = std::find_if(_p2p_in_messages.begin(), _p2p_in_messages.end(), []( std::pair<uint8_t const, std::list<P2P_Data_Message_pb>>& messages_queue)
-        {
-            return !messages_queue.second.empty();
-        });
-        if (it != _p2p_in_messages.end())
-            queue = &it->second;
-    }
-    else
-    {
-        queue = &_p2p_in_messages[next_requested_channel];
-        if (queue->empty())
-        {
-            queue = nullptr;
-        }
-    }
-    if (queue == nullptr)
+    // No channel (-1) gets the next available message
+    EOS_P2P_ReceivedPacketExt packet;
+    uint32_t bytes_written;
+    if (receive_p2p_packets(next_requested_channel.load(std::memory_order_relaxed), 1, &packet, reinterpret_cast<uint8_t*>(OutData), Options->MaxDataSizeBytes, bytes_written) == 0)
     {
         return EOS_EResult::EOS_NotFound;
     }
 
-    auto& msg = queue->front();
+    *OutPeerId = packet.PeerId;
+    *OutBytesWritten = packet.DataLengthBytes;
+    memcpy(OutSocketId->SocketName, packet.SocketId.SocketName, sizeof(EOS_P2P_SocketId::SocketName));
+    *OutChannel = packet.Channel;
+    next_requested_channel.store(-1, std::memory_order_relaxed);
 
-    *OutPeerId = GetProductUserId(msg.user_id());
-    *OutBytesWritten = static_cast<uint32_t>(msg.data().copy(reinterpret_cast<char*>(OutData), Options->MaxDataSizeBytes));
-    msg.socket_name().copy(OutSocketId->SocketName, sizeof(EOS_P2P_SocketId::SocketName));
-    OutSocketId->SocketName[32] = 0;
-    *OutChannel = msg.channel();
-    next_requested_channel = -1;
+    return EOS_EResult::EOS_Success;
+}
 
-    queue->pop_front();
+EOS_EResult EOSSDK_P2P::ReceivePacketsExt(const EOS_P2P_ReceivePacketsExtOptions* Options, EOS_P2P_ReceivedPacketExt* OutPackets, void* OutData, uint32_t* OutPacketCount, uint32_t* OutBytesWritten)
+{
+    // No lock, see GetNextReceivedPacketSize
 
-    return EOS_EResult::EOS_Success;
+    if (Options == nullptr || OutPackets == nullptr || OutData == nullptr ||
+        OutPacketCount == nullptr || OutBytesWritten == nullptr)
+    {
+        return EOS_EResult::EOS_InvalidParameters;
+    }
+
+    int32_t channel = (Options->RequestedChannel == nullptr ? -1 : *Options->RequestedChannel);
+    *OutPacketCount = receive_p2p_packets(channel, Options->MaxPackets, OutPackets, reinterpret_cast<uint8_t*>(OutData), Options->MaxDataSizeBytes, *OutBytesWritten);
+    next_requested_channel.store(-1, std::memory_order_relaxed);
+
+    return (*OutPacketCount == 0 ? EOS_EResult::EOS_NotFound : EOS_EResult::EOS_Success);
 }
 
 /**
@@ -259,7 +695,7 @@ EOS_EResult EOSSDK_P2P::ReceivePacket(const EOS_P2P_ReceivePacketOptions* Option
 EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionRequest(const EOS_P2P_AddNotifyPeerConnectionRequestOptions* Options, void* ClientData, EOS_P2P_OnIncomingConnectionRequestCallback ConnectionRequestHandler)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (ConnectionRequestHandler == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -283,7 +719,7 @@ EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionRequest(const EOS_P2P_AddN
 void EOSSDK_P2P::RemoveNotifyPeerConnectionRequest(EOS_NotificationId NotificationId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     GetCB_Manager().remove_notification(this, NotificationId);
 }
@@ -304,7 +740,7 @@ void EOSSDK_P2P::RemoveNotifyPeerConnectionRequest(EOS_NotificationId Notificati
  */
 EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionEstablished(const EOS_P2P_AddNotifyPeerConnectionEstablishedOptions* Options, void* ClientData, EOS_P2P_OnPeerConnectionEstablishedCallback ConnectionEstablishedHandler) {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (ConnectionEstablishedHandler == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -330,7 +766,7 @@ EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionEstablished(const EOS_P2P_
  */
 void EOSSDK_P2P::RemoveNotifyPeerConnectionEstablished(EOS_NotificationId NotificationId) {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     GetCB_Manager().remove_notification(this, NotificationId);
 }
 
@@ -352,7 +788,7 @@ void EOSSDK_P2P::RemoveNotifyPeerConnectionEstablished(EOS_NotificationId Notifi
  */
 EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionInterrupted(const EOS_P2P_AddNotifyPeerConnectionInterruptedOptions* Options, void* ClientData, EOS_P2P_OnPeerConnectionInterruptedCallback ConnectionInterruptedHandler){
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     if (ConnectionInterruptedHandler == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
 
@@ -375,7 +811,7 @@ EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionInterrupted(const EOS_P2P_
 void EOSSDK_P2P::RemoveNotifyPeerConnectionInterrupted(EOS_NotificationId NotificationId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     GetCB_Manager().remove_notification(this, NotificationId);
 }
@@ -392,7 +828,7 @@ void EOSSDK_P2P::RemoveNotifyPeerConnectionInterrupted(EOS_NotificationId Notifi
 EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionClosed(const EOS_P2P_AddNotifyPeerConnectionClosedOptions* Options, void* ClientData, EOS_P2P_OnRemoteConnectionClosedCallback ConnectionClosedHandler)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (ConnectionClosedHandler == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -417,7 +853,7 @@ EOS_NotificationId EOSSDK_P2P::AddNotifyPeerConnectionClosed(const EOS_P2P_AddNo
 void EOSSDK_P2P::RemoveNotifyPeerConnectionClosed(EOS_NotificationId NotificationId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     GetCB_Manager().remove_notification(this, NotificationId);
 }
@@ -432,17 +868,21 @@ void EOSSDK_P2P::RemoveNotifyPeerConnectionClosed(EOS_NotificationId Notificatio
 EOS_EResult EOSSDK_P2P::AcceptConnection(const EOS_P2P_AcceptConnectionOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->RemoteUserId == nullptr || Options->SocketId == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
     
     auto& conn = _p2p_connections[Options->RemoteUserId];
 
+    if (conn.status == p2p_state_t::status_e::closed)
+        conn.reliability.reset_send();
+
     if (conn.status == p2p_state_t::status_e::requesting)
     {
         P2P_Connect_Response_pb* resp = new P2P_Connect_Response_pb;
         resp->set_accepted(true);
+        resp->set_epoch(conn.reliability.send_epoch);
         send_p2p_connection_response(Options->RemoteUserId->to_string(), resp);
     }
     
@@ -462,7 +902,7 @@ EOS_EResult EOSSDK_P2P::CloseConnection(const EOS_P2P_CloseConnectionOptions* Op
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::DEBUG, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     if (Options == nullptr || Options->RemoteUserId == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
@@ -471,13 +911,9 @@ EOS_EResult EOSSDK_P2P::CloseConnection(const EOS_P2P_CloseConnectionOptions* Op
     {
         auto& conn = _p2p_connections[Options->RemoteUserId];
         conn.p2p_out_messages.clear();
-        for (auto& in_msgs : _p2p_in_messages)
-        {
-            in_msgs.second.erase(std::remove_if(in_msgs.second.begin(), in_msgs.second.end(), [&Options](P2P_Data_Message_pb& msg)
-            {
-                return msg.user_id() == Options->RemoteUserId->to_string();
-            }), in_msgs.second.end());
-        }
+        conn.out_batch.clear_messages();
+        conn.out_batch_size = 0;
+        _p2p_in_messages.remove_peer(Options->RemoteUserId->to_string());
 
         if (conn.status != p2p_state_t::status_e::closed)
         {
@@ -492,13 +928,9 @@ EOS_EResult EOSSDK_P2P::CloseConnection(const EOS_P2P_CloseConnectionOptions* Op
         std::string target_sock_name = Options->SocketId->SocketName;
         auto& conn = _p2p_connections[Options->RemoteUserId];
         conn.p2p_out_messages.clear();
-        for (auto& in_msgs : _p2p_in_messages)
-        {
-            in_msgs.second.erase(std::remove_if(in_msgs.second.begin(), in_msgs.second.end(), [&Options](P2P_Data_Message_pb& msg)
-            {
-                return msg.user_id() == Options->RemoteUserId->to_string();
-            }), in_msgs.second.end());
-        }
+        conn.out_batch.clear_messages();
+        conn.out_batch_size = 0;
+        _p2p_in_messages.remove_peer(Options->RemoteUserId->to_string());
 
         if (conn.status != p2p_state_t::status_e::closed)
         {
@@ -525,7 +957,7 @@ EOS_EResult EOSSDK_P2P::CloseConnection(const EOS_P2P_CloseConnectionOptions* Op
 EOS_EResult EOSSDK_P2P::CloseConnections(const EOS_P2P_CloseConnectionsOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->SocketId == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
@@ -555,7 +987,7 @@ void EOSSDK_P2P::QueryNATType(const EOS_P2P_QueryNATTypeOptions* Options, void*
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::DEBUG, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (NATTypeQueriedHandler == nullptr)
         return;
@@ -592,7 +1024,7 @@ EOS_EResult EOSSDK_P2P::GetNATType(const EOS_P2P_GetNATTypeOptions* Options, EOS
 {
     TRACE_FUNC();
     APP_LOG(Log::LogLevel::DEBUG, "TODO");
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     *OutNATType = EOS_ENATType::EOS_NAT_Moderate;
     return EOS_EResult::EOS_Success;
@@ -609,7 +1041,7 @@ EOS_EResult EOSSDK_P2P::GetNATType(const EOS_P2P_GetNATTypeOptions* Options, EOS
 EOS_EResult EOSSDK_P2P::SetRelayControl(const EOS_P2P_SetRelayControlOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if(Options == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
@@ -629,7 +1061,7 @@ EOS_EResult EOSSDK_P2P::SetRelayControl(const EOS_P2P_SetRelayControlOptions* Op
 EOS_EResult EOSSDK_P2P::GetRelayControl(const EOS_P2P_GetRelayControlOptions* Options, EOS_ERelayControl* OutRelayControl)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || OutRelayControl == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
@@ -648,7 +1080,7 @@ EOS_EResult EOSSDK_P2P::GetRelayControl(const EOS_P2P_GetRelayControlOptions* Op
 EOS_EResult EOSSDK_P2P::SetPortRange(const EOS_P2P_SetPortRangeOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->Port <= 1024)
         return EOS_EResult::EOS_InvalidParameters;
@@ -670,7 +1102,7 @@ EOS_EResult EOSSDK_P2P::SetPortRange(const EOS_P2P_SetPortRangeOptions* Options)
 EOS_EResult EOSSDK_P2P::GetPortRange(const EOS_P2P_GetPortRangeOptions* Options, uint16_t* OutPort, uint16_t* OutNumAdditionalPortsToTry)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || OutPort == nullptr || OutNumAdditionalPortsToTry == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
@@ -743,6 +1175,29 @@ bool EOSSDK_P2P::send_p2p_data(Network::peer_t const& peerid, P2P_Data_Message_p
     return res;
 }
 
+bool EOSSDK_P2P::send_p2p_data_batch(Network::peer_t const& peerid, P2P_Data_Batch_pb* batch) const
+{
+    TRACE_FUNC();
+    std::string const& user_id = Settings::Inst().productuserid->to_string();
+
+    Network_Message_pb msg;
+    P2P_Message_pb* p2p = new P2P_Message_pb;
+
+    p2p->set_allocated_data_batch(batch);
+
+    msg.set_source_id(user_id);
+    msg.set_dest_id(peerid);
+    msg.set_game_id(Settings::Inst().appid);
+
+    msg.set_allocated_p2p(p2p);
+    auto res = GetNetwork().UDPSendTo(msg);
+
+    // The batch belongs to the caller
+    (void)p2p->release_data_batch();
+
+    return res;
+}
+
 bool EOSSDK_P2P::send_p2p_data_ack(Network::peer_t const& peerid, P2P_Data_Acknowledge_pb* ack) const
 {
     TRACE_FUNC();
@@ -787,7 +1242,7 @@ bool EOSSDK_P2P::send_p2p_connetion_close(Network::peer_t const& peerid, P2P_Con
 bool EOSSDK_P2P::on_peer_connect(Network_Message_pb const& msg, Network_Peer_Connect_pb const& peer)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     auto peer_id = GetProductUserId(msg.source_id());
     auto it = _p2p_connections.find(peer_id);
@@ -798,7 +1253,7 @@ bool EOSSDK_P2P::on_peer_connect(Network_Message_pb const& msg, Network_Peer_Con
         // Now that the client is back, send all queued messages
         for (auto& msg : it->second.p2p_out_messages)
         {
-            send_p2p_data(it->first->to_string(), &msg);
+            send_p2p_packet(it->first, it->second, msg);
         }
         it->second.p2p_out_messages.clear();
     }
@@ -809,7 +1264,7 @@ bool EOSSDK_P2P::on_peer_connect(Network_Message_pb const& msg, Network_Peer_Con
 bool EOSSDK_P2P::on_peer_disconnect(Network_Message_pb const& msg, Network_Peer_Disconnect_pb const& peer)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     auto peer_id = GetProductUserId(msg.source_id());
     auto it = _p2p_connections.find(peer_id);
@@ -824,29 +1279,35 @@ bool EOSSDK_P2P::on_peer_disconnect(Network_Message_pb const& msg, Network_Peer_
 bool EOSSDK_P2P::on_p2p_connection_request(Network_Message_pb const& msg, P2P_Connect_Request_pb const& req)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     auto peer_id = GetProductUserId(msg.source_id());
     auto& conn = _p2p_connections[peer_id];
     if (conn.status != p2p_state_t::status_e::connected)
     {
+        if (conn.status == p2p_state_t::status_e::closed)
+            conn.reliability.reset_send();
+
         conn.status = p2p_state_t::status_e::requesting;
         conn.connection_loss_start = std::chrono::steady_clock::now();
         conn.socket_name = req.socket_name();
-        std::vector<pFrameResult_t> notifs = std::move(GetCB_Manager().get_notifications(this, EOS_P2P_OnIncomingConnectionRequestInfo::k_iCallback));
-        for (auto& notif : notifs)
+        conn.reliability.restart_recv(req.epoch());
+        std::string socket_name = req.socket_name();
+        GetCB_Manager().post_notifications(this, EOS_P2P_OnIncomingConnectionRequestInfo::k_iCallback, [peer_id, socket_name](FrameResult& notif)
         {
-            EOS_P2P_OnIncomingConnectionRequestInfo& oicrc = notif->GetCallback<EOS_P2P_OnIncomingConnectionRequestInfo>();
+            EOS_P2P_OnIncomingConnectionRequestInfo& oicrc = notif.GetCallback<EOS_P2P_OnIncomingConnectionRequestInfo>();
             oicrc.RemoteUserId = peer_id;
-            strncpy(const_cast<char*>(oicrc.SocketId->SocketName), req.socket_name().c_str(), sizeof(EOS_P2P_SocketId::SocketName));
-
-            notif->GetFunc()(notif->GetFuncParam());
-        }
+            strncpy(const_cast<char*>(oicrc.SocketId->SocketName), socket_name.c_str(), sizeof(EOS_P2P_SocketId::SocketName));
+        });
     }
     else
-    {
+    {// The peer might have restarted without us noticing, an old peer repeating its request keeps its stream
+        if (req.epoch() != 0)
+            conn.reliability.restart_recv(req.epoch());
+
         P2P_Connect_Response_pb* resp = new P2P_Connect_Response_pb;
         resp->set_accepted(true);
+        resp->set_epoch(conn.reliability.send_epoch);
         send_p2p_connection_response(msg.source_id(), resp);
     }
 
@@ -856,66 +1317,180 @@ bool EOSSDK_P2P::on_p2p_connection_request(Network_Message_pb const& msg, P2P_Co
 bool EOSSDK_P2P::on_p2p_connection_response(Network_Message_pb const& msg, P2P_Connect_Response_pb const& resp)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     EOS_ProductUserId remote_id = GetProductUserId(msg.source_id());
     if (resp.accepted())
     {
-        set_p2p_state_connected(remote_id, _p2p_connections[remote_id]);
+        auto& conn = _p2p_connections[remote_id];
+        if (resp.epoch() != 0)
+            conn.reliability.restart_recv(resp.epoch());
+
+        set_p2p_state_connected(remote_id, conn);
     }
     else
     {
-        std::vector<pFrameResult_t> notifs = std::move(GetCB_Manager().get_notifications(this, EOS_P2P_OnRemoteConnectionClosedInfo::k_iCallback));
-        for (auto& notif : notifs)
+        GetCB_Manager().post_notifications(this, EOS_P2P_OnRemoteConnectionClosedInfo::k_iCallback, [remote_id](FrameResult& notif)
         {
-            EOS_P2P_OnRemoteConnectionClosedInfo& orcci = notif->GetCallback<EOS_P2P_OnRemoteConnectionClosedInfo>();
+            EOS_P2P_OnRemoteConnectionClosedInfo& orcci = notif.GetCallback<EOS_P2P_OnRemoteConnectionClosedInfo>();
             orcci.Reason = EOS_EConnectionClosedReason::EOS_CCR_ClosedByPeer;
             orcci.RemoteUserId = remote_id;
-
-            notif->GetFunc()(notif->GetFuncParam());
-        }
+        });
     }
 
     return true;
 }
 
-bool EOSSDK_P2P::on_p2p_data(Network_Message_pb const& msg, P2P_Data_Message_pb const& data)
+bool EOSSDK_P2P::receive_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb const& data)
 {
-    TRACE_FUNC();
-    std::lock_guard<std::recursive_mutex> lk(local_mutex);
-
-    EOS_ProductUserId remote_id = GetProductUserId(msg.source_id());
-    auto& p2p_state = _p2p_connections[remote_id];
-
-    P2P_Data_Acknowledge_pb* ack = new P2P_Data_Acknowledge_pb;
-
-    switch (p2p_state.status)
+    switch (state.status)
     {
         case p2p_state_t::status_e::connecting:
         {
             APP_LOG(Log::LogLevel::INFO, "Implicit P2P acceptation on receive");
-            set_p2p_state_connected(remote_id, p2p_state);
+            set_p2p_state_connected(remote_id, state);
         }
 
         case p2p_state_t::status_e::connected:
         {
-            ack->set_channel(data.channel());
-            ack->set_accepted(true);
-            _p2p_in_messages[data.channel()].emplace_back(data);
+            if (data.sequence() == 0)
+            {// Unreliable packet, fast path: no ack and no ordering
+                queue_p2p_in_message(P2P_Data_Message_pb(data));
+            }
+            else
+            {
+                receive_reliable_p2p_data(state, data);
+            }
         }
-        break;
+        return true;
 
         default:
-            ack->set_accepted(false);
+            return false;
+    }
+}
+
+P2P_Data_Acknowledge_pb* EOSSDK_P2P::make_p2p_data_ack(p2p_state_t const& state, int32_t channel) const
+{
+    auto const& reliable = state.reliability;
+    P2P_Data_Acknowledge_pb* ack = new P2P_Data_Acknowledge_pb;
+    ack->set_channel(channel);
+    ack->set_accepted(true);
+    ack->set_epoch(reliable.recv_epoch);
+    ack->set_ack_sequence(reliable.next_recv_sequence);
+    int i = 0;
+    for (auto it = reliable.recv_sequences_ahead.begin(); it != reliable.recv_sequences_ahead.end() && i < max_selective_acks; ++it, ++i)
+        ack->add_selective_acks(*it);
+
+    return ack;
+}
+
+bool EOSSDK_P2P::on_p2p_data(Network_Message_pb const& msg, P2P_Data_Message_pb const& data)
+{
+    TRACE_FUNC();
+    LOCAL_LOCK();
+
+    EOS_ProductUserId remote_id = GetProductUserId(msg.source_id());
+    auto& p2p_state = _p2p_connections[remote_id];
+
+    P2P_Data_Acknowledge_pb* ack;
+
+    if (receive_p2p_data(remote_id, p2p_state, data))
+    {
+        if (data.sequence() == 0)
+            return true;
+
+        ack = make_p2p_data_ack(p2p_state, data.channel());
+    }
+    else
+    {
+        ack = new P2P_Data_Acknowledge_pb;
+        ack->set_accepted(false);
     }
 
     return send_p2p_data_ack(msg.source_id(), ack);
 }
 
+bool EOSSDK_P2P::on_p2p_data_batch(Network_Message_pb const& msg, P2P_Data_Batch_pb const& batch)
+{
+    TRACE_FUNC();
+    LOCAL_LOCK();
+
+    EOS_ProductUserId remote_id = GetProductUserId(msg.source_id());
+    auto& p2p_state = _p2p_connections[remote_id];
+
+    // A single ack covers all the reliable packets of the batch
+    bool refused = false;
+    int32_t ack_channel = -1;
+    for (auto const& data : batch.messages())
+    {
+        if (!receive_p2p_data(remote_id, p2p_state, data))
+            refused = true;
+        else if (data.sequence() != 0)
+            ack_channel = data.channel();
+    }
+
+    if (refused)
+    {
+        P2P_Data_Acknowledge_pb* ack = new P2P_Data_Acknowledge_pb;
+        ack->set_accepted(false);
+        return send_p2p_data_ack(msg.source_id(), ack);
+    }
+
+    if (ack_channel != -1)
+        return send_p2p_data_ack(msg.source_id(), make_p2p_data_ack(p2p_state, ack_channel));
+
+    return true;
+}
+
 bool EOSSDK_P2P::on_p2p_data_ack(Network_Message_pb const& msg, P2P_Data_Acknowledge_pb const& ack)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
+
+    auto it = _p2p_connections.find(GetProductUserId(msg.source_id()));
+    if (it == _p2p_connections.end())
+        return true;
+
+    auto& reliable = it->second.reliability;
+    if (ack.ack_sequence() == 0 || ack.epoch() != reliable.send_epoch)
+    {// Unreliable ack or ack from a previous stream
+        return true;
+    }
+
+    // Only the most recently acked packet is used as RTT sample, older ones might have waited for a lost packet.
+    // Retransmitted packets are never sampled (Karn's algorithm).
+    p2p_reliable_packet_t const* rtt_packet = nullptr;
+    uint32_t rtt_sequence = 0;
+    auto packet_acked = [&](std::map<uint32_t, p2p_reliable_packet_t>::iterator packet_it)
+    {
+        if (packet_it->first >= rtt_sequence)
+        {
+            rtt_sequence = packet_it->first;
+            rtt_packet = (packet_it->second.retries == 0 ? &packet_it->second : nullptr);
+        }
+    };
+
+    std::vector<uint32_t> acked_sequences;
+    for (auto packet_it = reliable.unacked_packets.begin(); packet_it != reliable.unacked_packets.end() && packet_it->first < ack.ack_sequence(); ++packet_it)
+    {
+        packet_acked(packet_it);
+        acked_sequences.emplace_back(packet_it->first);
+    }
+    for (auto sequence : ack.selective_acks())
+    {
+        auto packet_it = reliable.unacked_packets.find(sequence);
+        if (packet_it != reliable.unacked_packets.end())
+        {
+            packet_acked(packet_it);
+            acked_sequences.emplace_back(sequence);
+        }
+    }
+
+    if (rtt_packet != nullptr)
+        reliable.add_rtt_sample(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - rtt_packet->first_send));
+
+    for (auto sequence : acked_sequences)
+        reliable.unacked_packets.erase(sequence);
 
     return true;
 }
@@ -923,19 +1498,20 @@ bool EOSSDK_P2P::on_p2p_data_ack(Network_Message_pb const& msg, P2P_Data_Acknowl
 bool EOSSDK_P2P::on_p2p_connection_close(Network_Message_pb const& msg, P2P_Connection_Close_pb const& close)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
-    std::vector<pFrameResult_t> notifs = std::move(GetCB_Manager().get_notifications(this, EOS_P2P_OnRemoteConnectionClosedInfo::k_iCallback));
-    for (auto& notif : notifs)
+    EOS_ProductUserId remote_id = GetProductUserId(msg.source_id());
+    GetCB_Manager().post_notifications(this, EOS_P2P_OnRemoteConnectionClosedInfo::k_iCallback, [remote_id](FrameResult& notif)
     {
-        EOS_P2P_OnRemoteConnectionClosedInfo& orcci = notif->GetCallback<EOS_P2P_OnRemoteConnectionClosedInfo>();
+        EOS_P2P_OnRemoteConnectionClosedInfo& orcci = notif.GetCallback<EOS_P2P_OnRemoteConnectionClosedInfo>();
         orcci.Reason = EOS_EConnectionClosedReason::EOS_CCR_ClosedByPeer;
-        orcci.RemoteUserId = GetProductUserId(msg.source_id());
+        orcci.RemoteUserId = remote_id;
+    });
 
-        notif->GetFunc()(notif->GetFuncParam());
-    }
-
-    _p2p_connections[GetProductUserId(msg.source_id())].status = p2p_state_t::status_e::closed;
+    auto& conn = _p2p_connections[remote_id];
+    conn.status = p2p_state_t::status_e::closed;
+    // The peer starts a new stream on its next connection
+    conn.reliability.restart_recv(0);
 
     return true;
 }
@@ -945,12 +1521,30 @@ bool EOSSDK_P2P::on_p2p_connection_close(Network_Message_pb const& msg, P2P_Conn
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_P2P::CBRunFrame()
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     for (auto it = _p2p_connections.begin(); it != _p2p_connections.end(); ++it)
     {
         switch(it->second.status)
         {
+            case p2p_state_t::status_e::connected:
+            {
+                if (!resend_reliable_p2p_data(it->first, it->second))
+                {
+                    close_timed_out_p2p_connection(it->first, it->second);
+                    break;
+                }
+                // Ordered packets that didn't fit in a full game queue
+                for (auto& pending : it->second.reliability.out_of_order_packets)
+                {
+                    if (!pending.second.empty())
+                        queue_p2p_held_messages(it->second, pending.first);
+                }
+                // Send everything that was coalesced during the frame
+                flush_p2p_batch(it->first, it->second);
+            }
+            break;
+
             case p2p_state_t::status_e::requesting:
             {
                 auto now = std::chrono::steady_clock::now();
@@ -1023,6 +1617,7 @@ bool EOSSDK_P2P::RunNetwork(Network_Message_pb const& msg)
                 case P2P_Message_pb::MessageCase::kDataMessage    : return on_p2p_data(msg, p2p.data_message());
                 case P2P_Message_pb::MessageCase::kDataAcknowledge: return on_p2p_data_ack(msg, p2p.data_acknowledge());
                 case P2P_Message_pb::MessageCase::kConnectionClose: return on_p2p_connection_close(msg, p2p.connection_close());
+                case P2P_Message_pb::MessageCase::kDataBatch      : return on_p2p_data_batch(msg, p2p.data_batch());
                 default: APP_LOG(Log::LogLevel::WARN, "Unhandled network message %d", p2p.message_case());
             }
         }
@@ -1033,14 +1628,14 @@ bool EOSSDK_P2P::RunNetwork(Network_Message_pb const& msg)
 
 bool EOSSDK_P2P::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;
 }
 
 void EOSSDK_P2P::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
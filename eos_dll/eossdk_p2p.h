@@ -22,9 +22,98 @@
 #include "common_includes.h"
 #include "callback_manager.h"
 #include "network.h"
+#include "spsc_ring.h"
+#include "eos_p2p_ext.h"
 
 namespace sdk
 {
+    struct p2p_reliable_packet_t
+    {
+        P2P_Data_Message_pb data;
+        std::chrono::steady_clock::time_point first_send;
+        std::chrono::steady_clock::time_point last_send;
+        uint32_t retries;
+    };
+
+    // Reliability state of a connection, used by EOS_PR_ReliableUnordered and EOS_PR_ReliableOrdered packets.
+    // Unreliable packets don't use it and are sent as is.
+    struct p2p_reliability_t
+    {
+        constexpr static auto min_rto = std::chrono::milliseconds(50);
+        constexpr static auto max_rto = std::chrono::milliseconds(2000);
+        // Packets held for a missing one, the ones past it aren't acknowledged and are sent again later
+        constexpr static size_t max_packets_ahead = 1024;
+
+        // Send side
+        uint32_t send_epoch;
+        uint32_t next_send_sequence;
+        std::unordered_map<int32_t, uint32_t> next_send_order;
+        std::map<uint32_t, p2p_reliable_packet_t> unacked_packets;
+
+        // Retransmit timeout estimation (RFC 6298)
+        std::chrono::microseconds srtt;
+        std::chrono::microseconds rttvar;
+        std::chrono::microseconds rto;
+
+        // Receive side
+        bool recv_started;
+        uint32_t recv_epoch;
+        uint32_t next_recv_sequence;
+        std::set<uint32_t> recv_sequences_ahead;
+        std::unordered_map<int32_t, uint32_t> next_recv_order;
+        std::unordered_map<int32_t, std::map<uint32_t, P2P_Data_Message_pb>> out_of_order_packets;
+
+        p2p_reliability_t();
+
+        void reset_send();
+        void reset_recv(uint32_t epoch);
+        // Epoch from the peer connection handshake, 0 waits for the epoch of its next reliable packet
+        void restart_recv(uint32_t epoch);
+        void add_rtt_sample(std::chrono::microseconds rtt);
+    };
+
+    // Inbound packets, one ring per channel and a bitmap of the channels that have packets.
+    // The P2P frame pushes the received packets, ReceivePacket reads them without locking.
+    class LOCAL_API p2p_in_channels_t
+    {
+    public:
+        constexpr static size_t max_channels = 256;
+        constexpr static size_t max_packets_per_channel = 1024;
+
+        using queue_t = spsc_ring<P2P_Data_Message_pb, max_packets_per_channel>;
+
+    private:
+        // Allocated on the first packet of a channel
+        std::array<std::atomic<queue_t*>, max_channels> _queues;
+        std::array<std::atomic<uint64_t>, max_channels / 64> _ready_channels;
+        std::atomic<uint64_t> _dropped_packets;
+        // Peers removed from any thread, the consumer drops their packets on its next read
+        std::mutex _removed_peers_mutex;
+        std::vector<std::string> _removed_peers;
+        std::atomic<bool> _has_removed_peers;
+
+        void set_ready(uint8_t channel);
+        void clear_ready(uint8_t channel);
+        // Consumer side
+        void drop_removed_peers();
+
+    public:
+        p2p_in_channels_t();
+        ~p2p_in_channels_t();
+
+        // Producer side, returns false if the channel queue is full
+        bool push(P2P_Data_Message_pb&& msg);
+
+        // Consumer side, channel -1 means any channel
+        P2P_Data_Message_pb* front(int32_t channel);
+        void pop(uint8_t channel);
+
+        // Any thread, the rings only have one consumer so the packets are dropped on its next front()
+        void remove_peer(std::string const& user_id);
+
+        inline uint64_t dropped_packets() const { return _dropped_packets.load(std::memory_order_relaxed); }
+    };
+
     struct p2p_state_t
     {
         enum class status_e
@@ -40,9 +129,14 @@ namespace sdk
         std::list<P2P_Data_Message_pb> p2p_out_messages;
         std::string socket_name;
         std::chrono::steady_clock::time_point connection_loss_start;
+        p2p_reliability_t reliability;
+        // Packets waiting for the end of the frame when p2p_coalesce_packets is on
+        P2P_Data_Batch_pb out_batch;
+        size_t out_batch_size;
 
         p2p_state_t() :
-            status(status_e::closed)
+            status(status_e::closed),
+            out_batch_size(0)
         {}
     };
 
@@ -52,11 +146,16 @@ namespace sdk
     {
         constexpr static auto connecting_timeout = std::chrono::milliseconds(5000);
         constexpr static auto connection_timeout = std::chrono::milliseconds(10000);
+        constexpr static uint32_t reliable_max_retries = 15;
+        constexpr static int max_selective_acks = 64;
+        // Flush a batch before it gets bigger than this, leaves room for the Network_Message_pb headers in a 1500 bytes MTU
+        constexpr static size_t max_batch_size = 1200;
 
         std::recursive_mutex local_mutex;
 
-        int32_t next_requested_channel;
-        std::unordered_map<uint8_t, std::list<P2P_Data_Message_pb>> _p2p_in_messages;
+        // Set by GetNextReceivedPacketSize for the next ReceivePacket, both run without the lock
+        std::atomic<int32_t> next_requested_channel;
+        p2p_in_channels_t _p2p_in_messages;
         std::unordered_map<EOS_ProductUserId, p2p_state_t> _p2p_connections;
 
         EOS_ERelayControl _relay_control;
@@ -68,11 +167,33 @@ namespace sdk
         ~EOSSDK_P2P();
 
         void set_p2p_state_connected(EOS_ProductUserId remote_id, p2p_state_t& state);
+        // Returns false if the channel queue is full, the packet is left untouched
+        bool queue_p2p_in_message(P2P_Data_Message_pb&& data);
+        // Queues the held ordered packets that are next in order
+        void queue_p2p_held_messages(p2p_state_t& state, int32_t channel);
+        // Pops up to max_packets packets that fit in out_data, used by ReceivePacket and ReceivePacketsExt
+        uint32_t receive_p2p_packets(int32_t channel, uint32_t max_packets, EOS_P2P_ReceivedPacketExt* out_packets, uint8_t* out_data, uint32_t max_data_size, uint32_t& bytes_written);
+
+        // Reliability layer
+        // Numbers the reliable packets, the ones sent to peers without the reliability layer are sent once
+        void prepare_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb& data);
+        bool send_p2p_packet(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb& data);
+        void receive_reliable_p2p_data(p2p_state_t& state, P2P_Data_Message_pb const& data);
+        // Returns false if a packet ran out of retries
+        bool resend_reliable_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state);
+        void close_timed_out_p2p_connection(EOS_ProductUserId remote_id, p2p_state_t& state);
+        bool receive_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb const& data);
+        P2P_Data_Acknowledge_pb* make_p2p_data_ack(p2p_state_t const& state, int32_t channel) const;
+
+        // Send side coalescing
+        bool post_p2p_data(EOS_ProductUserId remote_id, p2p_state_t& state, P2P_Data_Message_pb& data);
+        void flush_p2p_batch(EOS_ProductUserId remote_id, p2p_state_t& state);
 
         // Send Network messages
         bool send_p2p_connection_request(Network::peer_t const& peerid, P2P_Connect_Request_pb *req) const;
         bool send_p2p_connection_response(Network::peer_t const& peerid, P2P_Connect_Response_pb *resp) const;
         bool send_p2p_data(Network::peer_t const& peerid, P2P_Data_Message_pb *data) const;
+        bool send_p2p_data_batch(Network::peer_t const& peerid, P2P_Data_Batch_pb *batch) const;
         bool send_p2p_data_ack(Network::peer_t const& peerid, P2P_Data_Acknowledge_pb *ack) const;
         bool send_p2p_connetion_close(Network::peer_t const& peerid, P2P_Connection_Close_pb *close) const;
 
@@ -82,6 +203,7 @@ namespace sdk
         bool on_p2p_connection_request(Network_Message_pb const& msg, P2P_Connect_Request_pb const& req);
         bool on_p2p_connection_response(Network_Message_pb const& msg, P2P_Connect_Response_pb const& resp);
         bool on_p2p_data(Network_Message_pb const& msg, P2P_Data_Message_pb const& data);
+        bool on_p2p_data_batch(Network_Message_pb const& msg, P2P_Data_Batch_pb const& batch);
         bool on_p2p_data_ack(Network_Message_pb const& msg, P2P_Data_Acknowledge_pb const& ack);
         bool on_p2p_connection_close(Network_Message_pb const& msg, P2P_Connection_Close_pb const& close);
 
@@ -93,6 +215,7 @@ namespace sdk
         EOS_EResult        SendPacket(const EOS_P2P_SendPacketOptions* Options);
         EOS_EResult        GetNextReceivedPacketSize(const EOS_P2P_GetNextReceivedPacketSizeOptions* Options, uint32_t* OutPacketSizeBytes);
         EOS_EResult        ReceivePacket(const EOS_P2P_ReceivePacketOptions* Options, EOS_ProductUserId* OutPeerId, EOS_P2P_SocketId* OutSocketId, uint8_t* OutChannel, void* OutData, uint32_t* OutBytesWritten);
+        EOS_EResult        ReceivePacketsExt(const EOS_P2P_ReceivePacketsExtOptions* Options, EOS_P2P_ReceivedPacketExt* OutPackets, void* OutData, uint32_t* OutPacketCount, uint32_t* OutBytesWritten);
         EOS_NotificationId AddNotifyPeerConnectionRequest(const EOS_P2P_AddNotifyPeerConnectionRequestOptions* Options, void* ClientData, EOS_P2P_OnIncomingConnectionRequestCallback ConnectionRequestHandler);
         void               RemoveNotifyPeerConnectionRequest(EOS_NotificationId NotificationId);
         EOS_NotificationId               AddNotifyPeerConnectionEstablished(const EOS_P2P_AddNotifyPeerConnectionEstablishedOptions* Options, void* ClientData, EOS_P2P_OnPeerConnectionEstablishedCallback ConnectionEstablishedHandler);
@@ -29,6 +29,8 @@ EOSSDK_Platform::EOSSDK_Platform():
 
     _cb_manager       (nullptr),
     _network          (nullptr),
+    _io_pool          (nullptr),
+    _mapped_files     (nullptr),
     _metrics          (nullptr),
     _auth             (nullptr),
     _connect          (nullptr),
@@ -89,8 +91,7 @@ void EOSSDK_Platform::Init(const EOS_Platform_Options* Options)
                 case EOS_PLATFORM_OPTIONS_API_007:
                 {
                     auto pf = reinterpret_cast<const EOS_Platform_Options007*>(Options);
-                    if (pf->CacheDirectory != nullptr)
-                        _ticket_budget_in_milliseconds = pf->TickBudgetInMilliseconds;
+                    _ticket_budget_in_milliseconds = pf->TickBudgetInMilliseconds;
 
                     APP_LOG(Log::LogLevel::DEBUG, "TickBudgetInMilliseconds = '%d'", _ticket_budget_in_milliseconds);
                 }                
@@ -158,6 +159,10 @@ void EOSSDK_Platform::Init(const EOS_Platform_Options* Options)
             }
         }
 
+        // Before the storages, they run their file transfers on it
+        _io_pool           = new io_pool;
+        _mapped_files      = new mapped_file_cache(Settings::Inst().storage_mmap_max_size);
+
         _auth              = new EOSSDK_Auth;
         _friends           = new EOSSDK_Friends;
         _presence          = new EOSSDK_Presence;
@@ -204,6 +209,14 @@ void EOSSDK_Platform::Release()
         delete _connect;
         delete _auth;
         delete _metrics;
+        // After the storages: waits for their pending writes
+        delete _io_pool;
+        _io_pool = nullptr;
+        delete _mapped_files;
+        _mapped_files = nullptr;
+
+        lock_profiler_dump();
+        Log::flush();
 
         _platform_init = false;
     }
@@ -215,7 +228,7 @@ void EOSSDK_Platform::Release()
  */
 void EOSSDK_Platform::Tick()
 {
-    GLOBAL_LOCK();
+    // No GLOBAL_LOCK, the Callback_Manager serializes the ticks and the interfaces lock themselves
     GetCB_Manager().set_max_tick_budget(_ticket_budget_in_milliseconds);
     GetCB_Manager().tick();
 }
@@ -229,7 +242,6 @@ void EOSSDK_Platform::Tick()
  */
 EOS_HMetrics           EOSSDK_Platform::GetMetricsInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HMetrics>(_metrics);
 }
 
@@ -242,7 +254,6 @@ EOS_HMetrics           EOSSDK_Platform::GetMetricsInterface()
  */
 EOS_HAuth              EOSSDK_Platform::GetAuthInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HAuth>(_auth);
 }
 
@@ -255,7 +266,6 @@ EOS_HAuth              EOSSDK_Platform::GetAuthInterface()
  */
 EOS_HConnect           EOSSDK_Platform::GetConnectInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HConnect>(_connect);
 }
 
@@ -268,7 +278,6 @@ EOS_HConnect           EOSSDK_Platform::GetConnectInterface()
  */
 EOS_HEcom              EOSSDK_Platform::GetEcomInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HEcom>(_ecom);
 }
 
@@ -281,7 +290,6 @@ EOS_HEcom              EOSSDK_Platform::GetEcomInterface()
  */
 EOS_HUI                EOSSDK_Platform::GetUIInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HUI>(_ui);
 }
 
@@ -294,7 +302,6 @@ EOS_HUI                EOSSDK_Platform::GetUIInterface()
  */
 EOS_HFriends           EOSSDK_Platform::GetFriendsInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HFriends>(_friends);
 }
 
@@ -307,7 +314,6 @@ EOS_HFriends           EOSSDK_Platform::GetFriendsInterface()
  */
 EOS_HPresence          EOSSDK_Platform::GetPresenceInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HPresence>(_presence);
 }
 
@@ -321,7 +327,6 @@ EOS_HPresence          EOSSDK_Platform::GetPresenceInterface()
  */
 EOS_HSessions          EOSSDK_Platform::GetSessionsInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HSessions>(_sessions);
 }
 
@@ -334,7 +339,6 @@ EOS_HSessions          EOSSDK_Platform::GetSessionsInterface()
  */
 EOS_HLobby             EOSSDK_Platform::GetLobbyInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HLobby>(_lobby);
 }
 
@@ -347,7 +351,6 @@ EOS_HLobby             EOSSDK_Platform::GetLobbyInterface()
  */
 EOS_HUserInfo          EOSSDK_Platform::GetUserInfoInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HUserInfo>(_userinfo);
 }
 
@@ -360,7 +363,6 @@ EOS_HUserInfo          EOSSDK_Platform::GetUserInfoInterface()
  */
 EOS_HP2P               EOSSDK_Platform::GetP2PInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HP2P>(_p2p);
 }
 
@@ -373,7 +375,6 @@ EOS_HP2P               EOSSDK_Platform::GetP2PInterface()
  */
 EOS_HPlayerDataStorage EOSSDK_Platform::GetPlayerDataStorageInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HPlayerDataStorage>(_playerdatastorage);
 }
 
@@ -386,7 +387,6 @@ EOS_HPlayerDataStorage EOSSDK_Platform::GetPlayerDataStorageInterface()
  */
 EOS_HTitleStorage EOSSDK_Platform::GetTitleStorageInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HTitleStorage>(_titlestorage);
 }
 
@@ -399,7 +399,6 @@ EOS_HTitleStorage EOSSDK_Platform::GetTitleStorageInterface()
  */
 EOS_HAchievements      EOSSDK_Platform::GetAchievementsInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HAchievements>(_achievements);
 }
 
@@ -412,7 +411,6 @@ EOS_HAchievements      EOSSDK_Platform::GetAchievementsInterface()
  */
 EOS_HStats             EOSSDK_Platform::GetStatsInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HStats>(_stats);
 }
 
@@ -425,7 +423,6 @@ EOS_HStats             EOSSDK_Platform::GetStatsInterface()
  */
 EOS_HLeaderboards      EOSSDK_Platform::GetLeaderboardsInterface()
 {
-    GLOBAL_LOCK();
     return reinterpret_cast<EOS_HLeaderboards>(_leaderboards);
 }
 
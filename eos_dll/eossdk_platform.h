@@ -23,6 +23,8 @@
 
 #include "callback_manager.h"
 #include "network.h"
+#include "io_pool.h"
+#include "mapped_file.h"
 
 #include "eossdk_metrics.h"
 #include "eossdk_auth.h"
@@ -67,6 +69,8 @@ namespace sdk
 
         Callback_Manager      *_cb_manager;
         Network               *_network;
+        io_pool               *_io_pool;
+        mapped_file_cache     *_mapped_files;
 
         EOSSDK_Metrics           *_metrics;
         EOSSDK_Auth              *_auth;
@@ -123,6 +127,8 @@ inline sdk::EOSSDK_Platform&          GetEOS_Platform         () { return  sdk::
 
 inline Callback_Manager&              GetCB_Manager           () { return *GetEOS_Platform()._cb_manager;        }
 inline Network&                       GetNetwork              () { return *GetEOS_Platform()._network;           }
+inline io_pool&                       GetIO_Pool              () { return *GetEOS_Platform()._io_pool;           }
+inline mapped_file_cache&             GetMapped_Files         () { return *GetEOS_Platform()._mapped_files;      }
 
 inline sdk::EOSSDK_Metrics&           GetEOS_Metrics          () { return *GetEOS_Platform()._metrics;           }
 inline sdk::EOSSDK_Auth&              GetEOS_Auth             () { return *GetEOS_Platform()._auth;              }
@@ -25,8 +25,11 @@ namespace sdk
 {
 
 decltype(EOSSDK_PlayerDataStorage::remote_directory) EOSSDK_PlayerDataStorage::remote_directory("remote");
+decltype(EOSSDK_PlayerDataStorage::metadata_index)   EOSSDK_PlayerDataStorage::metadata_index("remote_metadata.json");
+decltype(EOSSDK_PlayerDataStorage::temp_directory)   EOSSDK_PlayerDataStorage::temp_directory("remote_temp");
 
-EOSSDK_PlayerDataStorage::EOSSDK_PlayerDataStorage()
+EOSSDK_PlayerDataStorage::EOSSDK_PlayerDataStorage():
+    _metadata_cache(metadata_index)
 {
     APP_LOG(Log::LogLevel::INFO, "PlayerDataStorage files will be search in %s", FileManager::canonical_path(remote_directory).c_str());
 
@@ -38,24 +41,20 @@ EOSSDK_PlayerDataStorage::~EOSSDK_PlayerDataStorage()
 {
     GetCB_Manager().unregister_frame(this);
     GetCB_Manager().unregister_callbacks(this);
+
+    _metadata_cache.save();
 }
 
 bool EOSSDK_PlayerDataStorage::get_metadata(std::string const& filename)
 {
     std::string file_path(FileManager::join(remote_directory, FileManager::clean_path(filename)));
-    std::ifstream in_file = FileManager::open_read(file_path, std::ios::binary);
-    if (in_file)
+    FileManager::file_info_t file_info;
+    std::string md5sum;
+    if (_metadata_cache.get(filename, file_path, file_info, md5sum))
     {
         auto& metadata = _files_cache[filename];
-        in_file.seekg(0, std::ios::end);
-        metadata.file_size = in_file.tellg();
-        in_file.seekg(0, std::ios::beg);
-
-        std::string buffer(metadata.file_size, '\0');
-        in_file.read(&buffer[0], metadata.file_size);
-
-        metadata.md5sum = std::move(md5(buffer));
-
+        metadata.file_size = file_info.size;
+        metadata.md5sum = std::move(md5sum);
         metadata.file_path = std::move(file_path);
 
         return true;
@@ -89,7 +88,7 @@ bool EOSSDK_PlayerDataStorage::get_metadata(std::string const& filename)
 void EOSSDK_PlayerDataStorage::QueryFile(const EOS_PlayerDataStorage_QueryFileOptions* QueryFileOptions, void* ClientData, const EOS_PlayerDataStorage_OnQueryFileCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return;
@@ -142,7 +141,7 @@ void EOSSDK_PlayerDataStorage::QueryFile(const EOS_PlayerDataStorage_QueryFileOp
 void EOSSDK_PlayerDataStorage::QueryFileList(const EOS_PlayerDataStorage_QueryFileListOptions* QueryFileListOptions, void* ClientData, const EOS_PlayerDataStorage_OnQueryFileListCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return;
@@ -162,13 +161,26 @@ void EOSSDK_PlayerDataStorage::QueryFileList(const EOS_PlayerDataStorage_QueryFi
     {
         std::vector<std::string> files(std::move(FileManager::list_files(remote_directory, true)));
 
-        _files_cache.clear();
+        std::vector<std::string> file_paths;
+        file_paths.reserve(files.size());
         for (auto& file_name : files)
         {
             std::replace(file_name.begin(), file_name.end(), '\\', '/');
+            file_paths.emplace_back(FileManager::join(remote_directory, FileManager::clean_path(file_name)));
+        }
+        // Hash all the new or changed files in one batch, get_metadata will only hit the index
+        _metadata_cache.refresh(files, file_paths);
+
+        _files_cache.clear();
+        for (auto& file_name : files)
+        {
             get_metadata(file_name);
         }
 
+        // We've seen every file, drop the index entries of the deleted ones
+        _metadata_cache.retain(_files_cache);
+        _metadata_cache.save();
+
         qflci.FileCount = _files_cache.size();
         qflci.ResultCode = EOS_EResult::EOS_Success;
     }
@@ -188,7 +200,7 @@ void EOSSDK_PlayerDataStorage::QueryFileList(const EOS_PlayerDataStorage_QueryFi
 EOS_EResult EOSSDK_PlayerDataStorage::CopyFileMetadataByFilename(const EOS_PlayerDataStorage_CopyFileMetadataByFilenameOptions* CopyFileMetadataOptions, EOS_PlayerDataStorage_FileMetadata** OutMetadata)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CopyFileMetadataOptions == nullptr || CopyFileMetadataOptions->Filename == nullptr || OutMetadata == nullptr)
     {
@@ -239,7 +251,7 @@ EOS_EResult EOSSDK_PlayerDataStorage::CopyFileMetadataByFilename(const EOS_Playe
 EOS_EResult EOSSDK_PlayerDataStorage::GetFileMetadataCount(const EOS_PlayerDataStorage_GetFileMetadataCountOptions* GetFileMetadataCountOptions, int32_t* OutFileMetadataCount)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (GetFileMetadataCountOptions == nullptr || OutFileMetadataCount == nullptr)
     {
@@ -267,7 +279,7 @@ EOS_EResult EOSSDK_PlayerDataStorage::GetFileMetadataCount(const EOS_PlayerDataS
 EOS_EResult EOSSDK_PlayerDataStorage::CopyFileMetadataAtIndex(const EOS_PlayerDataStorage_CopyFileMetadataAtIndexOptions* CopyFileMetadataOptions, EOS_PlayerDataStorage_FileMetadata** OutMetadata)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CopyFileMetadataOptions == nullptr || CopyFileMetadataOptions->Index >= _files_cache.size() || OutMetadata == nullptr)
     {
@@ -312,7 +324,7 @@ EOS_EResult EOSSDK_PlayerDataStorage::CopyFileMetadataAtIndex(const EOS_PlayerDa
 void EOSSDK_PlayerDataStorage::DuplicateFile(const EOS_PlayerDataStorage_DuplicateFileOptions* DuplicateOptions, void* ClientData, const EOS_PlayerDataStorage_OnDuplicateFileCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return;
@@ -335,18 +347,42 @@ void EOSSDK_PlayerDataStorage::DuplicateFile(const EOS_PlayerDataStorage_Duplica
         if (in_file)
         {
             std::string dst_file(FileManager::join(remote_directory, FileManager::clean_path(DuplicateOptions->DestinationFilename)));
-            std::ofstream out_file = FileManager::open_write(dst_file, std::ios::binary | std::ios::trunc);
-            if (out_file)
-            {
-                char* buff = new char[1024 * 1024];
 
-                while(in_file.read(buff, 1024 * 1024).good())
+            // Copy in a temporary file and rename it over the destination like WriteFile,
+            // the reads of the destination still running keep reading the old file
+            char temp_name[17] = {};
+            random_string("0123456789abcdef", temp_name, 16);
+            std::string temp_path = FileManager::join(temp_directory, std::string(temp_name) + ".tmp");
+
+            bool copied = false;
+            {
+                std::ofstream out_file = FileManager::open_write(temp_path, std::ios::binary | std::ios::trunc);
+                if (out_file)
                 {
-                    out_file.write(buff, in_file.gcount());
+                    char* buff = new char[1024 * 1024];
+
+                    do
+                    {
+                        in_file.read(buff, 1024 * 1024);
+                        out_file.write(buff, in_file.gcount());
+                    } while (in_file);
+
+                    delete[]buff;
+
+                    out_file.close();
+                    copied = !out_file.fail();
                 }
+            }
 
-                delete[]buff;
+            if (copied)
+            {
+                // Windows can't replace a mapped file, the reads still running keep their own mapping
+                GetMapped_Files().invalidate(dst_file);
+                copied = FileManager::rename_file(temp_path, dst_file);
+            }
 
+            if (copied)
+            {
                 // Also duplicate metadatas
                 auto& src_cache = _files_cache[DuplicateOptions->SourceFilename];
                 auto& dst_cache = _files_cache[DuplicateOptions->DestinationFilename];
@@ -356,6 +392,7 @@ void EOSSDK_PlayerDataStorage::DuplicateFile(const EOS_PlayerDataStorage_Duplica
             }
             else
             {
+                FileManager::delete_file(temp_path);
                 dfci.ResultCode = EOS_EResult::EOS_UnexpectedError;
             }
         }
@@ -379,7 +416,7 @@ void EOSSDK_PlayerDataStorage::DuplicateFile(const EOS_PlayerDataStorage_Duplica
 void EOSSDK_PlayerDataStorage::DeleteFile(const EOS_PlayerDataStorage_DeleteFileOptions* DeleteOptions, void* ClientData, const EOS_PlayerDataStorage_OnDeleteFileCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return;
@@ -401,8 +438,12 @@ void EOSSDK_PlayerDataStorage::DeleteFile(const EOS_PlayerDataStorage_DeleteFile
         {
             _files_cache.erase(it);
         }
+        _metadata_cache.erase(DeleteOptions->Filename);
 
-        if (FileManager::delete_file(FileManager::join(remote_directory, DeleteOptions->Filename)))
+        std::string file_path(FileManager::join(remote_directory, FileManager::clean_path(DeleteOptions->Filename)));
+        // Windows can't delete a mapped file
+        GetMapped_Files().invalidate(file_path);
+        if (FileManager::delete_file(file_path))
         {
             dfci.ResultCode = EOS_EResult::EOS_Success;
         }
@@ -431,7 +472,7 @@ void EOSSDK_PlayerDataStorage::DeleteFile(const EOS_PlayerDataStorage_DeleteFile
 EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::ReadFile(const EOS_PlayerDataStorage_ReadFileOptions* ReadOptions, void* ClientData, const EOS_PlayerDataStorage_OnReadFileCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return nullptr;
@@ -457,7 +498,7 @@ EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::ReadFile(con
         rfci.Filename = str;
     }
 
-    if (ReadOptions == nullptr || ReadOptions->Filename == nullptr || ReadOptions->ReadFileDataCallback == nullptr)
+    if (ReadOptions == nullptr || ReadOptions->Filename == nullptr || ReadOptions->ReadFileDataCallback == nullptr || ReadOptions->ReadChunkLengthBytes == 0)
     {
         rfci.ResultCode = EOS_EResult::EOS_InvalidParameters;
         res->done = true;
@@ -476,7 +517,12 @@ EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::ReadFile(con
 
             EOSSDK_PlayerDataStorageFileTransferRequest*& res_obj = _transferts[res];
             res_obj = new EOSSDK_PlayerDataStorageFileTransferRequest;
-            res_obj->set_read_transfert(ReadOptions);
+            // The chunks are mapped or prefetched on the io_pool and sent to the game from RunCallbacks,
+            // the reader wakes the result up when a chunk is ready
+            if (!res_obj->set_read_transfert(ReadOptions, res))
+            {
+                APP_LOG(Log::LogLevel::WARN, "Failed to open file: %s", file_path.c_str());
+            }
 
             func_result = reinterpret_cast<EOS_HPlayerDataStorageFileTransferRequest>(res_obj);
         }
@@ -508,7 +554,7 @@ EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::ReadFile(con
 EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::WriteFile(const EOS_PlayerDataStorage_WriteFileOptions* WriteOptions, void* ClientData, const EOS_PlayerDataStorage_OnWriteFileCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
     {
@@ -536,7 +582,7 @@ EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::WriteFile(co
         wfci.Filename = str;
     }
 
-    if (WriteOptions == nullptr || WriteOptions->Filename == nullptr || WriteOptions->WriteFileDataCallback == nullptr)
+    if (WriteOptions == nullptr || WriteOptions->Filename == nullptr || WriteOptions->WriteFileDataCallback == nullptr || WriteOptions->ChunkLengthBytes == 0)
     {
         wfci.ResultCode = EOS_EResult::EOS_InvalidParameters;
         res->done = true;
@@ -545,7 +591,13 @@ EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::WriteFile(co
     {
         EOSSDK_PlayerDataStorageFileTransferRequest*& res_obj = _transferts[res];
         res_obj = new EOSSDK_PlayerDataStorageFileTransferRequest;
-        res_obj->set_write_transfert(WriteOptions);
+        // A failure to create the temporary file is reported by RunCallbacks
+        if (!res_obj->set_write_transfert(WriteOptions, res))
+        {
+            APP_LOG(Log::LogLevel::WARN, "Failed to create the temporary file for: %s", res_obj->_file_name.c_str());
+        }
+        // The chunks are requested to the game from RunCallbacks
+        res->SetPolling(true);
 
         APP_LOG(Log::LogLevel::INFO, "Start Writing file: %s", res_obj->_file_name.c_str());
 
@@ -561,11 +613,12 @@ EOS_HPlayerDataStorageFileTransferRequest EOSSDK_PlayerDataStorage::WriteFile(co
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_PlayerDataStorage::CBRunFrame()
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     for (auto it = _transferts.begin(); it != _transferts.end();)
     {
-        if (it->second->released())
+        // Its result might still be running, it reads the transfer
+        if (it->second->released() && it->second->_done)
         {
             delete it->second;
             it = _transferts.erase(it);
@@ -581,14 +634,20 @@ bool EOSSDK_PlayerDataStorage::CBRunFrame()
 
 bool EOSSDK_PlayerDataStorage::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    // The game data callbacks are called without the lock.
+    // The transfer stays valid meanwhile, it is only deleted by CBRunFrame which runs in the same tick.
+    EOSSDK_PlayerDataStorageFileTransferRequest* transfert_ptr;
+    {
+        LOCAL_LOCK();
+        transfert_ptr = _transferts[res];
+    }
 
     switch (res->ICallback())
     {
         case EOS_PlayerDataStorage_ReadFileCallbackInfo::k_iCallback:
         {
             EOS_PlayerDataStorage_ReadFileCallbackInfo& callback = res->GetCallback<EOS_PlayerDataStorage_ReadFileCallbackInfo>();
-            EOSSDK_PlayerDataStorageFileTransferRequest& transfert = *_transferts[res];
+            EOSSDK_PlayerDataStorageFileTransferRequest& transfert = *transfert_ptr;
 
             if (transfert.canceled())
             {
@@ -598,126 +657,162 @@ bool EOSSDK_PlayerDataStorage::RunCallbacks(pFrameResult_t res)
             }
             else
             {
-                EOS_PlayerDataStorage_ReadFileDataCallbackInfo rfdci;
-                rfdci.ClientData = callback.ClientData;
-                rfdci.Filename = callback.Filename;
-                rfdci.LocalUserId = callback.LocalUserId;
-                rfdci.TotalFileSizeBytes = transfert._file_size;
-
-                transfert._input_file.read((char*)&transfert._file_buffer[0], transfert._chunk_size);
-                size_t read_len = transfert._input_file.gcount();
-
-                rfdci.bIsLastChunk = (read_len != transfert._chunk_size ? EOS_TRUE : EOS_FALSE);
-                if (rfdci.bIsLastChunk == EOS_TRUE)
+                // Hand out the chunks the reader already has, several of them if the tick budget allows it
+                do
                 {
-                    transfert._done = true;
-                    res->done = true;
-                    callback.ResultCode = EOS_EResult::EOS_Success;
-                }
-
-                rfdci.DataChunk = &transfert._file_buffer[0];
-                rfdci.DataChunkLengthBytes = read_len;
-                switch (transfert._read_callback(&rfdci))
-                {
-                    case EOS_PlayerDataStorage_EReadResult::EOS_RR_FailRequest:
+                    chunk_prefetcher::chunk_t* chunk = transfert._reader->front();
+                    if (chunk == nullptr)
                     {
-                        callback.ResultCode = EOS_EResult::EOS_PlayerDataStorage_UserErrorFromDataCallback;
-                        transfert._done = true;
-                        res->done = true;
+                        if (transfert._reader->failed())
+                        {
+                            callback.ResultCode = EOS_EResult::EOS_UnexpectedError;
+                            transfert._done = true;
+                            res->done = true;
+                        }
+                        // Otherwise the reader wakes us up when the next chunk is ready
+                        break;
                     }
-                    break;
 
-                    case EOS_PlayerDataStorage_EReadResult::EOS_RR_CancelRequest:
+                    EOS_PlayerDataStorage_ReadFileDataCallbackInfo rfdci;
+                    rfdci.ClientData = callback.ClientData;
+                    rfdci.Filename = callback.Filename;
+                    rfdci.LocalUserId = callback.LocalUserId;
+                    rfdci.TotalFileSizeBytes = transfert._file_size;
+                    rfdci.bIsLastChunk = (chunk->last ? EOS_TRUE : EOS_FALSE);
+                    if (rfdci.bIsLastChunk == EOS_TRUE)
                     {
-                        callback.ResultCode = EOS_EResult::EOS_Canceled;
-                        transfert._canceled = true;
                         transfert._done = true;
                         res->done = true;
+                        callback.ResultCode = EOS_EResult::EOS_Success;
                     }
-                    break;
 
-                    case EOS_PlayerDataStorage_EReadResult::EOS_RR_ContinueReading:
+                    rfdci.DataChunk = chunk->data;
+                    rfdci.DataChunkLengthBytes = chunk->size;
+                    switch (transfert._read_callback(&rfdci))
                     {
+                        case EOS_PlayerDataStorage_EReadResult::EOS_RR_FailRequest:
+                        {
+                            callback.ResultCode = EOS_EResult::EOS_PlayerDataStorage_UserErrorFromDataCallback;
+                            transfert._done = true;
+                            res->done = true;
+                        }
+                        break;
+
+                        case EOS_PlayerDataStorage_EReadResult::EOS_RR_CancelRequest:
+                        {
+                            callback.ResultCode = EOS_EResult::EOS_Canceled;
+                            transfert._canceled = true;
+                            transfert._done = true;
+                            res->done = true;
+                        }
+                        break;
+
+                        case EOS_PlayerDataStorage_EReadResult::EOS_RR_ContinueReading:
+                        {
+                        }
+                        break;
                     }
-                    break;
-                }
+
+                    transfert._reader->pop();
+                    if (!res->done && GetCB_Manager().tick_budget_exhausted())
+                    {// Out of time, the chunks already there won't wake the result up: run it again on the next tick
+                        GetCB_Manager().ready_callback(res);
+                        break;
+                    }
+                } while (!res->done);
             }
+
+            // Stop the prefetching and give the buffers back
+            if (res->done)
+                transfert._reader->close();
         }
         break;
 
         case EOS_PlayerDataStorage_WriteFileCallbackInfo::k_iCallback:
         {
             EOS_PlayerDataStorage_WriteFileCallbackInfo& callback = res->GetCallback<EOS_PlayerDataStorage_WriteFileCallbackInfo>();
-            EOSSDK_PlayerDataStorageFileTransferRequest& transfert = *_transferts[res];
+            EOSSDK_PlayerDataStorageFileTransferRequest& transfert = *transfert_ptr;
+
+            if (transfert._writer->finished())
+            {// The file was written and renamed on the io_pool, or the write failed
+                if (!transfert._writer->failed())
+                {
+                    LOCAL_LOCK();
+
+                    FileManager::file_info_t const& info = transfert._writer->file_info();
+                    auto& metadata = _files_cache[transfert._file_name];
+                    metadata.file_path = FileManager::join(remote_directory, FileManager::clean_path(transfert._file_name));
+                    metadata.file_size = info.size;
+                    metadata.md5sum = transfert._writer->md5sum();
+                    _metadata_cache.set(transfert._file_name, info, metadata.md5sum);
 
-            if (transfert._canceled)
+                    callback.ResultCode = EOS_EResult::EOS_Success;
+                }
+                else
+                {
+                    callback.ResultCode = EOS_EResult::EOS_UnexpectedError;
+                }
+
+                transfert._done = true;
+                res->done = true;
+            }
+            else if (transfert._writer->completing())
+            {// Still writing the last chunks, the writer wakes us up once the file is renamed
+            }
+            else if (transfert._canceled)
             {
+                transfert._writer->close();
                 callback.ResultCode = EOS_EResult::EOS_Canceled;
                 transfert._done = true;
                 res->done = true;
             }
             else
             {
-                size_t offset = transfert._file_buffer.size();
-                transfert._file_buffer.resize(offset + transfert._chunk_size * 2);
-
-                EOS_PlayerDataStorage_WriteFileDataCallbackInfo wfdci;
-                wfdci.ClientData = callback.ClientData;
-                wfdci.Filename = callback.Filename;
-                wfdci.LocalUserId = callback.LocalUserId;
-
-                uint32_t buff_len = transfert._chunk_size * 2;
-                wfdci.DataBufferLengthBytes = buff_len;
-
-                switch (transfert._write_callback(&wfdci, &transfert._file_buffer[offset], &buff_len))
+                // nullptr while the previous chunks are being written, the writer wakes us up when a buffer is free
+                uint8_t* buffer = transfert._writer->buffer();
+                if (buffer != nullptr)
                 {
-                    case EOS_PlayerDataStorage_EWriteResult::EOS_WR_FailRequest:
-                    {
-                        callback.ResultCode = EOS_EResult::EOS_PlayerDataStorage_UserErrorFromDataCallback;
-                        transfert._done = true;
-                        res->done = true;
-                    }
-                    break;
+                    EOS_PlayerDataStorage_WriteFileDataCallbackInfo wfdci;
+                    wfdci.ClientData = callback.ClientData;
+                    wfdci.Filename = callback.Filename;
+                    wfdci.LocalUserId = callback.LocalUserId;
 
-                    case EOS_PlayerDataStorage_EWriteResult::EOS_WR_CancelRequest:
-                    {
-                        transfert._canceled = true;
-                        transfert._done = true;
-                        callback.ResultCode = EOS_EResult::EOS_Canceled;
-                        res->done = true;
-                    }
-                    break;
+                    uint32_t buff_len = transfert._chunk_size * 2;
+                    wfdci.DataBufferLengthBytes = buff_len;
 
-                    case EOS_PlayerDataStorage_EWriteResult::EOS_WR_ContinueWriting:
+                    switch (transfert._write_callback(&wfdci, buffer, &buff_len))
                     {
-                        transfert._file_buffer.resize(offset + buff_len);
-                    }
-                    break;
+                        case EOS_PlayerDataStorage_EWriteResult::EOS_WR_FailRequest:
+                        {
+                            transfert._writer->close();
+                            callback.ResultCode = EOS_EResult::EOS_PlayerDataStorage_UserErrorFromDataCallback;
+                            transfert._done = true;
+                            res->done = true;
+                        }
+                        break;
 
-                    case EOS_PlayerDataStorage_EWriteResult::EOS_WR_CompleteRequest:
-                    {
-                        transfert._file_buffer.resize(offset + buff_len);
-                        transfert._done = true;
-                        std::ofstream out_file(FileManager::open_write(FileManager::join(remote_directory, FileManager::clean_path(transfert._file_name)), std::ios::binary | std::ios::trunc));
-                        if (out_file)
+                        case EOS_PlayerDataStorage_EWriteResult::EOS_WR_CancelRequest:
+                        {
+                            transfert._writer->close();
+                            transfert._canceled = true;
+                            transfert._done = true;
+                            callback.ResultCode = EOS_EResult::EOS_Canceled;
+                            res->done = true;
+                        }
+                        break;
+
+                        case EOS_PlayerDataStorage_EWriteResult::EOS_WR_ContinueWriting:
                         {
-                            out_file.write((const char*)transfert._file_buffer.data(), transfert._file_buffer.size());
-                            out_file.close();
-                            if(get_metadata(transfert._file_name))
-                            {
-                                callback.ResultCode = EOS_EResult::EOS_Success;
-                            }
-                            else
-                            {
-                                FileManager::delete_file(FileManager::join(remote_directory, transfert._file_name));
-                                callback.ResultCode = EOS_EResult::EOS_UnexpectedError;
-                            }
+                            transfert._writer->push(buff_len);
                         }
-                        else
+                        break;
+
+                        case EOS_PlayerDataStorage_EWriteResult::EOS_WR_CompleteRequest:
                         {
-                            callback.ResultCode = EOS_EResult::EOS_UnexpectedError;
+                            transfert._writer->push(buff_len);
+                            // Sync, rename and hash are done off the game thread, the result is picked on a later tick
+                            transfert._writer->complete();
                         }
-                        res->done = true;
                     }
                 }
             }
@@ -730,7 +825,7 @@ bool EOSSDK_PlayerDataStorage::RunCallbacks(pFrameResult_t res)
 
 void EOSSDK_PlayerDataStorage::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
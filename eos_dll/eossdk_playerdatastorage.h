@@ -21,6 +21,9 @@
 
 #include "common_includes.h"
 #include "callback_manager.h"
+#include "file_metadata_cache.h"
+#include "chunk_prefetcher.h"
+#include "chunk_writer.h"
 
 #ifdef DeleteFile
 #undef DeleteFile
@@ -49,11 +52,14 @@ namespace sdk
         uint32_t _chunk_size;
         uint32_t _file_size;
 
-        std::vector<uint8_t> _file_buffer;
-        std::ifstream _input_file;
+        // Woken up when a chunk is ready, a write buffer is free or the request is canceled
+        pFrameResult_t _result;
 
-        void set_read_transfert(const EOS_PlayerDataStorage_ReadFileOptions* ReadOptions);
-        void set_write_transfert(const EOS_PlayerDataStorage_WriteFileOptions* WriteOptions);
+        std::shared_ptr<chunk_prefetcher> _reader;
+        std::shared_ptr<chunk_writer> _writer;
+
+        bool set_read_transfert(const EOS_PlayerDataStorage_ReadFileOptions* ReadOptions, pFrameResult_t const& res);
+        bool set_write_transfert(const EOS_PlayerDataStorage_WriteFileOptions* WriteOptions, pFrameResult_t const& res);
 
     public:
         EOSSDK_PlayerDataStorageFileTransferRequest();
@@ -71,6 +77,8 @@ namespace sdk
     class EOSSDK_PlayerDataStorage :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
         struct file_metadata_t
         {
             std::string file_path;
@@ -80,11 +88,15 @@ namespace sdk
 
         std::unordered_map<pFrameResult_t, EOSSDK_PlayerDataStorageFileTransferRequest*> _transferts;
         nlohmann::fifo_map<std::string, file_metadata_t> _files_cache;
+        file_metadata_cache _metadata_cache;
 
         bool get_metadata(std::string const& filename);
 
     public:
         static const std::string remote_directory;
+        static const std::string metadata_index;
+        // The files being written, they replace the remote ones once complete
+        static const std::string temp_directory;
 
         EOSSDK_PlayerDataStorage();
         ~EOSSDK_PlayerDataStorage();
@@ -34,10 +34,14 @@ EOSSDK_PlayerDataStorageFileTransferRequest::EOSSDK_PlayerDataStorageFileTransfe
 
 EOSSDK_PlayerDataStorageFileTransferRequest::~EOSSDK_PlayerDataStorageFileTransferRequest()
 {
+    if (_reader != nullptr)
+        _reader->close();
 
+    if (_writer != nullptr)
+        _writer->close();
 }
 
-void EOSSDK_PlayerDataStorageFileTransferRequest::set_read_transfert(const EOS_PlayerDataStorage_ReadFileOptions* ReadOptions)
+bool EOSSDK_PlayerDataStorageFileTransferRequest::set_read_transfert(const EOS_PlayerDataStorage_ReadFileOptions* ReadOptions, pFrameResult_t const& res)
 {
     std::lock_guard<std::mutex> _lk(_local_mutex);
     std::string file_path = FileManager::join(EOSSDK_PlayerDataStorage::remote_directory, FileManager::clean_path(ReadOptions->Filename));
@@ -47,19 +51,39 @@ void EOSSDK_PlayerDataStorageFileTransferRequest::set_read_transfert(const EOS_P
     _chunk_size = ReadOptions->ReadChunkLengthBytes;
     _file_name = ReadOptions->Filename;
     _file_size = FileManager::file_size(file_path);
-
-    _file_buffer.resize(_chunk_size);
-    _input_file = std::move(FileManager::open_read(file_path, std::ios::binary));
+    _result = res;
+
+    // The chunks are read on the io_pool, the result is run again when one is ready
+    _reader = std::make_shared<chunk_prefetcher>(GetIO_Pool(), &GetMapped_Files(), _chunk_size);
+    pFrameResult_t result(res);
+    return _reader->start(file_path, [result]()
+    {
+        GetCB_Manager().ready_callback(result);
+    });
 }
 
-void EOSSDK_PlayerDataStorageFileTransferRequest::set_write_transfert(const EOS_PlayerDataStorage_WriteFileOptions* WriteOptions)
+bool EOSSDK_PlayerDataStorageFileTransferRequest::set_write_transfert(const EOS_PlayerDataStorage_WriteFileOptions* WriteOptions, pFrameResult_t const& res)
 {
     std::lock_guard<std::mutex> _lk(_local_mutex);
+    std::string file_path = FileManager::join(EOSSDK_PlayerDataStorage::remote_directory, FileManager::clean_path(WriteOptions->Filename));
+
+    char temp_name[17] = {};
+    random_string("0123456789abcdef", temp_name, 16);
+    std::string temp_path = FileManager::join(EOSSDK_PlayerDataStorage::temp_directory, std::string(temp_name) + ".tmp");
 
     _write_callback = WriteOptions->WriteFileDataCallback;
     _progress_callback = WriteOptions->FileTransferProgressCallback;
     _chunk_size = WriteOptions->ChunkLengthBytes;
     _file_name = WriteOptions->Filename;
+    _result = res;
+
+    // The chunks are written and hashed on the io_pool, the result is run again when a buffer is free or the file is written
+    _writer = std::make_shared<chunk_writer>(GetIO_Pool(), &GetMapped_Files(), static_cast<size_t>(_chunk_size) * 2);
+    pFrameResult_t result(res);
+    return _writer->start(file_path, temp_path, [result]()
+    {
+        GetCB_Manager().ready_callback(result);
+    });
 }
 
 bool EOSSDK_PlayerDataStorageFileTransferRequest::canceled()
@@ -125,12 +149,22 @@ EOS_EResult EOSSDK_PlayerDataStorageFileTransferRequest::GetFilename(uint32_t Fi
 EOS_EResult EOSSDK_PlayerDataStorageFileTransferRequest::CancelRequest()
 {
     TRACE_FUNC();
-    std::lock_guard<std::mutex> _lk(_local_mutex);
 
-    if (_done)
-        return EOS_EResult::EOS_NoChange;
+    pFrameResult_t result;
+    {
+        std::lock_guard<std::mutex> _lk(_local_mutex);
+
+        if (_done)
+            return EOS_EResult::EOS_NoChange;
+
+        _canceled = true;
+        result = _result;
+    }
+
+    // The request might be waiting for its next chunk
+    if (result != nullptr)
+        GetCB_Manager().ready_callback(result);
 
-    _canceled = true;
     return EOS_EResult::EOS_Success;
 }
 
@@ -77,13 +77,11 @@ Presence_Info_pb* EOSSDK_Presence::get_presence(EOS_EpicAccountId userid)
 
 void EOSSDK_Presence::trigger_presence_change(EOS_EpicAccountId userid)
 {
-    auto notifs = std::move(GetCB_Manager().get_notifications(this, EOS_Presence_PresenceChangedCallbackInfo::k_iCallback));
-    for (auto& notif : notifs)
+    GetCB_Manager().post_notifications(this, EOS_Presence_PresenceChangedCallbackInfo::k_iCallback, [userid](FrameResult& notif)
     {
-        auto& pcci = notif->GetCallback<EOS_Presence_PresenceChangedCallbackInfo>();
+        auto& pcci = notif.GetCallback<EOS_Presence_PresenceChangedCallbackInfo>();
         pcci.PresenceUserId = userid;
-        notif->GetFunc()(notif->GetFuncParam());
-    }
+    });
 }
 
 void EOSSDK_Presence::set_user_status(EOS_EpicAccountId userid, EOS_Presence_EStatus status)
@@ -117,7 +115,7 @@ void EOSSDK_Presence::set_user_status(EOS_EpicAccountId userid, EOS_Presence_ESt
 void EOSSDK_Presence::QueryPresence( const EOS_Presence_QueryPresenceOptions* Options, void* ClientData, const EOS_Presence_OnQueryPresenceCompleteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -145,9 +143,11 @@ void EOSSDK_Presence::QueryPresence( const EOS_Presence_QueryPresenceOptions* Op
     }
     else
     {
+        SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
         auto user = GetEOS_Connect().get_user_by_userid(Options->TargetUserId);
         if (user != GetEOS_Connect().get_end_users())
         {
+            res->SetTimeout(presence_query_timeout);
             _presence_queries[Options->TargetUserId].emplace_back(res);
             Presence_Info_Request_pb* req = new Presence_Info_Request_pb;
             send_presence_info_request(user->first->to_string(), req);
@@ -171,7 +171,7 @@ void EOSSDK_Presence::QueryPresence( const EOS_Presence_QueryPresenceOptions* Op
 EOS_Bool EOSSDK_Presence::HasPresence( const EOS_Presence_HasPresenceOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     if (Options == nullptr || Options->TargetUserId == nullptr || Options->LocalUserId != Settings::Inst().userid)
         return EOS_FALSE;
@@ -192,7 +192,7 @@ EOS_EResult EOSSDK_Presence::CopyPresence( const EOS_Presence_CopyPresenceOption
 {
      // TODO: Check the return codes from the real sdk
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || OutPresence == nullptr)
     {
@@ -288,7 +288,7 @@ EOS_EResult EOSSDK_Presence::CreatePresenceModification( const EOS_Presence_Crea
 {
     // TODO: Check the return codes from the real sdk
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || OutPresenceModificationHandle == nullptr)
     {
@@ -321,7 +321,7 @@ EOS_EResult EOSSDK_Presence::CreatePresenceModification( const EOS_Presence_Crea
 void EOSSDK_Presence::SetPresence( const EOS_Presence_SetPresenceOptions* Options, void* ClientData, const EOS_Presence_SetPresenceCompleteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -367,7 +367,7 @@ void EOSSDK_Presence::SetPresence( const EOS_Presence_SetPresenceOptions* Option
 EOS_NotificationId EOSSDK_Presence::AddNotifyOnPresenceChanged( const EOS_Presence_AddNotifyOnPresenceChangedOptions* Options, void* ClientData, const EOS_Presence_OnPresenceChangedCallback NotificationHandler)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (NotificationHandler == nullptr)
         return EOS_INVALID_NOTIFICATIONID;
@@ -389,7 +389,7 @@ EOS_NotificationId EOSSDK_Presence::AddNotifyOnPresenceChanged( const EOS_Presen
 void EOSSDK_Presence::RemoveNotifyOnPresenceChanged( EOS_NotificationId NotificationId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
    
     GetCB_Manager().remove_notification(this, NotificationId);
@@ -408,7 +408,7 @@ void EOSSDK_Presence::RemoveNotifyOnPresenceChanged( EOS_NotificationId Notifica
 EOS_NotificationId EOSSDK_Presence::AddNotifyJoinGameAccepted( const EOS_Presence_AddNotifyJoinGameAcceptedOptions* Options, void* ClientData, const EOS_Presence_OnJoinGameAcceptedCallback NotificationFn)
 {
      TRACE_FUNC();
-     GLOBAL_LOCK();
+     LOCAL_LOCK();
 
      if (NotificationFn == nullptr)
          return EOS_INVALID_NOTIFICATIONID;
@@ -431,7 +431,7 @@ EOS_NotificationId EOSSDK_Presence::AddNotifyJoinGameAccepted( const EOS_Presenc
 void EOSSDK_Presence::RemoveNotifyJoinGameAccepted( EOS_NotificationId InId)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     GetCB_Manager().remove_notification(this, InId);
 }
@@ -460,7 +460,7 @@ EOS_EResult EOSSDK_Presence::GetJoinInfo( const EOS_Presence_GetJoinInfoOptions*
 {
     // TODO: Check the return codes from the real sdk
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options->TargetUserId == nullptr || InOutBufferLength == nullptr || OutBuffer == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
@@ -543,6 +543,7 @@ bool EOSSDK_Presence::send_my_presence_info_to_all_peers()
     msg.set_source_id(user_id);
     msg.set_game_id(Settings::Inst().appid);
 
+    SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
     auto& users = GetEOS_Connect()._users;
     for (auto user_it = ++users.begin(); user_it != users.end(); ++user_it)
     {
@@ -563,9 +564,10 @@ bool EOSSDK_Presence::send_my_presence_info_to_all_peers()
 bool EOSSDK_Presence::on_peer_connect(Network_Message_pb const& msg, Network_Peer_Connect_pb const& peer)
 {
     //TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     EOS_ProductUserId product_id = GetProductUserId(msg.source_id());
+    SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
     auto pUser = GetEOS_Connect().get_user_by_productid(product_id);
     if (pUser != GetEOS_Connect().get_end_users() && pUser->second.authentified)
     {
@@ -584,17 +586,20 @@ bool EOSSDK_Presence::on_peer_connect(Network_Message_pb const& msg, Network_Pee
 bool EOSSDK_Presence::on_peer_disconnect(Network_Message_pb const& msg, Network_Peer_Disconnect_pb const& peer)
 {
     //TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     EOS_ProductUserId product_id = GetProductUserId(msg.source_id());
-    auto pUser = GetEOS_Connect().get_user_by_productid(product_id);
-    if (pUser != GetEOS_Connect().get_end_users() && pUser->second.authentified)
-    {
-        EOS_EpicAccountId account_id = GetEpicUserId(pUser->second.infos.userid());
-        if (account_id->IsValid())
-            set_user_status(account_id, EOS_Presence_EStatus::EOS_PS_Offline);
+    EOS_EpicAccountId account_id = nullptr;
+    {// set_user_status notifies the game, don't hold users_mutex meanwhile
+        SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
+        auto pUser = GetEOS_Connect().get_user_by_productid(product_id);
+        if (pUser != GetEOS_Connect().get_end_users() && pUser->second.authentified)
+            account_id = GetEpicUserId(pUser->second.infos.userid());
     }
 
+    if (account_id != nullptr && account_id->IsValid())
+        set_user_status(account_id, EOS_Presence_EStatus::EOS_PS_Offline);
+
     return true;
 }
 
@@ -602,7 +607,7 @@ bool EOSSDK_Presence::on_peer_disconnect(Network_Message_pb const& msg, Network_
 bool EOSSDK_Presence::on_presence_request(Network_Message_pb const& msg, Presence_Info_Request_pb const& req)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return send_my_presence_info(msg.source_id());
 }
@@ -614,7 +619,7 @@ bool EOSSDK_Presence::on_presence_infos(Network_Message_pb const& msg, Presence_
         return true;
 
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (!msg.source_id().empty())
     {
@@ -660,6 +665,7 @@ bool EOSSDK_Presence::on_presence_infos(Network_Message_pb const& msg, Presence_
 
             (*presence_query_it)->done = true;
             (*presence_query_it)->GetCallback<EOS_Presence_QueryPresenceCallbackInfo>().ResultCode = EOS_EResult::EOS_Success;
+            GetCB_Manager().ready_callback(*presence_query_it);
 
             it->second.erase(presence_query_it);
         }
@@ -679,7 +685,7 @@ bool EOSSDK_Presence::on_presence_infos(Network_Message_pb const& msg, Presence_
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_Presence::CBRunFrame()
 {
-    //GLOBAL_LOCK();
+    //LOCAL_LOCK();
     return true;
 }
 
@@ -700,7 +706,7 @@ bool EOSSDK_Presence::RunNetwork(Network_Message_pb const& msg)
 
 bool EOSSDK_Presence::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
@@ -727,7 +733,7 @@ bool EOSSDK_Presence::RunCallbacks(pFrameResult_t res)
 
 void EOSSDK_Presence::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     //switch (res->res.m_iCallback)
     {
@@ -47,6 +47,8 @@ namespace sdk
         public IRunCallback,
         public IRunNetwork
     {
+        std::recursive_mutex local_mutex;
+
         static constexpr auto presence_query_timeout = std::chrono::milliseconds(1000);
 
         nlohmann::fifo_map<EOS_EpicAccountId, Presence_Info_pb> _presences;
@@ -292,7 +292,7 @@ bool EOSSDK_Sessions::is_player_registered(std::string const& player, session_st
 EOS_EResult EOSSDK_Sessions::CreateSessionModification(const EOS_Sessions_CreateSessionModificationOptions* Options, EOS_HSessionModification* OutSessionModificationHandle)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->SessionName == nullptr || Options->BucketId == nullptr || OutSessionModificationHandle == nullptr)
     {
@@ -367,7 +367,7 @@ EOS_EResult EOSSDK_Sessions::CreateSessionModification(const EOS_Sessions_Create
 EOS_EResult EOSSDK_Sessions::UpdateSessionModification(const EOS_Sessions_UpdateSessionModificationOptions* Options, EOS_HSessionModification* OutSessionModificationHandle)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->SessionName == nullptr || OutSessionModificationHandle == nullptr)
     {
@@ -422,7 +422,7 @@ EOS_EResult EOSSDK_Sessions::UpdateSessionModification(const EOS_Sessions_Update
 void EOSSDK_Sessions::UpdateSession(const EOS_Sessions_UpdateSessionOptions* Options, void* ClientData, const EOS_Sessions_OnUpdateSessionCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -563,7 +563,7 @@ void EOSSDK_Sessions::UpdateSession(const EOS_Sessions_UpdateSessionOptions* Opt
 void EOSSDK_Sessions::DestroySession(const EOS_Sessions_DestroySessionOptions* Options, void* ClientData, const EOS_Sessions_OnDestroySessionCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -628,7 +628,7 @@ void EOSSDK_Sessions::DestroySession(const EOS_Sessions_DestroySessionOptions* O
 void EOSSDK_Sessions::JoinSession(const EOS_Sessions_JoinSessionOptions* Options, void* ClientData, const EOS_Sessions_OnJoinSessionCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -670,6 +670,7 @@ void EOSSDK_Sessions::JoinSession(const EOS_Sessions_JoinSessionOptions* Options
                     session.state = session_state_t::state_e::joining;
                     session.infos = details->_infos;
                     _sessions_join[details->_infos.session_id()] = res;
+                    res->SetTimeout(join_timeout);
 
                     jsci.ResultCode = EOS_EResult::EOS_UnexpectedError;
                     send_session_join_request(&session);
@@ -710,7 +711,7 @@ void EOSSDK_Sessions::JoinSession(const EOS_Sessions_JoinSessionOptions* Options
 void EOSSDK_Sessions::StartSession(const EOS_Sessions_StartSessionOptions* Options, void* ClientData, const EOS_Sessions_OnStartSessionCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -775,7 +776,7 @@ void EOSSDK_Sessions::StartSession(const EOS_Sessions_StartSessionOptions* Optio
 void EOSSDK_Sessions::EndSession(const EOS_Sessions_EndSessionOptions* Options, void* ClientData, const EOS_Sessions_OnEndSessionCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -823,7 +824,7 @@ void EOSSDK_Sessions::EndSession(const EOS_Sessions_EndSessionOptions* Options,
 void EOSSDK_Sessions::RegisterPlayers(const EOS_Sessions_RegisterPlayersOptions* Options, void* ClientData, const EOS_Sessions_OnRegisterPlayersCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -901,7 +902,7 @@ void EOSSDK_Sessions::RegisterPlayers(const EOS_Sessions_RegisterPlayersOptions*
 void EOSSDK_Sessions::UnregisterPlayers(const EOS_Sessions_UnregisterPlayersOptions* Options, void* ClientData, const EOS_Sessions_OnUnregisterPlayersCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -977,7 +978,7 @@ void EOSSDK_Sessions::UnregisterPlayers(const EOS_Sessions_UnregisterPlayersOpti
 void EOSSDK_Sessions::SendInvite(const EOS_Sessions_SendInviteOptions* Options, void* ClientData, const EOS_Sessions_OnSendInviteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -995,6 +996,7 @@ void EOSSDK_Sessions::SendInvite(const EOS_Sessions_SendInviteOptions* Options,
     else
     {
         session_state_t* session = get_session_by_name(Options->SessionName);
+        SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
         if (session == nullptr || GetEOS_Connect().get_user_by_productid(Options->TargetUserId) == GetEOS_Connect().get_end_users())
         {
             sici.ResultCode = EOS_EResult::EOS_NotFound;
@@ -1026,7 +1028,7 @@ void EOSSDK_Sessions::SendInvite(const EOS_Sessions_SendInviteOptions* Options,
 void EOSSDK_Sessions::RejectInvite(const EOS_Sessions_RejectInviteOptions* Options, void* ClientData, const EOS_Sessions_OnRejectInviteCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -1066,7 +1068,7 @@ void EOSSDK_Sessions::RejectInvite(const EOS_Sessions_RejectInviteOptions* Optio
 void EOSSDK_Sessions::QueryInvites(const EOS_Sessions_QueryInvitesOptions* Options, void* ClientData, const EOS_Sessions_OnQueryInvitesCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -1100,7 +1102,7 @@ void EOSSDK_Sessions::QueryInvites(const EOS_Sessions_QueryInvitesOptions* Optio
 uint32_t EOSSDK_Sessions::GetInviteCount(const EOS_Sessions_GetInviteCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->LocalUserId != GetEOS_Connect().get_myself()->first)
         return 0;
@@ -1123,7 +1125,7 @@ uint32_t EOSSDK_Sessions::GetInviteCount(const EOS_Sessions_GetInviteCountOption
 EOS_EResult EOSSDK_Sessions::GetInviteIdByIndex(const EOS_Sessions_GetInviteIdByIndexOptions* Options, char* OutBuffer, int32_t* InOutBufferLength)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->LocalUserId != GetEOS_Connect().get_myself()->first ||
         Options->Index >= _session_invites.size() ||
@@ -1187,7 +1189,7 @@ EOS_EResult EOSSDK_Sessions::CreateSessionSearch(const EOS_Sessions_CreateSessio
 EOS_EResult EOSSDK_Sessions::CopyActiveSessionHandle(const EOS_Sessions_CopyActiveSessionHandleOptions* Options, EOS_HActiveSession* OutSessionHandle)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->SessionName == nullptr || OutSessionHandle == nullptr)
     {
@@ -1351,7 +1353,7 @@ void EOSSDK_Sessions::RemoveNotifyJoinSessionAccepted(EOS_NotificationId InId)
 EOS_EResult EOSSDK_Sessions::CopySessionHandleByInviteId(const EOS_Sessions_CopySessionHandleByInviteIdOptions* Options, EOS_HSessionDetails* OutSessionHandle)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     if (Options == nullptr || Options->InviteId == nullptr || OutSessionHandle == nullptr)
     {
@@ -1396,7 +1398,7 @@ EOS_EResult EOSSDK_Sessions::CopySessionHandleByInviteId(const EOS_Sessions_Copy
 EOS_EResult EOSSDK_Sessions::CopySessionHandleByUiEventId(const EOS_Sessions_CopySessionHandleByUiEventIdOptions* Options, EOS_HSessionDetails* OutSessionHandle)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
     
     if (Options == nullptr || Options->UiEventId == EOS_UI_EVENTID_INVALID || OutSessionHandle == nullptr)
     {
@@ -1426,7 +1428,7 @@ EOS_EResult EOSSDK_Sessions::CopySessionHandleByUiEventId(const EOS_Sessions_Cop
 EOS_EResult EOSSDK_Sessions::CopySessionHandleForPresence(const EOS_Sessions_CopySessionHandleForPresenceOptions* Options, EOS_HSessionDetails* OutSessionHandle)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || OutSessionHandle == nullptr)
     {
@@ -1467,7 +1469,7 @@ EOS_EResult EOSSDK_Sessions::CopySessionHandleForPresence(const EOS_Sessions_Cop
 EOS_EResult EOSSDK_Sessions::IsUserInSession(const EOS_Sessions_IsUserInSessionOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->TargetUserId == nullptr || Options->SessionName == nullptr)
         return EOS_EResult::EOS_InvalidParameters;
@@ -1492,6 +1494,7 @@ EOS_EResult EOSSDK_Sessions::IsUserInSession(const EOS_Sessions_IsUserInSessionO
     }
     else
     {
+        SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
         auto user_infos = GetEOS_Connect().get_user_by_productid(Options->TargetUserId);
         if (user_infos != GetEOS_Connect().get_end_users())
         {
@@ -1521,7 +1524,7 @@ EOS_EResult EOSSDK_Sessions::IsUserInSession(const EOS_Sessions_IsUserInSessionO
 EOS_EResult EOSSDK_Sessions::DumpSessionState(const EOS_Sessions_DumpSessionStateOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return EOS_EResult::EOS_Success;
 }
@@ -1743,7 +1746,7 @@ bool EOSSDK_Sessions::send_session_unregister(Session_Unregister_pb* unregister,
 bool EOSSDK_Sessions::on_peer_disconnect(Network_Message_pb const& msg, Network_Peer_Disconnect_pb const& peer)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     for (auto& session : _sessions)
     {
@@ -1756,7 +1759,7 @@ bool EOSSDK_Sessions::on_peer_disconnect(Network_Message_pb const& msg, Network_
 bool EOSSDK_Sessions::on_session_info_request(Network_Message_pb const& msg, Session_Infos_Request_pb const& req)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     session_state_t* session = get_session_by_id(req.session_id());
     Session_Infos_pb* infos;
@@ -1785,7 +1788,7 @@ bool EOSSDK_Sessions::on_session_info_request(Network_Message_pb const& msg, Ses
 bool EOSSDK_Sessions::on_session_info(Network_Message_pb const& msg, Session_Infos_pb const& infos)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     session_state_t *session = get_session_by_id(infos.session_id());
     if (session != nullptr)
@@ -1797,7 +1800,7 @@ bool EOSSDK_Sessions::on_session_info(Network_Message_pb const& msg, Session_Inf
 bool EOSSDK_Sessions::on_session_destroy(Network_Message_pb const& msg, Session_Destroy_pb const& destr)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     session_state_t* session = get_session_by_id(destr.session_id());
     if (session != nullptr)
@@ -1809,7 +1812,7 @@ bool EOSSDK_Sessions::on_session_destroy(Network_Message_pb const& msg, Session_
 bool EOSSDK_Sessions::on_sessions_search(Network_Message_pb const& msg, Sessions_Search_pb const& search)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     Sessions_Search_response_pb* resp = new Sessions_Search_response_pb;
     resp->set_search_id(search.search_id());
@@ -1849,7 +1852,7 @@ bool EOSSDK_Sessions::on_sessions_search(Network_Message_pb const& msg, Sessions
 bool EOSSDK_Sessions::on_session_join_request(Network_Message_pb const& msg, Session_Join_Request_pb const& req)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     session_state_t* pSession = get_session_by_id(req.session_id());
     if (!is_player_registered(Settings::Inst().productuserid->to_string(), pSession))
@@ -1863,6 +1866,7 @@ bool EOSSDK_Sessions::on_session_join_request(Network_Message_pb const& msg, Ses
     resp->set_user_id(msg.source_id());
 
     // If we know the user
+    SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
     if (GetEOS_Connect().get_user_by_productid(GetProductUserId(msg.source_id())) != GetEOS_Connect().get_end_users())
     {
         if (pSession->infos.max_players() - pSession->infos.players_size())
@@ -1889,7 +1893,7 @@ bool EOSSDK_Sessions::on_session_join_request(Network_Message_pb const& msg, Ses
 bool EOSSDK_Sessions::on_session_join_response(Network_Message_pb const& msg, Session_Join_Response_pb const& resp)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     std::string const& user_id = Settings::Inst().productuserid->to_string();
     auto session_it = std::find_if(_sessions.begin(), _sessions.end(), [&resp]( std::pair<const std::string, session_state_t>& item)
@@ -1918,6 +1922,7 @@ bool EOSSDK_Sessions::on_session_join_response(Network_Message_pb const& msg, Se
                 {
                     APP_LOG(Log::LogLevel::DEBUG, "(%s) Join rejected: This session is full.", msg.source_id().c_str());
                     it->second->done = true;
+                    GetCB_Manager().ready_callback(it->second);
                     _sessions_join.erase(it);
                     _sessions.erase(session_it);
                 }
@@ -1927,6 +1932,7 @@ bool EOSSDK_Sessions::on_session_join_response(Network_Message_pb const& msg, Se
                 {
                     APP_LOG(Log::LogLevel::DEBUG, "(%s) Join accepted.", msg.source_id().c_str());
                     it->second->done = true;
+                    GetCB_Manager().ready_callback(it->second);
                     _sessions_join.erase(it);
                     // Add myself to the session
                     //GetEOS_Connect().add_session(GetProductUserId(session_it->second.infos.session_id()), session_it->second.infos.session_name());
@@ -1957,7 +1963,7 @@ bool EOSSDK_Sessions::on_session_join_response(Network_Message_pb const& msg, Se
 bool EOSSDK_Sessions::on_session_invite(Network_Message_pb const& msg, Session_Invite_pb const& invite)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     EOS_ProductUserId target_id = GetProductUserId(msg.source_id());
     
@@ -1967,17 +1973,14 @@ bool EOSSDK_Sessions::on_session_invite(Network_Message_pb const& msg, Session_I
     invite_infos.peer_id = target_id;
 
     _session_invites.emplace_back(std::move(invite_infos));
-    std::string const& invite_id = _session_invites.back().invite_id;
+    std::string invite_id = _session_invites.back().invite_id;
 
-    std::vector<pFrameResult_t> notifs = std::move(GetCB_Manager().get_notifications(this, EOS_Sessions_SessionInviteReceivedCallbackInfo::k_iCallback));
-    for (auto& notif : notifs)
+    GetCB_Manager().post_notifications(this, EOS_Sessions_SessionInviteReceivedCallbackInfo::k_iCallback, [invite_id, target_id](FrameResult& notif)
     {
-        EOS_Sessions_SessionInviteReceivedCallbackInfo& sirci = notif->GetCallback<EOS_Sessions_SessionInviteReceivedCallbackInfo>();
+        EOS_Sessions_SessionInviteReceivedCallbackInfo& sirci = notif.GetCallback<EOS_Sessions_SessionInviteReceivedCallbackInfo>();
         strncpy(const_cast<char*>(sirci.InviteId), invite_id.c_str(), max_accountid_length);
         sirci.TargetUserId = target_id;
-
-        notif->GetFunc()(notif->GetFuncParam());
-    }
+    });
 
     return true;
 }
@@ -1985,18 +1988,17 @@ bool EOSSDK_Sessions::on_session_invite(Network_Message_pb const& msg, Session_I
 bool EOSSDK_Sessions::on_session_invite_response(Network_Message_pb const& msg, Session_Invite_Response_pb const& resp)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
-    std::vector<pFrameResult_t> notifs = std::move(GetCB_Manager().get_notifications(this, EOS_Sessions_SessionInviteAcceptedCallbackInfo::k_iCallback));
-    for (auto& notif : notifs)
+    EOS_ProductUserId target_id = GetProductUserId(msg.source_id());
+    std::string session_id = resp.session_id();
+    GetCB_Manager().post_notifications(this, EOS_Sessions_SessionInviteAcceptedCallbackInfo::k_iCallback, [target_id, session_id](FrameResult& notif)
     {
-        EOS_Sessions_SessionInviteAcceptedCallbackInfo& siacbi = notif->GetCallback<EOS_Sessions_SessionInviteAcceptedCallbackInfo>();
-
-        siacbi.TargetUserId = GetProductUserId(msg.source_id());
-        strncpy(const_cast<char*>(siacbi.SessionId), resp.session_id().c_str(), max_accountid_length);
+        EOS_Sessions_SessionInviteAcceptedCallbackInfo& siacbi = notif.GetCallback<EOS_Sessions_SessionInviteAcceptedCallbackInfo>();
 
-        notif->GetFunc()(notif->GetFuncParam());
-    }
+        siacbi.TargetUserId = target_id;
+        strncpy(const_cast<char*>(siacbi.SessionId), session_id.c_str(), max_accountid_length);
+    });
 
     return true;
 }
@@ -2004,7 +2006,7 @@ bool EOSSDK_Sessions::on_session_invite_response(Network_Message_pb const& msg,
 bool EOSSDK_Sessions::on_session_register(Network_Message_pb const& msg, Session_Register_pb const& register_)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     session_state_t* pSession = get_session_by_id(register_.session_id());
 
@@ -2022,7 +2024,7 @@ bool EOSSDK_Sessions::on_session_register(Network_Message_pb const& msg, Session
 bool EOSSDK_Sessions::on_session_unregister(Network_Message_pb const& msg, Session_Unregister_pb const& unregister)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     session_state_t* pSession = get_session_by_id(unregister.session_id());
 
@@ -2042,21 +2044,28 @@ bool EOSSDK_Sessions::on_session_unregister(Network_Message_pb const& msg, Sessi
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_Sessions::CBRunFrame()
 {
-    GLOBAL_LOCK();
-
-    for (auto it = _session_searchs.begin(); it != _session_searchs.end();)
+    // The searches unregister their network listeners when deleted, that can't be done holding our lock
+    std::vector<EOSSDK_SessionSearch*> released_searchs;
     {
-        if ((*it)->released())
-        {
-            delete* it;
-            it = _session_searchs.erase(it);
-        }
-        else
+        LOCAL_LOCK();
+
+        for (auto it = _session_searchs.begin(); it != _session_searchs.end();)
         {
-            ++it;
+            if ((*it)->released())
+            {
+                released_searchs.emplace_back(*it);
+                it = _session_searchs.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
         }
     }
 
+    for (auto search : released_searchs)
+        delete search;
+
     return true;
 }
 
@@ -2104,7 +2113,7 @@ bool EOSSDK_Sessions::RunNetwork(Network_Message_pb const& msg)
 
 bool EOSSDK_Sessions::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
@@ -2148,7 +2157,7 @@ bool EOSSDK_Sessions::RunCallbacks(pFrameResult_t res)
 
 void EOSSDK_Sessions::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
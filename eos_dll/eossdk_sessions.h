@@ -156,6 +156,8 @@ namespace sdk
         public IRunCallback,
         public IRunNetwork
     {
+        std::recursive_mutex local_mutex;
+
 
         static constexpr auto join_timeout = std::chrono::milliseconds(5000);
         // key: session_id
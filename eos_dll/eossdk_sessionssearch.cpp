@@ -228,6 +228,7 @@ void EOSSDK_SessionSearch::Find(const EOS_SessionSearch_FindOptions* Options, vo
     else
     {
         _search_cb = res;
+        _search_cb->SetTimeout(search_timeout);
         _search_infos.set_search_id(search_id++);
         send_sessions_search(&_search_infos);
     }
@@ -349,6 +350,10 @@ bool EOSSDK_SessionSearch::on_sessions_search_response(Network_Message_pb const&
     if (_search_cb.get() != nullptr && resp.search_id() == _search_infos.search_id())
     {
         _search_peers.erase(msg.source_id());
+        if (_search_peers.empty())
+        {// Everybody answered, don't wait for the timeout
+            GetCB_Manager().ready_callback(_search_cb);
+        }
         if (_results.size() >= _search_infos.max_results())
             return true;
 
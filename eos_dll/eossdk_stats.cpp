@@ -271,14 +271,14 @@ bool EOSSDK_Stats::CBRunFrame()
 
 bool EOSSDK_Stats::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;
 }
 
 void EOSSDK_Stats::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     //switch (res->res.m_iCallback)
     {
@@ -27,6 +27,8 @@ namespace sdk
     class EOSSDK_Stats :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
         static const std::string stats_filename;
 
         nlohmann::json _stats;
@@ -21,6 +21,7 @@
 #include "eossdk_platform.h"
 #include "eos_client_api.h"
 #include "settings.h"
+#include "md5_multi.h"
 
 namespace sdk
 {
@@ -44,19 +45,18 @@ EOSSDK_TitleStorage::~EOSSDK_TitleStorage()
 bool EOSSDK_TitleStorage::get_metadata(std::string const& filename)
 {
     std::string file_path(FileManager::join(title_directory, FileManager::clean_path(filename)));
-    std::ifstream in_file = FileManager::open_read(file_path, std::ios::binary);
-    if (in_file)
+    std::string md5sum(md5_multi::hash_file(file_path));
+    return set_metadata(filename, std::move(file_path), std::move(md5sum));
+}
+
+bool EOSSDK_TitleStorage::set_metadata(std::string const& filename, std::string file_path, std::string md5sum)
+{
+    FileManager::file_info_t file_info;
+    if (!md5sum.empty() && FileManager::file_info(file_path, file_info))
     {
         auto& metadata = _files_cache[filename];
-        in_file.seekg(0, std::ios::end);
-        metadata.file_size = in_file.tellg();
-        in_file.seekg(0, std::ios::beg);
-
-        std::string buffer(metadata.file_size, '\0');
-        in_file.read(&buffer[0], metadata.file_size);
-
-        metadata.md5sum = std::move(md5(buffer));
-
+        metadata.file_size = file_info.size;
+        metadata.md5sum = std::move(md5sum);
         metadata.file_path = std::move(file_path);
 
         return true;
@@ -90,7 +90,7 @@ bool EOSSDK_TitleStorage::get_metadata(std::string const& filename)
 void EOSSDK_TitleStorage::QueryFile(const EOS_TitleStorage_QueryFileOptions* Options, void* ClientData, const EOS_TitleStorage_OnQueryFileCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return;
@@ -139,7 +139,7 @@ void EOSSDK_TitleStorage::QueryFile(const EOS_TitleStorage_QueryFileOptions* Opt
 void EOSSDK_TitleStorage::QueryFileList(const EOS_TitleStorage_QueryFileListOptions* Options, void* ClientData, const EOS_TitleStorage_OnQueryFileListCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return;
@@ -159,11 +159,20 @@ void EOSSDK_TitleStorage::QueryFileList(const EOS_TitleStorage_QueryFileListOpti
     {
         std::vector<std::string> files(std::move(FileManager::list_files(title_directory, true)));
 
-        _files_cache.clear();
+        std::vector<std::string> file_paths;
+        file_paths.reserve(files.size());
         for (auto& file_name : files)
         {
             std::replace(file_name.begin(), file_name.end(), '\\', '/');
-            get_metadata(file_name);
+            file_paths.emplace_back(FileManager::join(title_directory, FileManager::clean_path(file_name)));
+        }
+        // Hash the files together, up to 8 at once with AVX2
+        std::vector<std::string> md5sums(md5_multi::hash_files(file_paths));
+
+        _files_cache.clear();
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            set_metadata(files[i], std::move(file_paths[i]), std::move(md5sums[i]));
         }
 
         qflci.FileCount = _files_cache.size();
@@ -185,7 +194,7 @@ void EOSSDK_TitleStorage::QueryFileList(const EOS_TitleStorage_QueryFileListOpti
 EOS_EResult EOSSDK_TitleStorage::CopyFileMetadataByFilename(const EOS_TitleStorage_CopyFileMetadataByFilenameOptions* Options, EOS_TitleStorage_FileMetadata** OutMetadata)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->Filename == nullptr || OutMetadata == nullptr)
     {
@@ -235,7 +244,7 @@ EOS_EResult EOSSDK_TitleStorage::CopyFileMetadataByFilename(const EOS_TitleStora
 uint32_t EOSSDK_TitleStorage::GetFileMetadataCount(const EOS_TitleStorage_GetFileMetadataCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr)
     {
@@ -258,7 +267,7 @@ uint32_t EOSSDK_TitleStorage::GetFileMetadataCount(const EOS_TitleStorage_GetFil
 EOS_EResult EOSSDK_TitleStorage::CopyFileMetadataAtIndex(const EOS_TitleStorage_CopyFileMetadataAtIndexOptions* Options, EOS_TitleStorage_FileMetadata** OutMetadata)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (Options == nullptr || Options->Index >= _files_cache.size() || OutMetadata == nullptr)
     {
@@ -306,7 +315,7 @@ EOS_EResult EOSSDK_TitleStorage::CopyFileMetadataAtIndex(const EOS_TitleStorage_
 EOS_HTitleStorageFileTransferRequest EOSSDK_TitleStorage::ReadFile(const EOS_TitleStorage_ReadFileOptions* Options, void* ClientData, const EOS_TitleStorage_OnReadFileCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback == nullptr)
         return nullptr;
@@ -332,7 +341,7 @@ EOS_HTitleStorageFileTransferRequest EOSSDK_TitleStorage::ReadFile(const EOS_Tit
         rfci.Filename = str;
     }
 
-    if (Options == nullptr || Options->Filename == nullptr || Options->ReadFileDataCallback == nullptr)
+    if (Options == nullptr || Options->Filename == nullptr || Options->ReadFileDataCallback == nullptr || Options->ReadChunkLengthBytes == 0)
     {
         rfci.ResultCode = EOS_EResult::EOS_InvalidParameters;
         res->done = true;
@@ -351,7 +360,12 @@ EOS_HTitleStorageFileTransferRequest EOSSDK_TitleStorage::ReadFile(const EOS_Tit
 
             EOSSDK_TitleStorageFileTransferRequest*& res_obj = _transferts[res];
             res_obj = new EOSSDK_TitleStorageFileTransferRequest;
-            res_obj->set_read_transfert(Options);
+            // The chunks are mapped or prefetched on the io_pool and sent to the game from RunCallbacks,
+            // the reader wakes the result up when a chunk is ready
+            if (!res_obj->set_read_transfert(Options, res))
+            {
+                APP_LOG(Log::LogLevel::WARN, "Failed to open file: %s", file_path.c_str());
+            }
 
             func_result = reinterpret_cast<EOS_HTitleStorageFileTransferRequest>(res_obj);
         }
@@ -380,7 +394,7 @@ EOS_HTitleStorageFileTransferRequest EOSSDK_TitleStorage::ReadFile(const EOS_Tit
 EOS_EResult EOSSDK_TitleStorage::DeleteCache(const EOS_TitleStorage_DeleteCacheOptions* Options, void* ClientData, const EOS_TitleStorage_OnDeleteCacheCompleteCallback CompletionCallback)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionCallback != nullptr)
     {
@@ -403,11 +417,12 @@ EOS_EResult EOSSDK_TitleStorage::DeleteCache(const EOS_TitleStorage_DeleteCacheO
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_TitleStorage::CBRunFrame()
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     for (auto it = _transferts.begin(); it != _transferts.end();)
     {
-        if (it->second->released())
+        // Its result might still be running, it reads the transfer
+        if (it->second->released() && it->second->_done)
         {
             delete it->second;
             it = _transferts.erase(it);
@@ -423,7 +438,7 @@ bool EOSSDK_TitleStorage::CBRunFrame()
 
 bool EOSSDK_TitleStorage::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
@@ -440,50 +455,74 @@ bool EOSSDK_TitleStorage::RunCallbacks(pFrameResult_t res)
             }
             else
             {
-                EOS_TitleStorage_ReadFileDataCallbackInfo rfdci;
-                rfdci.ClientData = callback.ClientData;
-                rfdci.Filename = callback.Filename;
-                rfdci.LocalUserId = callback.LocalUserId;
-                rfdci.TotalFileSizeBytes = transfert._file_size;
-
-                transfert._input_file.read((char*)&transfert._file_buffer[0], transfert._chunk_size);
-                size_t read_len = transfert._input_file.gcount();
-
-                rfdci.bIsLastChunk = (read_len != transfert._chunk_size ? EOS_TRUE : EOS_FALSE);
-                if (rfdci.bIsLastChunk == EOS_TRUE)
-                {
-                    transfert._done = true;
-                    res->done = true;
-                    callback.ResultCode = EOS_EResult::EOS_Success;
-                }
-
-                rfdci.DataChunk = &transfert._file_buffer[0];
-                rfdci.DataChunkLengthBytes = read_len;
-                switch (transfert._read_callback(&rfdci))
+                // Hand out the chunks the reader already has, several of them if the tick budget allows it
+                do
                 {
-                    case EOS_TitleStorage_EReadResult::EOS_TS_RR_FailRequest:
+                    chunk_prefetcher::chunk_t* chunk = transfert._reader->front();
+                    if (chunk == nullptr)
                     {
-                        callback.ResultCode = EOS_EResult::EOS_PlayerDataStorage_UserErrorFromDataCallback;
-                        transfert._done = true;
-                        res->done = true;
+                        if (transfert._reader->failed())
+                        {
+                            callback.ResultCode = EOS_EResult::EOS_UnexpectedError;
+                            transfert._done = true;
+                            res->done = true;
+                        }
+                        // Otherwise the reader wakes us up when the next chunk is ready
+                        break;
                     }
-                    break;
 
-                    case EOS_TitleStorage_EReadResult::EOS_TS_RR_CancelRequest:
+                    EOS_TitleStorage_ReadFileDataCallbackInfo rfdci;
+                    rfdci.ClientData = callback.ClientData;
+                    rfdci.Filename = callback.Filename;
+                    rfdci.LocalUserId = callback.LocalUserId;
+                    rfdci.TotalFileSizeBytes = transfert._file_size;
+                    rfdci.bIsLastChunk = (chunk->last ? EOS_TRUE : EOS_FALSE);
+                    if (rfdci.bIsLastChunk == EOS_TRUE)
                     {
-                        callback.ResultCode = EOS_EResult::EOS_Canceled;
-                        transfert._canceled = true;
                         transfert._done = true;
                         res->done = true;
+                        callback.ResultCode = EOS_EResult::EOS_Success;
                     }
-                    break;
 
-                    case EOS_TitleStorage_EReadResult::EOS_TS_RR_ContinueReading:
+                    rfdci.DataChunk = chunk->data;
+                    rfdci.DataChunkLengthBytes = chunk->size;
+                    switch (transfert._read_callback(&rfdci))
                     {
+                        case EOS_TitleStorage_EReadResult::EOS_TS_RR_FailRequest:
+                        {
+                            callback.ResultCode = EOS_EResult::EOS_PlayerDataStorage_UserErrorFromDataCallback;
+                            transfert._done = true;
+                            res->done = true;
+                        }
+                        break;
+
+                        case EOS_TitleStorage_EReadResult::EOS_TS_RR_CancelRequest:
+                        {
+                            callback.ResultCode = EOS_EResult::EOS_Canceled;
+                            transfert._canceled = true;
+                            transfert._done = true;
+                            res->done = true;
+                        }
+                        break;
+
+                        case EOS_TitleStorage_EReadResult::EOS_TS_RR_ContinueReading:
+                        {
+                        }
+                        break;
                     }
-                    break;
-                }
+
+                    transfert._reader->pop();
+                    if (!res->done && GetCB_Manager().tick_budget_exhausted())
+                    {// Out of time, the chunks already there won't wake the result up: run it again on the next tick
+                        GetCB_Manager().ready_callback(res);
+                        break;
+                    }
+                } while (!res->done);
             }
+
+            // Stop the prefetching and give the buffers back
+            if (res->done)
+                transfert._reader->close();
         }
         break;
     }
@@ -493,7 +532,7 @@ bool EOSSDK_TitleStorage::RunCallbacks(pFrameResult_t res)
 
 void EOSSDK_TitleStorage::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     switch (res->ICallback())
     {
@@ -21,6 +21,7 @@
 
 #include "common_includes.h"
 #include "callback_manager.h"
+#include "chunk_prefetcher.h"
 
 namespace sdk
 {
@@ -41,10 +42,12 @@ namespace sdk
         uint32_t _chunk_size;
         uint32_t _file_size;
 
-        std::vector<uint8_t> _file_buffer;
-        std::ifstream _input_file;
+        // Woken up when a chunk is ready or the request is canceled
+        pFrameResult_t _result;
 
-        void set_read_transfert(const EOS_TitleStorage_ReadFileOptions* ReadOptions);
+        std::shared_ptr<chunk_prefetcher> _reader;
+
+        bool set_read_transfert(const EOS_TitleStorage_ReadFileOptions* ReadOptions, pFrameResult_t const& res);
 
     public:
         EOSSDK_TitleStorageFileTransferRequest();
@@ -62,6 +65,8 @@ namespace sdk
     class EOSSDK_TitleStorage :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
         struct file_metadata_t
         {
             std::string file_path;
@@ -73,6 +78,7 @@ namespace sdk
         nlohmann::fifo_map<std::string, file_metadata_t> _files_cache;
 
         bool get_metadata(std::string const& filename);
+        bool set_metadata(std::string const& filename, std::string file_path, std::string md5sum);
 
     public:
         EOSSDK_TitleStorage();
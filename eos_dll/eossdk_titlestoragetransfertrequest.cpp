@@ -35,22 +35,29 @@ EOSSDK_TitleStorageFileTransferRequest::EOSSDK_TitleStorageFileTransferRequest()
 
 EOSSDK_TitleStorageFileTransferRequest::~EOSSDK_TitleStorageFileTransferRequest()
 {
-
+    if (_reader != nullptr)
+        _reader->close();
 }
 
-void EOSSDK_TitleStorageFileTransferRequest::set_read_transfert(const EOS_TitleStorage_ReadFileOptions* ReadOptions)
+bool EOSSDK_TitleStorageFileTransferRequest::set_read_transfert(const EOS_TitleStorage_ReadFileOptions* ReadOptions, pFrameResult_t const& res)
 {
     std::lock_guard<std::mutex> _lk(_local_mutex);
-    std::string file_path = FileManager::join(EOSSDK_PlayerDataStorage::remote_directory, FileManager::clean_path(ReadOptions->Filename));
+    std::string file_path = FileManager::join(EOSSDK_TitleStorage::title_directory, FileManager::clean_path(ReadOptions->Filename));
 
     _read_callback = ReadOptions->ReadFileDataCallback;
     _progress_callback = ReadOptions->FileTransferProgressCallback;
     _chunk_size = ReadOptions->ReadChunkLengthBytes;
     _file_name = ReadOptions->Filename;
     _file_size = FileManager::file_size(file_path);
-
-    _file_buffer.resize(_chunk_size);
-    _input_file = FileManager::open_read(file_path, std::ios::binary);
+    _result = res;
+
+    // The chunks are read on the io_pool, the result is run again when one is ready
+    _reader = std::make_shared<chunk_prefetcher>(GetIO_Pool(), &GetMapped_Files(), _chunk_size);
+    pFrameResult_t result(res);
+    return _reader->start(file_path, [result]()
+    {
+        GetCB_Manager().ready_callback(result);
+    });
 }
 
 bool EOSSDK_TitleStorageFileTransferRequest::canceled()
@@ -116,12 +123,21 @@ EOS_EResult EOSSDK_TitleStorageFileTransferRequest::GetFilename(uint32_t Filenam
 EOS_EResult EOSSDK_TitleStorageFileTransferRequest::CancelRequest()
 {
     TRACE_FUNC();
-    std::lock_guard<std::mutex> _lk(_local_mutex);
+    pFrameResult_t result;
+    {
+        std::lock_guard<std::mutex> _lk(_local_mutex);
+
+        if (_done)
+            return EOS_EResult::EOS_NoChange;
+
+        _canceled = true;
+        result = _result;
+    }
 
-    if (_done)
-        return EOS_EResult::EOS_NoChange;
+    // The request might be waiting for its next chunk
+    if (result != nullptr)
+        GetCB_Manager().ready_callback(result);
 
-    _canceled = true;
     return EOS_EResult::EOS_Success;
 }
 
@@ -27,6 +27,8 @@ namespace sdk
     class EOSSDK_UI :
         public IRunCallback
     {
+        std::recursive_mutex local_mutex;
+
     public:
         EOSSDK_UI();
         ~EOSSDK_UI();
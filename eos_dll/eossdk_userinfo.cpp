@@ -91,7 +91,7 @@ UserInfo_Info_pb* EOSSDK_UserInfo::get_userinfo(EOS_EpicAccountId userid)
 void EOSSDK_UserInfo::QueryUserInfo(const EOS_UserInfo_QueryUserInfoOptions* Options, void* ClientData, const EOS_UserInfo_OnQueryUserInfoCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -114,6 +114,7 @@ void EOSSDK_UserInfo::QueryUserInfo(const EOS_UserInfo_QueryUserInfoOptions* Opt
     {
         quici.TargetUserId = Options->TargetUserId;
 
+        SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
         auto user = GetEOS_Connect().get_user_by_userid(Options->TargetUserId);
         if (user == GetEOS_Connect().get_end_users())
         {
@@ -158,7 +159,7 @@ void EOSSDK_UserInfo::QueryUserInfo(const EOS_UserInfo_QueryUserInfoOptions* Opt
 void EOSSDK_UserInfo::QueryUserInfoByDisplayName(const EOS_UserInfo_QueryUserInfoByDisplayNameOptions* Options, void* ClientData, const EOS_UserInfo_OnQueryUserInfoByDisplayNameCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -179,6 +180,7 @@ void EOSSDK_UserInfo::QueryUserInfoByDisplayName(const EOS_UserInfo_QueryUserInf
     }
     else
     {
+        SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
         auto user = GetEOS_Connect().get_user_by_name(Options->DisplayName);
         if (user == GetEOS_Connect().get_end_users())
         {
@@ -224,7 +226,7 @@ void EOSSDK_UserInfo::QueryUserInfoByDisplayName(const EOS_UserInfo_QueryUserInf
 void EOSSDK_UserInfo::QueryUserInfoByExternalAccount(const EOS_UserInfo_QueryUserInfoByExternalAccountOptions* Options, void* ClientData, const EOS_UserInfo_OnQueryUserInfoByExternalAccountCallback CompletionDelegate)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (CompletionDelegate == nullptr)
         return;
@@ -262,7 +264,7 @@ void EOSSDK_UserInfo::QueryUserInfoByExternalAccount(const EOS_UserInfo_QueryUse
 EOS_EResult EOSSDK_UserInfo::CopyUserInfo(const EOS_UserInfo_CopyUserInfoOptions* Options, EOS_UserInfo** OutUserInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     if (OutUserInfo == nullptr || Options == nullptr || Options->TargetUserId == nullptr || OutUserInfo == nullptr)
     {
@@ -305,7 +307,7 @@ EOS_EResult EOSSDK_UserInfo::CopyUserInfo(const EOS_UserInfo_CopyUserInfoOptions
 uint32_t EOSSDK_UserInfo::GetExternalUserInfoCount(const EOS_UserInfo_GetExternalUserInfoCountOptions* Options)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return 0;
 }
@@ -325,7 +327,7 @@ uint32_t EOSSDK_UserInfo::GetExternalUserInfoCount(const EOS_UserInfo_GetExterna
 EOS_EResult EOSSDK_UserInfo::CopyExternalUserInfoByIndex(const EOS_UserInfo_CopyExternalUserInfoByIndexOptions* Options, EOS_UserInfo_ExternalUserInfo** OutExternalUserInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutExternalUserInfo);
     return EOS_EResult::EOS_NotFound;
@@ -346,7 +348,7 @@ EOS_EResult EOSSDK_UserInfo::CopyExternalUserInfoByIndex(const EOS_UserInfo_Copy
 EOS_EResult EOSSDK_UserInfo::CopyExternalUserInfoByAccountType(const EOS_UserInfo_CopyExternalUserInfoByAccountTypeOptions* Options, EOS_UserInfo_ExternalUserInfo** OutExternalUserInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutExternalUserInfo);
     return EOS_EResult::EOS_NotFound;
@@ -367,7 +369,7 @@ EOS_EResult EOSSDK_UserInfo::CopyExternalUserInfoByAccountType(const EOS_UserInf
 EOS_EResult EOSSDK_UserInfo::CopyExternalUserInfoByAccountId(const EOS_UserInfo_CopyExternalUserInfoByAccountIdOptions* Options, EOS_UserInfo_ExternalUserInfo** OutExternalUserInfo)
 {
     TRACE_FUNC();
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     set_nullptr(OutExternalUserInfo);
     return EOS_EResult::EOS_NotFound;
@@ -418,15 +420,16 @@ bool EOSSDK_UserInfo::send_my_userinfo(Network::peer_t const& peerid)
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_UserInfo::on_userinfo_request(Network_Message_pb const& msg, UserInfo_Info_Request_pb const& req)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return send_my_userinfo(msg.source_id());
 }
 
 bool EOSSDK_UserInfo::on_userinfo(Network_Message_pb const& msg, UserInfo_Info_pb const& infos)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
+    SHARED_LOCK(users_lk, GetEOS_Connect().users_mutex);
     auto user = GetEOS_Connect().get_user_by_productid(GetProductUserId(msg.source_id()));
     if (user != GetEOS_Connect().get_end_users())
     {
@@ -455,6 +458,7 @@ bool EOSSDK_UserInfo::on_userinfo(Network_Message_pb const& msg, UserInfo_Info_p
                 }
 
                 (*result_it)->done = true;
+                GetCB_Manager().ready_callback(*result_it);
 
                 it->second.erase(result_it);
             }
@@ -469,7 +473,7 @@ bool EOSSDK_UserInfo::on_userinfo(Network_Message_pb const& msg, UserInfo_Info_p
 ///////////////////////////////////////////////////////////////////////////////
 bool EOSSDK_UserInfo::CBRunFrame()
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     for (auto& queries : _userinfos_queries)
     {
@@ -494,6 +498,7 @@ bool EOSSDK_UserInfo::CBRunFrame()
                 }
 
                 (*query_it)->done = true;
+                GetCB_Manager().ready_callback(*query_it);
                 query_it = queries.second.erase(query_it);
             }
             else
@@ -522,14 +527,14 @@ bool EOSSDK_UserInfo::RunNetwork(Network_Message_pb const& msg)
 
 bool EOSSDK_UserInfo::RunCallbacks(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     return res->done;
 }
 
 void EOSSDK_UserInfo::FreeCallback(pFrameResult_t res)
 {
-    GLOBAL_LOCK();
+    LOCAL_LOCK();
 
     //switch (res->res.m_iCallback)
     {
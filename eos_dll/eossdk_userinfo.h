@@ -29,6 +29,8 @@ namespace sdk
         public IRunCallback,
         public IRunNetwork
     {
+        std::recursive_mutex local_mutex;
+
         static constexpr auto userinfo_query_timeout = std::chrono::milliseconds(20000);
 
         std::unordered_map<EOS_EpicAccountId, UserInfo_Info_pb> _userinfos;
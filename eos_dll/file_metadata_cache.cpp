@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "file_metadata_cache.h"
+#include "md5_multi.h"
+
+namespace sdk
+{
+
+constexpr decltype(file_metadata_cache::index_version) file_metadata_cache::index_version;
+
+file_metadata_cache::file_metadata_cache(std::string index_path):
+    _index_path(std::move(index_path)),
+    _loaded(false),
+    _dirty(false)
+{}
+
+void file_metadata_cache::load()
+{
+    if (_loaded)
+        return;
+
+    _loaded = true;
+
+    if (!FileManager::is_file(_index_path))
+        return;
+
+    nlohmann::json index;
+    if (!FileManager::load_json(_index_path, index))
+        return;
+
+    try
+    {
+        if (index.value("version", 0) != index_version)
+        {
+            APP_LOG(Log::LogLevel::INFO, "Ignoring metadata index %s: unknown version", _index_path.c_str());
+            _dirty = true;
+            return;
+        }
+
+        for (auto& item : index["files"].items())
+        {
+            auto& value = item.value();
+            entry_t& entry = _entries[item.key()];
+            entry.info.size = value["size"].get<uint64_t>();
+            entry.info.mtime = value["mtime"].get<int64_t>();
+            entry.info.inode = value["inode"].get<uint64_t>();
+            entry.md5sum = value["md5"].get<std::string>();
+        }
+    }
+    catch (std::exception& e)
+    {
+        APP_LOG(Log::LogLevel::WARN, "Ignoring broken metadata index %s: %s", _index_path.c_str(), e.what());
+        _entries.clear();
+        _dirty = true;
+    }
+}
+
+bool file_metadata_cache::get(std::string const& key, std::string const& file_path, FileManager::file_info_t& info, std::string& md5sum)
+{
+    load();
+
+    if (!FileManager::file_info(file_path, info))
+    {
+        erase(key);
+        return false;
+    }
+
+    auto it = _entries.find(key);
+    if (it != _entries.end() &&
+        it->second.info.size == info.size &&
+        it->second.info.mtime == info.mtime &&
+        it->second.info.inode == info.inode)
+    {
+        md5sum = it->second.md5sum;
+        return true;
+    }
+
+    APP_LOG(Log::LogLevel::DEBUG, "Hashing %s", file_path.c_str());
+    md5sum = md5_multi::hash_file(file_path);
+    if (md5sum.empty())
+    {
+        erase(key);
+        return false;
+    }
+
+    // Keep the infos from before the hash: if the file changed meanwhile, it will be hashed again next time
+    entry_t& entry = _entries[key];
+    entry.info = info;
+    entry.md5sum = md5sum;
+    _dirty = true;
+
+    return true;
+}
+
+void file_metadata_cache::refresh(std::vector<std::string> const& keys, std::vector<std::string> const& file_paths)
+{
+    load();
+
+    std::vector<size_t> stale_files;
+    std::vector<std::string> stale_paths;
+    std::vector<FileManager::file_info_t> stale_infos;
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        FileManager::file_info_t info;
+        if (!FileManager::file_info(file_paths[i], info))
+        {
+            erase(keys[i]);
+            continue;
+        }
+
+        auto it = _entries.find(keys[i]);
+        if (it == _entries.end() ||
+            it->second.info.size != info.size ||
+            it->second.info.mtime != info.mtime ||
+            it->second.info.inode != info.inode)
+        {
+            stale_files.emplace_back(i);
+            stale_paths.emplace_back(file_paths[i]);
+            stale_infos.emplace_back(info);
+        }
+    }
+
+    if (stale_files.empty())
+        return;
+
+    APP_LOG(Log::LogLevel::DEBUG, "Hashing %zu files", stale_files.size());
+    std::vector<std::string> digests(md5_multi::hash_files(stale_paths));
+    for (size_t i = 0; i < stale_files.size(); ++i)
+    {
+        std::string const& key = keys[stale_files[i]];
+        if (digests[i].empty())
+        {
+            erase(key);
+            continue;
+        }
+
+        entry_t& entry = _entries[key];
+        entry.info = stale_infos[i];
+        entry.md5sum = std::move(digests[i]);
+        _dirty = true;
+    }
+}
+
+void file_metadata_cache::set(std::string const& key, FileManager::file_info_t const& info, std::string const& md5sum)
+{
+    load();
+
+    entry_t& entry = _entries[key];
+    entry.info = info;
+    entry.md5sum = md5sum;
+    _dirty = true;
+}
+
+void file_metadata_cache::erase(std::string const& key)
+{
+    load();
+
+    if (_entries.erase(key) != 0)
+        _dirty = true;
+}
+
+void file_metadata_cache::save()
+{
+    if (!_dirty)
+        return;
+
+    nlohmann::json index;
+    index["version"] = index_version;
+    nlohmann::json& files = index["files"] = nlohmann::json::object();
+    for (auto& entry : _entries)
+    {
+        nlohmann::json& value = files[entry.first];
+        value["size"] = entry.second.info.size;
+        value["mtime"] = entry.second.info.mtime;
+        value["inode"] = entry.second.info.inode;
+        value["md5"] = entry.second.md5sum;
+    }
+
+    if (FileManager::save_json(_index_path, index))
+        _dirty = false;
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+#include <unordered_set>
+
+namespace sdk
+{
+    // On disk index of the storage files md5, keyed by their path and checked against their size, mtime and inode.
+    // The index is loaded on first use and an entry is only validated when its file is requested,
+    // so a file is hashed again only when it is new or changed since the last run.
+    class file_metadata_cache
+    {
+        struct entry_t
+        {
+            FileManager::file_info_t info;
+            std::string md5sum;
+        };
+
+        std::string _index_path;
+        std::unordered_map<std::string, entry_t> _entries;
+        bool _loaded;
+        bool _dirty;
+
+        void load();
+
+    public:
+        static constexpr int index_version = 1;
+
+        file_metadata_cache(std::string index_path);
+
+        // Gets the size and md5 of file_path, rehashing it if it changed. Returns false if the file doesn't exist.
+        bool get(std::string const& key, std::string const& file_path, FileManager::file_info_t& info, std::string& md5sum);
+        // Validates the entries of a directory listing, the new or changed files are hashed together
+        void refresh(std::vector<std::string> const& keys, std::vector<std::string> const& file_paths);
+        // Records a file we just wrote and hashed ourselves
+        void set(std::string const& key, FileManager::file_info_t const& info, std::string const& md5sum);
+        void erase(std::string const& key);
+        // Forgets the entries that are not in keys, after a full listing of the directory
+        template<typename Container>
+        void retain(Container const& keys)
+        {
+            load();
+            for (auto it = _entries.begin(); it != _entries.end();)
+            {
+                if (keys.find(it->first) == keys.end())
+                {
+                    it = _entries.erase(it);
+                    _dirty = true;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        // Writes the index back if it changed
+        void save();
+    };
+}
@@ -17,16 +17,76 @@
  * <http://www.gnu.org/licenses/>.
  */
 
-#pragma once
-
 #include "frame_result.h"
+#include "slab_pool.h"
+#include "settings.h"
+
+// Callback parameters are EOS_*CallbackInfo structs, most of them fit in the smallest class
+static constexpr size_t param_size_classes[] = { 64, 128, 256, 512 };
+
+// The pools are never destroyed: FrameResults held by static objects can be released after the static destructors ran
+template<size_t Size>
+static slab_pool<Size>& get_pool()
+{
+    static slab_pool<Size>* pool = new slab_pool<Size>;
+    return *pool;
+}
+
+static slab_pool<sizeof(FrameResult)>& get_frame_result_pool()
+{
+    return get_pool<sizeof(FrameResult)>();
+}
+
+uint8_t* FrameResult::alloc_param(size_t size)
+{
+    if (size <= param_size_classes[0]) return reinterpret_cast<uint8_t*>(get_pool<param_size_classes[0]>().allocate());
+    if (size <= param_size_classes[1]) return reinterpret_cast<uint8_t*>(get_pool<param_size_classes[1]>().allocate());
+    if (size <= param_size_classes[2]) return reinterpret_cast<uint8_t*>(get_pool<param_size_classes[2]>().allocate());
+    if (size <= param_size_classes[3]) return reinterpret_cast<uint8_t*>(get_pool<param_size_classes[3]>().allocate());
+
+    return new uint8_t[size];
+}
+
+void FrameResult::free_param(uint8_t* param, size_t size)
+{
+    if (param == nullptr)
+        return;
+
+    if      (size <= param_size_classes[0]) get_pool<param_size_classes[0]>().deallocate(param);
+    else if (size <= param_size_classes[1]) get_pool<param_size_classes[1]>().deallocate(param);
+    else if (size <= param_size_classes[2]) get_pool<param_size_classes[2]>().deallocate(param);
+    else if (size <= param_size_classes[3]) get_pool<param_size_classes[3]>().deallocate(param);
+    else delete[] param;
+}
+
+void* FrameResult::operator new(size_t size)
+{
+    (void)size;
+    assert(size == sizeof(FrameResult));
+    return get_frame_result_pool().allocate();
+}
+
+void FrameResult::operator delete(void* ptr)
+{
+    get_frame_result_pool().deallocate(ptr);
+}
 
 FrameResult::FrameResult():
     created_time(std::chrono::steady_clock::now()),
     ok_timeout(std::chrono::milliseconds(0)),
     done(false),
     remove_on_timeout(true),
-    res({})
+    res({}),
+    _ref_count(0),
+    _prev(nullptr),
+    _next(nullptr),
+    _linked(false),
+    _owner(nullptr),
+    _schedule(callback_schedule_t::none),
+    _timer_slot(0),
+    _timeout(0),
+    _polling(false),
+    _wakeup(false)
 {
 }
 
@@ -35,33 +95,133 @@ FrameResult::FrameResult(FrameResult const& other) :
     ok_timeout(other.ok_timeout),
     done(other.done),
     remove_on_timeout(other.remove_on_timeout),
-    res({})
+    res({}),
+    _ref_count(0),
+    _prev(nullptr),
+    _next(nullptr),
+    _linked(false),
+    _owner(nullptr),
+    _schedule(callback_schedule_t::none),
+    _timer_slot(0),
+    _timeout(0),
+    _polling(false),
+    _wakeup(false)
 {
     res.cb_func = other.res.cb_func;
     res.callback_type_id = other.res.callback_type_id;
     res.func_param_size = other.res.func_param_size;
-    res.func_param = new uint8_t[other.res.func_param_size];
+    res.func_param = alloc_param(other.res.func_param_size);
     memcpy(res.func_param, other.res.func_param, other.res.func_param_size);
 }
 
 FrameResult::~FrameResult()
 {
-    delete[] res.func_param;
+    assert(!_linked);
+    free_param(res.func_param, res.func_param_size);
 }
 
 void* FrameResult::AllocCallback(CallbackObj func, size_t func_param_size, int i_callback, std::chrono::milliseconds ok_timeout)
 {
-    uint8_t* buff = new uint8_t[func_param_size];
-    SetCallback(func, buff, func_param_size, i_callback, ok_timeout);
-    return buff;
-}
+    free_param(res.func_param, res.func_param_size);
 
-void FrameResult::SetCallback(CallbackObj func, uint8_t* func_param, size_t func_param_size, int i_callback, std::chrono::milliseconds ok_timeout)
-{
-    this->ok_timeout = ok_timeout;
-    delete[]res.func_param;
-    res.cb_func = func;
+    this->ok_timeout = Settings::Inst().get_callback_latency(i_callback, ok_timeout);
+    res.cb_func = std::move(func);
     res.callback_type_id = i_callback;
     res.func_param_size = func_param_size;
-    res.func_param = func_param;
-}
\ No newline at end of file
+    res.func_param = alloc_param(func_param_size);
+    return res.func_param;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                             frame_result_list                             //
+///////////////////////////////////////////////////////////////////////////////
+frame_result_list::frame_result_list():
+    _head(nullptr),
+    _tail(nullptr),
+    _size(0)
+{}
+
+frame_result_list::frame_result_list(frame_result_list&& other) noexcept:
+    _head(other._head),
+    _tail(other._tail),
+    _size(other._size)
+{
+    other._head = nullptr;
+    other._tail = nullptr;
+    other._size = 0;
+}
+
+frame_result_list::~frame_result_list()
+{
+    clear();
+}
+
+void frame_result_list::push_back(pFrameResult_t const& res)
+{
+    FrameResult* result = res.get();
+    assert(!result->_linked && "FrameResult is already in a list");
+
+    result->add_ref();
+    result->_linked = true;
+    result->_prev = _tail;
+    result->_next = nullptr;
+    if (_tail != nullptr)
+        _tail->_next = result;
+    else
+        _head = result;
+
+    _tail = result;
+    ++_size;
+}
+
+void frame_result_list::splice_back(frame_result_list& other)
+{
+    if (other._head == nullptr)
+        return;
+
+    if (_tail != nullptr)
+    {
+        _tail->_next = other._head;
+        other._head->_prev = _tail;
+    }
+    else
+    {
+        _head = other._head;
+    }
+
+    _tail = other._tail;
+    _size += other._size;
+
+    other._head = nullptr;
+    other._tail = nullptr;
+    other._size = 0;
+}
+
+FrameResult* frame_result_list::erase(FrameResult* res)
+{
+    FrameResult* next = res->_next;
+
+    if (res->_prev != nullptr)
+        res->_prev->_next = res->_next;
+    else
+        _head = res->_next;
+
+    if (res->_next != nullptr)
+        res->_next->_prev = res->_prev;
+    else
+        _tail = res->_prev;
+
+    res->_prev = nullptr;
+    res->_next = nullptr;
+    res->_linked = false;
+    --_size;
+
+    res->release();
+    return next;
+}
+
+void frame_result_list::clear()
+{
+    while (_head != nullptr)
+        erase(_head);
+}
@@ -20,6 +20,11 @@
 #pragma once
 
 #include "common_includes.h"
+#include "intrusive_ptr.h"
+
+#include <atomic>
+
+class IRunCallback;
 
 using CallbackObj = std::function<void(void*)>;
 using CallbackFunc = void(EOS_CALL*)(void*);
@@ -32,11 +37,46 @@ struct CallbackMessage_t
     CallbackObj cb_func;
 };
 
+// FrameResults are allocated from a slab pool and their callback parameters from size classes pools,
+// issuing an api call doesn't go through the heap anymore once the pools are warm.
+// Where the Callback_Manager keeps a result
+enum class callback_schedule_t : uint8_t
+{
+    none,
+    timer,   // Waiting for its ok_timeout or its timeout in the timer wheel
+    ready,   // Will run on the next tick
+    waiting, // Waiting for its producer to mark it ready
+    polling, // Runs on every tick
+    running, // Being run by the Callback_Manager, outside of its lock
+};
+
 class FrameResult
 {
+    friend class frame_result_list;
+    friend class Callback_Manager;
+
     std::chrono::milliseconds ok_timeout;
     bool remove_on_timeout; // Remove the result if the api didn't read it fast enought
     CallbackMessage_t res;
+
+    std::atomic<uint32_t> _ref_count;
+    // Hooks for the frame_result_list holding this result
+    FrameResult* _prev;
+    FrameResult* _next;
+    bool _linked;
+
+    // Callback_Manager scheduling
+    IRunCallback* _owner;
+    callback_schedule_t _schedule;
+    size_t _timer_slot;
+    std::chrono::steady_clock::time_point _wakeup_time;
+    std::chrono::milliseconds _timeout;
+    bool _polling;
+    bool _wakeup; // ready_callback was called while it was running
+
+    static uint8_t* alloc_param(size_t size);
+    static void free_param(uint8_t* param, size_t size);
+
 public:
     const std::chrono::time_point<std::chrono::steady_clock> created_time;
     bool done;    // Set this to true will tell the callback_manager to fire the callback/apicall
@@ -45,22 +85,32 @@ public:
     FrameResult(FrameResult const& other);
     ~FrameResult();
 
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+
+    inline void add_ref() { _ref_count.fetch_add(1, std::memory_order_relaxed); }
+    inline void release()
+    {
+        if (_ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    // ok_timeout is the emulator latency, the callback_latency setting can override it
     void* AllocCallback(CallbackObj func, size_t func_param_size, int i_callback, std::chrono::milliseconds ok_timeout = std::chrono::milliseconds(100));
-    void SetCallback(CallbackObj func, uint8_t* func_param, size_t func_param_size, int i_callback, std::chrono::milliseconds ok_timeout = std::chrono::milliseconds(100));
 
     inline CallbackMessage_t const& GetCallbackMsg() const { return res; }
     inline int ICallback() const { return res.callback_type_id; }
     inline void* GetFuncParam() const { return res.func_param; }
     inline size_t CallbackSize() const { return res.func_param_size; }
-    inline CallbackObj GetFunc() const { return res.cb_func; }
+    inline CallbackObj const& GetFunc() const { return res.cb_func; }
 
     inline bool CallbackOKTimeout() { return ((std::chrono::steady_clock::now() - created_time) >= ok_timeout); }
 
-    template<typename T>
-    inline void SetCallback(CallbackObj func, T* func_param, std::chrono::milliseconds ok_timeout = std::chrono::milliseconds(100))
-    {
-        SetCallback(func, reinterpret_cast<uint8_t*>(func_param), sizeof(T), T::k_iCallback, ok_timeout);
-    }
+    // A result that is not done is only run again when its producer calls Callback_Manager::ready_callback, unless:
+    // RunCallbacks does the work itself (file transfers): run it on every tick until it is done
+    inline void SetPolling(bool polling) { _polling = polling; }
+    // RunCallbacks times the result out itself: run it again once created_time + timeout is reached
+    inline void SetTimeout(std::chrono::milliseconds timeout) { _timeout = timeout; }
 
     template<typename T>
     inline T& GetCallback()
@@ -78,4 +128,32 @@ public:
     }
 };
 
-using pFrameResult_t = std::shared_ptr<FrameResult>;
\ No newline at end of file
+using pFrameResult_t = intrusive_ptr<FrameResult>;
+
+// Intrusive doubly linked list of FrameResults, the links live in the FrameResult so pushing and erasing never allocates.
+// The list holds a reference on each of its results and a result can only be in one list at a time.
+class frame_result_list
+{
+    FrameResult* _head;
+    FrameResult* _tail;
+    size_t _size;
+
+public:
+    frame_result_list();
+    frame_result_list(frame_result_list&& other) noexcept;
+    frame_result_list(frame_result_list const&) = delete;
+    frame_result_list& operator=(frame_result_list const&) = delete;
+    ~frame_result_list();
+
+    inline bool empty() const { return _head == nullptr; }
+    inline size_t size() const { return _size; }
+    inline FrameResult* front() const { return _head; }
+    static inline FrameResult* next(FrameResult* res) { return res->_next; }
+
+    void push_back(pFrameResult_t const& res);
+    // Moves all the results of other at the end of this list
+    void splice_back(frame_result_list& other);
+    // Unlinks res, drops the list reference and returns the result that followed it
+    FrameResult* erase(FrameResult* res);
+    void clear();
+};
@@ -27,9 +27,30 @@
     #define CLANG_GCC_DONT_OPTIMIZE
 #endif
 
+#include "lock_profiler.h"
+
+// Lock order, a thread holding a lock can only take the ones below it:
+//   1. GLOBAL_LOCK                  : platform creation/release and settings, never taken in a Tick
+//   2. Callback_Manager::_tick_mutex: serializes Tick, held while running the interfaces frames and the games callbacks
+//   3. Network::_listeners_mutex    : held while dispatching the network messages to the interfaces
+//   4. Interfaces LOCAL_LOCK        : an interface never takes another interface LOCAL_LOCK,
+//                                     games callbacks are never run while holding one, notifications are fired
+//                                     by Callback_Manager::post_notifications and results by RunCallbacks once unlocked
+//   5. EOSSDK_Connect::users_mutex  : shared by the other interfaces to read the users, Connect never calls another interface while holding it
+//   6. Callback_Manager::local_mutex, Network::local_mutex, id_registry::_mutex and the other leaf locks: they never call out while held
+#ifdef EMU_LOCK_PROFILER
+using global_lock_t = std::unique_lock<std::recursive_mutex>;
+using local_lock_t = std::unique_lock<std::recursive_mutex>;
+#else
 using global_lock_t = std::lock_guard<std::recursive_mutex>;
+using local_lock_t = std::lock_guard<std::recursive_mutex>;
+#endif
 LOCAL_API std::recursive_mutex& global_mutex();
-#define GLOBAL_LOCK() global_lock_t __global_lock(global_mutex())
+#define GLOBAL_LOCK() PROFILED_LOCK(global_lock_t, __global_lock, global_mutex())
+// Takes the local_mutex of the interface
+#define LOCAL_LOCK() PROFILED_LOCK(local_lock_t, __local_lock, local_mutex)
+#define SHARED_LOCK(var, mutex) PROFILED_LOCK(std::shared_lock<std::shared_mutex>, var, mutex)
+#define UNIQUE_LOCK(var, mutex) PROFILED_LOCK(std::unique_lock<std::shared_mutex>, var, mutex)
 
 LOCAL_API std::random_device& get_rd();
 LOCAL_API std::mt19937_64& get_gen();
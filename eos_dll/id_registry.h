@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+#include <unordered_map>
+#include <unordered_set>
+
+// Interning table for EOS_EpicAccountIdDetails/EOS_ProductUserIdDetails: one object per id, alive until the registry dies.
+// Canonical ids (32 lower case hex chars) are looked up by their binary form in an open addressing table,
+// the other ones in a string map.
+template<typename IdDetails>
+class id_registry
+{
+    struct slot_t
+    {
+        id128_t id;
+        IdDetails* details; // nullptr if the slot is free
+    };
+
+    static constexpr size_t initial_capacity = 64; // Must be a power of 2
+
+    mutable std::shared_mutex _mutex;
+    std::vector<slot_t> _slots;
+    size_t _count;
+    std::unordered_map<std::string, IdDetails*> _others;
+    // Every object handed out, to check the pointers we get back from the game
+    std::unordered_set<IdDetails const*> _known;
+
+    // Linear probing, returns the slot holding id or the free slot where it should go
+    slot_t& find_slot(id128_t const& id)
+    {
+        size_t mask = _slots.size() - 1;
+        for (size_t i = id.hash() & mask;; i = (i + 1) & mask)
+        {
+            slot_t& slot = _slots[i];
+            if (slot.details == nullptr || slot.id == id)
+                return slot;
+        }
+    }
+
+    slot_t const& find_slot(id128_t const& id) const
+    {
+        return const_cast<id_registry*>(this)->find_slot(id);
+    }
+
+    void grow()
+    {
+        std::vector<slot_t> old_slots(_slots.size() * 2, slot_t{ {}, nullptr });
+        std::swap(old_slots, _slots);
+        for (auto& slot : old_slots)
+        {
+            if (slot.details != nullptr)
+                find_slot(slot.id) = slot;
+        }
+    }
+
+    IdDetails* find(id128_t const& id, bool canonical, std::string const& idstr) const
+    {
+        if (canonical)
+            return find_slot(id).details;
+
+        auto it = _others.find(idstr);
+        return it == _others.end() ? nullptr : it->second;
+    }
+
+public:
+    id_registry():
+        _slots(initial_capacity, slot_t{ {}, nullptr }),
+        _count(0)
+    {}
+
+    id_registry(id_registry const&) = delete;
+    id_registry& operator=(id_registry const&) = delete;
+
+    ~id_registry()
+    {
+        for (auto details : _known)
+            delete details;
+    }
+
+    IdDetails* get(std::string const& idstr)
+    {
+        id128_t id{};
+        bool canonical = id128_t::parse(idstr.c_str(), idstr.length(), id);
+
+        {
+            SHARED_LOCK(lk, _mutex);
+            IdDetails* details = find(id, canonical, idstr);
+            if (details != nullptr)
+                return details;
+        }
+
+        UNIQUE_LOCK(lk, _mutex);
+        // Someone might have created it while we were not holding the lock
+        IdDetails* details = find(id, canonical, idstr);
+        if (details != nullptr)
+            return details;
+
+        details = new IdDetails(idstr);
+        _known.emplace(details);
+        if (canonical)
+        {
+            // Keep the load factor under 1/2 so the probes stay short
+            if ((_count + 1) * 2 > _slots.size())
+                grow();
+
+            find_slot(id) = slot_t{ id, details };
+            ++_count;
+        }
+        else
+        {
+            _others.emplace(idstr, details);
+        }
+
+        return details;
+    }
+
+    bool contains(IdDetails const* details) const
+    {
+        SHARED_LOCK(lk, _mutex);
+        return _known.count(details) != 0;
+    }
+};
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+// Smart pointer for objects that carry their own reference count.
+// T must provide add_ref() and release(), release() destroys the object when the count drops to 0.
+// Unlike std::shared_ptr there is no separate control block to allocate.
+template<typename T>
+class intrusive_ptr
+{
+    T* _ptr;
+
+public:
+    constexpr intrusive_ptr() noexcept:
+        _ptr(nullptr)
+    {}
+
+    constexpr intrusive_ptr(std::nullptr_t) noexcept:
+        _ptr(nullptr)
+    {}
+
+    explicit intrusive_ptr(T* ptr) noexcept:
+        _ptr(ptr)
+    {
+        if (_ptr != nullptr)
+            _ptr->add_ref();
+    }
+
+    intrusive_ptr(intrusive_ptr const& other) noexcept:
+        intrusive_ptr(other._ptr)
+    {}
+
+    intrusive_ptr(intrusive_ptr&& other) noexcept:
+        _ptr(other._ptr)
+    {
+        other._ptr = nullptr;
+    }
+
+    ~intrusive_ptr()
+    {
+        if (_ptr != nullptr)
+            _ptr->release();
+    }
+
+    intrusive_ptr& operator=(intrusive_ptr const& other) noexcept
+    {
+        intrusive_ptr(other).swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr& operator=(intrusive_ptr&& other) noexcept
+    {
+        intrusive_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void reset() noexcept { intrusive_ptr().swap(*this); }
+    void reset(T* ptr) noexcept { intrusive_ptr(ptr).swap(*this); }
+    void swap(intrusive_ptr& other) noexcept { std::swap(_ptr, other._ptr); }
+
+    T* get() const noexcept { return _ptr; }
+    T& operator*() const noexcept { return *_ptr; }
+    T* operator->() const noexcept { return _ptr; }
+    explicit operator bool() const noexcept { return _ptr != nullptr; }
+
+    friend bool operator==(intrusive_ptr const& a, intrusive_ptr const& b) noexcept { return a._ptr == b._ptr; }
+    friend bool operator!=(intrusive_ptr const& a, intrusive_ptr const& b) noexcept { return a._ptr != b._ptr; }
+    friend bool operator==(intrusive_ptr const& a, std::nullptr_t) noexcept { return a._ptr == nullptr; }
+    friend bool operator!=(intrusive_ptr const& a, std::nullptr_t) noexcept { return a._ptr != nullptr; }
+    friend bool operator<(intrusive_ptr const& a, intrusive_ptr const& b) noexcept { return std::less<T*>()(a._ptr, b._ptr); }
+};
+
+namespace std
+{
+    template<typename T>
+    struct hash<intrusive_ptr<T>>
+    {
+        size_t operator()(intrusive_ptr<T> const& p) const noexcept { return std::hash<T*>()(p.get()); }
+    };
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "io_pool.h"
+
+constexpr decltype(io_pool::default_worker_count) io_pool::default_worker_count;
+
+io_pool::io_pool(size_t worker_count):
+    _worker_count(std::max<size_t>(worker_count, 1)),
+    _stop(false)
+{}
+
+io_pool::~io_pool()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+void io_pool::worker()
+{
+    std::unique_lock<std::mutex> lk(_mutex);
+    for (;;)
+    {
+        _cv.wait(lk, [this]() { return _stop || !_jobs.empty(); });
+        if (_jobs.empty())
+            break;
+
+        std::function<void()> job(std::move(_jobs.front()));
+        _jobs.pop_front();
+
+        lk.unlock();
+        job();
+        lk.lock();
+    }
+}
+
+void io_pool::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (_stop)
+            return;
+
+        _jobs.emplace_back(std::move(job));
+        // The threads are started with the first jobs
+        if (_workers.size() < _worker_count)
+            _workers.emplace_back(&io_pool::worker, this);
+    }
+    _cv.notify_one();
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+
+#include <condition_variable>
+#include <deque>
+
+// Small pool of threads running the blocking file I/O, so the game thread never waits on the disk.
+// The threads are started by the first job.
+class io_pool
+{
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<std::function<void()>> _jobs;
+    std::vector<std::thread> _workers;
+    size_t _worker_count;
+    bool _stop;
+
+    void worker();
+
+public:
+    static constexpr size_t default_worker_count = 2;
+
+    io_pool(size_t worker_count = default_worker_count);
+    // Runs the jobs left before joining, a pending write must not be lost
+    ~io_pool();
+
+    io_pool(io_pool const&) = delete;
+    io_pool& operator=(io_pool const&) = delete;
+
+    void post(std::function<void()> job);
+};
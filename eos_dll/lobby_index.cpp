@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "lobby_index.h"
+#include "eossdk_lobby.h"
+
+namespace sdk
+{
+
+static bool same_attribute_value(Lobby_Attr_Value const& v1, Lobby_Attr_Value const& v2)
+{
+    if (v1.value_case() != v2.value_case())
+        return false;
+
+    switch (v1.value_case())
+    {
+        case Lobby_Attr_Value::ValueCase::kI: return v1.i() == v2.i();
+        case Lobby_Attr_Value::ValueCase::kD: return v1.d() == v2.d();
+        case Lobby_Attr_Value::ValueCase::kB: return v1.b() == v2.b();
+        case Lobby_Attr_Value::ValueCase::kS: return v1.s() == v2.s();
+        default: return true;
+    }
+}
+
+template<typename Container, typename Key>
+static void erase_entry(Container& container, Key const& key, lobby_state_t* lobby)
+{
+    auto range = container.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == lobby)
+        {
+            container.erase(it);
+            return;
+        }
+    }
+}
+
+// Counts (and appends to out) the lobbies of a sorted index matching "lobby value <op> key"
+template<typename T>
+static size_t match_sorted(std::multimap<T, lobby_state_t*> const& index, EOS_EOnlineComparisonOp op, T key, std::vector<lobby_state_t*>* out)
+{
+    auto first = index.begin();
+    auto last = index.end();
+    switch (op)
+    {
+        case EOS_EOnlineComparisonOp::EOS_CO_EQUAL             : first = index.lower_bound(key); last = index.upper_bound(key); break;
+        case EOS_EOnlineComparisonOp::EOS_CO_GREATERTHAN       : first = index.upper_bound(key); break;
+        case EOS_EOnlineComparisonOp::EOS_CO_GREATERTHANOREQUAL: first = index.lower_bound(key); break;
+        case EOS_EOnlineComparisonOp::EOS_CO_LESSTHAN          : last = index.lower_bound(key); break;
+        case EOS_EOnlineComparisonOp::EOS_CO_LESSTHANOREQUAL   : last = index.upper_bound(key); break;
+        default: break;
+    }
+
+    size_t count = 0;
+    for (; first != last; ++first, ++count)
+    {
+        if (out != nullptr)
+            out->emplace_back(first->second);
+    }
+
+    return count;
+}
+
+template<typename Container>
+static size_t match_all(Container const& lobbies, std::vector<lobby_state_t*>* out)
+{
+    if (out != nullptr)
+        out->insert(out->end(), lobbies.begin(), lobbies.end());
+
+    return lobbies.size();
+}
+
+void lobby_index::add_attribute(std::string const& key, Lobby_Attr_Value const& value, lobby_state_t* lobby)
+{
+    attribute_index_t& index = _attributes[key];
+    index.lobbies.emplace(lobby);
+    switch (value.value_case())
+    {
+        case Lobby_Attr_Value::ValueCase::kI: index.ints.emplace(value.i(), lobby); break;
+        case Lobby_Attr_Value::ValueCase::kD: index.doubles.emplace(value.d(), lobby); break;
+        case Lobby_Attr_Value::ValueCase::kB: index.bools[value.b()].emplace(lobby); break;
+        case Lobby_Attr_Value::ValueCase::kS: index.strings.emplace(value.s(), lobby); break;
+        default: break;
+    }
+}
+
+void lobby_index::remove_attribute(std::string const& key, Lobby_Attr_Value const& value, lobby_state_t* lobby)
+{
+    auto it = _attributes.find(key);
+    if (it == _attributes.end())
+        return;
+
+    attribute_index_t& index = it->second;
+    index.lobbies.erase(lobby);
+    switch (value.value_case())
+    {
+        case Lobby_Attr_Value::ValueCase::kI: erase_entry(index.ints, value.i(), lobby); break;
+        case Lobby_Attr_Value::ValueCase::kD: erase_entry(index.doubles, value.d(), lobby); break;
+        case Lobby_Attr_Value::ValueCase::kB: index.bools[value.b()].erase(lobby); break;
+        case Lobby_Attr_Value::ValueCase::kS: erase_entry(index.strings, value.s(), lobby); break;
+        default: break;
+    }
+
+    if (index.lobbies.empty())
+        _attributes.erase(it);
+}
+
+void lobby_index::update(lobby_state_t* lobby)
+{
+    auto res = _lobbies.emplace(lobby, indexed_lobby_t{});
+    bool new_lobby = res.second;
+    indexed_lobby_t& indexed = res.first->second;
+    auto const& attributes = lobby->infos.attributes();
+
+    for (auto it = indexed.attributes.begin(); it != indexed.attributes.end();)
+    {
+        auto attr_it = attributes.find(it->first);
+        if (attr_it == attributes.end() || !same_attribute_value(attr_it->second.value(), it->second))
+        {
+            remove_attribute(it->first, it->second, lobby);
+            it = indexed.attributes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto const& attr : attributes)
+    {
+        if (indexed.attributes.count(attr.first) == 0)
+        {
+            add_attribute(attr.first, attr.second.value(), lobby);
+            indexed.attributes.emplace(attr.first, attr.second.value());
+        }
+    }
+
+    std::string const& bucket_id = lobby->infos.bucket_id();
+    if (new_lobby || indexed.bucket_id != bucket_id)
+    {
+        auto bucket_it = _buckets.find(indexed.bucket_id);
+        if (!new_lobby && bucket_it != _buckets.end())
+        {
+            bucket_it->second.erase(lobby);
+            if (bucket_it->second.empty())
+                _buckets.erase(bucket_it);
+        }
+
+        indexed.bucket_id = bucket_id;
+        _buckets[bucket_id].emplace(lobby);
+    }
+}
+
+void lobby_index::remove(lobby_state_t* lobby)
+{
+    auto it = _lobbies.find(lobby);
+    if (it == _lobbies.end())
+        return;
+
+    for (auto const& attr : it->second.attributes)
+        remove_attribute(attr.first, attr.second, lobby);
+
+    auto bucket_it = _buckets.find(it->second.bucket_id);
+    if (bucket_it != _buckets.end())
+    {
+        bucket_it->second.erase(lobby);
+        if (bucket_it->second.empty())
+            _buckets.erase(bucket_it);
+    }
+
+    _lobbies.erase(it);
+}
+
+size_t lobby_index::match(attribute_index_t const& index, int32_t op, Lobby_Attr_Value const& value, std::vector<lobby_state_t*>* out)
+{
+    EOS_EOnlineComparisonOp comp = static_cast<EOS_EOnlineComparisonOp>(op);
+    switch (value.value_case())
+    {
+        case Lobby_Attr_Value::ValueCase::kI: return match_sorted(index.ints, comp, value.i(), out);
+        case Lobby_Attr_Value::ValueCase::kD: return match_sorted(index.doubles, comp, value.d(), out);
+
+        case Lobby_Attr_Value::ValueCase::kB:
+            if (comp == EOS_EOnlineComparisonOp::EOS_CO_EQUAL)
+                return match_all(index.bools[value.b()], out);
+            if (comp == EOS_EOnlineComparisonOp::EOS_CO_NOTEQUAL)
+                return match_all(index.bools[!value.b()], out);
+            break;
+
+        case Lobby_Attr_Value::ValueCase::kS:
+            if (comp == EOS_EOnlineComparisonOp::EOS_CO_EQUAL)
+            {
+                auto range = index.strings.equal_range(value.s());
+                size_t count = 0;
+                for (auto it = range.first; it != range.second; ++it, ++count)
+                {
+                    if (out != nullptr)
+                        out->emplace_back(it->second);
+                }
+                return count;
+            }
+            break;
+
+        default: break;
+    }
+
+    // Not indexed, every lobby having the attribute is a candidate
+    return match_all(index.lobbies, out);
+}
+
+bool lobby_index::find_candidates(google::protobuf::Map<std::string, Lobby_Search_Parameter> const& parameters, std::vector<lobby_state_t*>& candidates) const
+{
+    // Plan: count the matches of each indexed comparison and only walk the smallest one
+    std::function<size_t(std::vector<lobby_state_t*>*)> best_source;
+    size_t best_count = std::numeric_limits<size_t>::max();
+
+    for (auto const& param : parameters)
+    {
+        switchstr(param.first)
+        {
+            casestr(EOS_LOBBY_SEARCH_MINCURRENTMEMBERS):
+            casestr(EOS_LOBBY_SEARCH_MINSLOTSAVAILABLE):
+                // The members change all the time, they are tested on the candidates
+                break;
+
+            casestr(EOS_LOBBY_SEARCH_BUCKET_ID):
+            {
+                auto it = param.second.param().find(utils::GetEnumValue(EOS_EOnlineComparisonOp::EOS_CO_EQUAL));
+                if (it == param.second.param().end() || it->second.value_case() != Lobby_Attr_Value::ValueCase::kS)
+                    break;
+
+                auto bucket_it = _buckets.find(it->second.s());
+                size_t count = (bucket_it == _buckets.end() ? 0 : bucket_it->second.size());
+                if (count < best_count)
+                {
+                    best_count = count;
+                    best_source = [bucket_it, this](std::vector<lobby_state_t*>* out) -> size_t
+                    {
+                        return bucket_it == _buckets.end() ? 0 : match_all(bucket_it->second, out);
+                    };
+                }
+            }
+            break;
+
+            default:
+            {
+                auto attr_it = _attributes.find(param.first);
+                if (attr_it == _attributes.end())
+                {// No lobby has this attribute, nothing can match
+                    candidates.clear();
+                    return true;
+                }
+
+                for (auto const& comparison : param.second.param())
+                {
+                    size_t count = match(attr_it->second, comparison.first, comparison.second, nullptr);
+                    if (count < best_count)
+                    {
+                        best_count = count;
+                        attribute_index_t const* index = &attr_it->second;
+                        int32_t op = comparison.first;
+                        Lobby_Attr_Value const* value = &comparison.second;
+                        best_source = [index, op, value](std::vector<lobby_state_t*>* out)
+                        {
+                            return match(*index, op, *value, out);
+                        };
+                    }
+                }
+            }
+        }
+
+        if (best_count == 0)
+            break;
+    }
+
+    candidates.clear();
+    if (!best_source)
+        return false;
+
+    candidates.reserve(best_count);
+    best_source(&candidates);
+    return true;
+}
+
+}
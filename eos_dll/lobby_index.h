@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+#include <unordered_set>
+
+namespace sdk
+{
+    struct lobby_state_t;
+
+    // Secondary index over the lobbies attributes and bucket ids, so a search doesn't test every lobby.
+    // Sorted indices answer the int and double comparisons, hash indices the string and bool equalities.
+    // The index only narrows the search: the candidates still have to be tested against all the parameters.
+    class lobby_index
+    {
+        struct attribute_index_t
+        {
+            std::multimap<int64_t, lobby_state_t*> ints;
+            std::multimap<double, lobby_state_t*> doubles;
+            std::unordered_multimap<std::string, lobby_state_t*> strings;
+            std::unordered_set<lobby_state_t*> bools[2];
+            // Every lobby having the attribute, used by the comparisons the typed indices can't answer
+            std::unordered_set<lobby_state_t*> lobbies;
+        };
+
+        // What was indexed for a lobby, to remove it when it changes
+        struct indexed_lobby_t
+        {
+            std::string bucket_id;
+            std::map<std::string, Lobby_Attr_Value> attributes;
+        };
+
+        std::unordered_map<std::string, attribute_index_t> _attributes;
+        std::unordered_map<std::string, std::unordered_set<lobby_state_t*>> _buckets;
+        std::unordered_map<lobby_state_t*, indexed_lobby_t> _lobbies;
+
+        void add_attribute(std::string const& key, Lobby_Attr_Value const& value, lobby_state_t* lobby);
+        void remove_attribute(std::string const& key, Lobby_Attr_Value const& value, lobby_state_t* lobby);
+
+        // Counts the lobbies matching a single comparison, appends them to out if it's not null
+        static size_t match(attribute_index_t const& index, int32_t op, Lobby_Attr_Value const& value, std::vector<lobby_state_t*>* out);
+
+    public:
+        // Must be called each time the lobby attributes or bucket id change
+        void update(lobby_state_t* lobby);
+        // Must be called before the lobby is destroyed
+        void remove(lobby_state_t* lobby);
+
+        // Fills candidates with the lobbies matching the most selective indexed comparison.
+        // Returns false if no parameter could use the index: every lobby must be tested.
+        bool find_candidates(google::protobuf::Map<std::string, Lobby_Search_Parameter> const& parameters, std::vector<lobby_state_t*>& candidates) const;
+    };
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "lock_profiler.h"
+
+#ifdef EMU_LOCK_PROFILER
+
+#include "common_includes.h"
+
+static std::atomic<lock_site*> lock_sites(nullptr);
+
+lock_site::lock_site(const char* file, int line, const char* func):
+    _file(file),
+    _line(line),
+    _func(func),
+    _next(lock_sites.load(std::memory_order_relaxed)),
+    acquisitions(0),
+    contentions(0),
+    total_wait_ns(0),
+    max_wait_ns(0)
+{
+    while (!lock_sites.compare_exchange_weak(_next, this, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void lock_site::add_wait(std::chrono::steady_clock::duration wait)
+{
+    uint64_t wait_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+
+    ++contentions;
+    total_wait_ns += wait_ns;
+
+    uint64_t max_wait = max_wait_ns.load(std::memory_order_relaxed);
+    while (wait_ns > max_wait && !max_wait_ns.compare_exchange_weak(max_wait, wait_ns, std::memory_order_relaxed));
+}
+
+void lock_profiler_dump()
+{
+    std::vector<lock_site*> sites;
+    for (lock_site* site = lock_sites.load(std::memory_order_acquire); site != nullptr; site = site->next())
+    {
+        if (site->contentions != 0)
+            sites.emplace_back(site);
+    }
+
+    std::sort(sites.begin(), sites.end(), [](lock_site* a, lock_site* b)
+    {
+        return a->total_wait_ns > b->total_wait_ns;
+    });
+
+    APP_LOG(Log::LogLevel::INFO, "Lock profiler: %zu contended lock sites", sites.size());
+    for (lock_site* site : sites)
+    {
+        uint64_t contentions = site->contentions;
+        uint64_t total_wait_ns = site->total_wait_ns;
+        APP_LOG(Log::LogLevel::INFO, "  %s:%d (%s): %llu/%llu contended, waited %llu us total, %llu us avg, %llu us max",
+            site->file(), site->line(), site->func(),
+            static_cast<unsigned long long>(contentions), static_cast<unsigned long long>(site->acquisitions.load()),
+            static_cast<unsigned long long>(total_wait_ns / 1000),
+            static_cast<unsigned long long>(total_wait_ns / contentions / 1000),
+            static_cast<unsigned long long>(site->max_wait_ns / 1000));
+    }
+}
+
+#endif
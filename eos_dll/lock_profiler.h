@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Optional lock contention profiler, built with EMU_LOCK_PROFILER (cmake -DEMU_LOCK_PROFILER=ON).
+// Every lock macro (GLOBAL_LOCK, LOCAL_LOCK, SHARED_LOCK, UNIQUE_LOCK) gets a static lock_site that records
+// how often it was taken, how often it had to wait and for how long. The sites are dumped by lock_profiler_dump().
+
+#ifdef EMU_LOCK_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class lock_site
+{
+    const char* _file;
+    int _line;
+    const char* _func;
+    lock_site* _next;
+
+public:
+    std::atomic<uint64_t> acquisitions;
+    std::atomic<uint64_t> contentions;
+    std::atomic<uint64_t> total_wait_ns;
+    std::atomic<uint64_t> max_wait_ns;
+
+    lock_site(const char* file, int line, const char* func);
+
+    lock_site(lock_site const&) = delete;
+    lock_site& operator=(lock_site const&) = delete;
+
+    void add_wait(std::chrono::steady_clock::duration wait);
+
+    inline const char* file() const { return _file; }
+    inline int line() const { return _line; }
+    inline const char* func() const { return _func; }
+    inline lock_site* next() const { return _next; }
+};
+
+template<typename Lock>
+inline void profile_lock(Lock& lk, lock_site& site)
+{
+    ++site.acquisitions;
+    if (lk.try_lock())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    lk.lock();
+    site.add_wait(std::chrono::steady_clock::now() - start);
+}
+
+// Logs every lock site that had to wait, the most contended first
+void lock_profiler_dump();
+
+#define PROFILED_LOCK(lock_type, var, mutex) \
+    static lock_site var##_site(__FILE__, __LINE__, __func__); \
+    lock_type var(mutex, std::defer_lock); \
+    profile_lock(var, var##_site)
+
+#else
+
+inline void lock_profiler_dump() {}
+
+#define PROFILED_LOCK(lock_type, var, mutex) lock_type var(mutex)
+
+#endif
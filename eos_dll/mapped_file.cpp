@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapped_file.h"
+
+constexpr decltype(mapped_file_cache::default_max_cached_bytes) mapped_file_cache::default_max_cached_bytes;
+
+mapped_file::mapped_file():
+    _data(nullptr),
+    _size(0),
+    _info{}
+{}
+
+#if defined(__WINDOWS__)
+
+mapped_file::~mapped_file()
+{
+    if (_data != nullptr)
+        UnmapViewOfFile(_data);
+}
+
+// Same values as FileManager::file_info, but read from the opened file so they match what gets mapped
+static bool opened_file_info(HANDLE hFile, FileManager::file_info_t& info)
+{
+    BY_HANDLE_FILE_INFORMATION file_infos;
+    if (GetFileInformationByHandle(hFile, &file_infos) == FALSE || (file_infos.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
+        return false;
+
+    info.size = (uint64_t(file_infos.nFileSizeHigh) << 32) | file_infos.nFileSizeLow;
+    // FILETIME counts 100 nanoseconds since 1601
+    constexpr uint64_t filetime_unix_epoch = 116444736000000000ull;
+    uint64_t filetime = (uint64_t(file_infos.ftLastWriteTime.dwHighDateTime) << 32) | file_infos.ftLastWriteTime.dwLowDateTime;
+    info.mtime = (int64_t(filetime) - int64_t(filetime_unix_epoch)) * 100;
+    info.inode = (uint64_t(file_infos.nFileIndexHigh) << 32) | file_infos.nFileIndexLow;
+
+    return true;
+}
+
+std::shared_ptr<mapped_file> mapped_file::map(std::string const& file_path)
+{
+    std::shared_ptr<mapped_file> res(new mapped_file);
+
+    std::string path(FileManager::canonical_path(file_path));
+    std::wstring wpath;
+    utf8::utf8to16(path.begin(), path.end(), std::back_inserter(wpath));
+
+    HANDLE hFile = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    // The file might have been replaced since the path was looked up, describe the one we opened
+    if (!opened_file_info(hFile, res->_info) || res->_info.size == 0 || res->_info.size > std::numeric_limits<size_t>::max())
+    {
+        CloseHandle(hFile);
+        return nullptr;
+    }
+
+    HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+    if (hMapping == NULL)
+        return nullptr;
+
+    // The view keeps the mapping and the file alive
+    res->_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(hMapping);
+    if (res->_data == nullptr)
+        return nullptr;
+
+    res->_size = static_cast<size_t>(res->_info.size);
+    return res;
+}
+
+#else
+
+mapped_file::~mapped_file()
+{
+    if (_data != nullptr)
+        munmap(const_cast<uint8_t*>(_data), _size);
+}
+
+// Same values as FileManager::file_info, but read from the opened file so they match what gets mapped
+static bool opened_file_info(int fd, FileManager::file_info_t& info)
+{
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode))
+        return false;
+
+    info.size = sb.st_size;
+#if defined(__APPLE__)
+    info.mtime = int64_t(sb.st_mtimespec.tv_sec) * 1000000000 + sb.st_mtimespec.tv_nsec;
+#else
+    info.mtime = int64_t(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+#endif
+    info.inode = sb.st_ino;
+
+    return true;
+}
+
+std::shared_ptr<mapped_file> mapped_file::map(std::string const& file_path)
+{
+    std::shared_ptr<mapped_file> res(new mapped_file);
+
+    std::string path(FileManager::canonical_path(file_path));
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    // The file might have been replaced since the path was looked up, describe the one we opened
+    if (!opened_file_info(fd, res->_info) || res->_info.size == 0 || res->_info.size > std::numeric_limits<size_t>::max())
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(res->_info.size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    // The chunks are handed out in order, let the kernel read ahead
+    madvise(data, static_cast<size_t>(res->_info.size), MADV_SEQUENTIAL);
+
+    res->_data = reinterpret_cast<const uint8_t*>(data);
+    res->_size = static_cast<size_t>(res->_info.size);
+    return res;
+}
+
+#endif
+
+mapped_file_cache::mapped_file_cache(uint64_t max_file_size, uint64_t max_cached_bytes):
+    _max_file_size(max_file_size),
+    _max_cached_bytes(std::max(max_cached_bytes, max_file_size)),
+    _cached_bytes(0)
+{}
+
+void mapped_file_cache::drop(std::unordered_map<std::string, entry_t>::iterator it)
+{
+    _cached_bytes -= it->second.file->size();
+    _lru.erase(it->second.lru_it);
+    _files.erase(it);
+}
+
+std::shared_ptr<mapped_file> mapped_file_cache::acquire(std::string const& file_path)
+{
+    if (_max_file_size == 0)
+        return nullptr;
+
+    FileManager::file_info_t info;
+    bool is_file = FileManager::file_info(file_path, info);
+
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    auto it = _files.find(file_path);
+    if (it != _files.end())
+    {
+        FileManager::file_info_t const& cached_info = it->second.file->info();
+        if (is_file && cached_info.size == info.size && cached_info.mtime == info.mtime && cached_info.inode == info.inode)
+        {
+            _lru.splice(_lru.begin(), _lru, it->second.lru_it);
+            return it->second.file;
+        }
+
+        // The file changed since it was mapped
+        drop(it);
+    }
+
+    if (!is_file || info.size == 0 || info.size > _max_file_size)
+        return nullptr;
+
+    // The mapped file describes itself, it might not be the one we just looked up
+    std::shared_ptr<mapped_file> file(mapped_file::map(file_path));
+    if (file == nullptr || file->size() > _max_file_size)
+        return nullptr;
+
+    _lru.emplace_front(file_path);
+    _files[file_path] = entry_t{ file, _lru.begin() };
+    _cached_bytes += file->size();
+
+    // Unmap the least recently used files, the readers still running keep their own reference
+    while (_cached_bytes > _max_cached_bytes && _lru.size() > 1)
+        drop(_files.find(_lru.back()));
+
+    return file;
+}
+
+void mapped_file_cache::invalidate(std::string const& file_path)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    auto it = _files.find(file_path);
+    if (it != _files.end())
+        drop(it);
+}
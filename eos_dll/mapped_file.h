@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+
+// Read only mapping of a whole file, unmapped when the last reader drops it.
+class mapped_file
+{
+    const uint8_t* _data;
+    size_t _size;
+    FileManager::file_info_t _info;
+
+    mapped_file();
+
+public:
+    ~mapped_file();
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    // Returns nullptr if the file can't be mapped, an empty file can't be mapped either
+    static std::shared_ptr<mapped_file> map(std::string const& file_path);
+
+    inline const uint8_t* data() const { return _data; }
+    inline size_t size() const { return _size; }
+    inline FileManager::file_info_t const& info() const { return _info; }
+};
+
+// Shares the mappings between the reads of the same file, and keeps the recently read files mapped
+// so a file read again and again (level streaming) is only mapped once.
+// A cached mapping is checked against the file size, mtime and inode before being reused.
+class mapped_file_cache
+{
+    struct entry_t
+    {
+        std::shared_ptr<mapped_file> file;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    std::mutex _mutex;
+    std::unordered_map<std::string, entry_t> _files;
+    // Most recently used first
+    std::list<std::string> _lru;
+    uint64_t _max_file_size;
+    uint64_t _max_cached_bytes;
+    uint64_t _cached_bytes;
+
+    // _mutex must be held
+    void drop(std::unordered_map<std::string, entry_t>::iterator it);
+
+public:
+    // Mapped but unused files are unmapped past this amount
+    static constexpr uint64_t default_max_cached_bytes = 256 * 1024 * 1024;
+
+    // max_file_size = 0 disables the mappings
+    mapped_file_cache(uint64_t max_file_size, uint64_t max_cached_bytes = default_max_cached_bytes);
+
+    // Returns nullptr when the file must be read with buffered I/O: too big, empty or not mappable
+    std::shared_ptr<mapped_file> acquire(std::string const& file_path);
+    // Call it before the file is written or deleted, the readers still running keep their mapping
+    void invalidate(std::string const& file_path);
+};
@@ -0,0 +1,422 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "md5_multi.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define MD5_MULTI_AVX2
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define MD5_AVX2_TARGET
+    #else
+        // Only the multi-buffer functions are built for AVX2, the rest of the emulator must still run on any cpu
+        #define MD5_AVX2_TARGET __attribute__((target("avx2")))
+    #endif
+#endif
+
+constexpr decltype(md5_multi::lanes) md5_multi::lanes;
+
+// Multiple of the MD5 block size
+static constexpr size_t chunk_size = 64 * 1024;
+static constexpr size_t block_size = 64;
+
+bool md5_multi::simd_available()
+{
+#if defined(MD5_MULTI_AVX2)
+    #if defined(_MSC_VER)
+    static const bool available = []()
+    {
+        int infos[4];
+        __cpuid(infos, 0);
+        if (infos[0] < 7)
+            return false;
+
+        __cpuid(infos, 1);
+        // The OS must save the ymm registers: OSXSAVE + AVX, then XCR0 bits 1 and 2
+        if ((infos[2] & (1 << 27)) == 0 || (infos[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(infos, 7, 0);
+        return (infos[1] & (1 << 5)) != 0;
+    }();
+    #else
+    static const bool available = __builtin_cpu_supports("avx2");
+    #endif
+    return available;
+#else
+    return false;
+#endif
+}
+
+std::string md5_multi::hash_file(std::string const& file_path)
+{
+    std::ifstream in_file = FileManager::open_read(file_path, std::ios::binary);
+    if (!in_file)
+        return std::string();
+
+    std::vector<char> buffer(chunk_size);
+    MD5 hash;
+    while (in_file.read(buffer.data(), buffer.size()) || in_file.gcount() > 0)
+    {
+        hash.update(buffer.data(), static_cast<MD5::size_type>(in_file.gcount()));
+    }
+
+    if (in_file.bad())
+        return std::string();
+
+    return hash.finalize().hexdigest();
+}
+
+#if defined(MD5_MULTI_AVX2)
+
+// Each macro works on the 8 lanes, the round functions are the same as the scalar MD5 ones
+#define MD5X8_F(x, y, z) _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z)))
+#define MD5X8_G(x, y, z) _mm256_xor_si256(y, _mm256_and_si256(z, _mm256_xor_si256(x, y)))
+#define MD5X8_H(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define MD5X8_I(x, y, z) _mm256_xor_si256(y, _mm256_or_si256(x, _mm256_xor_si256(z, ones)))
+
+#define MD5X8_STEP(f, a, b, c, d, x, s, ac) \
+    a = _mm256_add_epi32(a, _mm256_add_epi32(f(b, c, d), _mm256_add_epi32(x, _mm256_set1_epi32(static_cast<int>(ac))))); \
+    a = _mm256_add_epi32(_mm256_or_si256(_mm256_slli_epi32(a, s), _mm256_srli_epi32(a, 32 - (s))), b)
+
+// Transposes 8 rows of 8 words, so w[i] holds the word i of every lane
+MD5_AVX2_TARGET static inline void md5x8_transpose(__m256i r[8], __m256i w[8])
+{
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    w[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    w[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    w[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    w[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    w[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    w[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    w[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    w[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+// Runs blocks MD5 blocks on the 8 lanes. state[i] holds the i-th state word of each lane.
+// A lane with a 0 stride keeps reading the same block, its result must be discarded.
+MD5_AVX2_TARGET static void md5x8_blocks(__m256i state[4], const uint8_t* data[md5_multi::lanes], size_t const stride[md5_multi::lanes], size_t blocks)
+{
+    const __m256i ones = _mm256_set1_epi32(-1);
+    __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+
+    for (; blocks > 0; --blocks)
+    {
+        __m256i rows[8];
+        __m256i x[16];
+
+        for (size_t i = 0; i < md5_multi::lanes; ++i)
+            rows[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data[i]));
+        md5x8_transpose(rows, x);
+
+        for (size_t i = 0; i < md5_multi::lanes; ++i)
+        {
+            rows[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data[i] + 32));
+            data[i] += stride[i];
+        }
+        md5x8_transpose(rows, x + 8);
+
+        __m256i aa = a, bb = b, cc = c, dd = d;
+
+        /* Round 1 */
+        MD5X8_STEP(MD5X8_F, a, b, c, d, x[ 0],  7, 0xd76aa478);
+        MD5X8_STEP(MD5X8_F, d, a, b, c, x[ 1], 12, 0xe8c7b756);
+        MD5X8_STEP(MD5X8_F, c, d, a, b, x[ 2], 17, 0x242070db);
+        MD5X8_STEP(MD5X8_F, b, c, d, a, x[ 3], 22, 0xc1bdceee);
+        MD5X8_STEP(MD5X8_F, a, b, c, d, x[ 4],  7, 0xf57c0faf);
+        MD5X8_STEP(MD5X8_F, d, a, b, c, x[ 5], 12, 0x4787c62a);
+        MD5X8_STEP(MD5X8_F, c, d, a, b, x[ 6], 17, 0xa8304613);
+        MD5X8_STEP(MD5X8_F, b, c, d, a, x[ 7], 22, 0xfd469501);
+        MD5X8_STEP(MD5X8_F, a, b, c, d, x[ 8],  7, 0x698098d8);
+        MD5X8_STEP(MD5X8_F, d, a, b, c, x[ 9], 12, 0x8b44f7af);
+        MD5X8_STEP(MD5X8_F, c, d, a, b, x[10], 17, 0xffff5bb1);
+        MD5X8_STEP(MD5X8_F, b, c, d, a, x[11], 22, 0x895cd7be);
+        MD5X8_STEP(MD5X8_F, a, b, c, d, x[12],  7, 0x6b901122);
+        MD5X8_STEP(MD5X8_F, d, a, b, c, x[13], 12, 0xfd987193);
+        MD5X8_STEP(MD5X8_F, c, d, a, b, x[14], 17, 0xa679438e);
+        MD5X8_STEP(MD5X8_F, b, c, d, a, x[15], 22, 0x49b40821);
+
+        /* Round 2 */
+        MD5X8_STEP(MD5X8_G, a, b, c, d, x[ 1],  5, 0xf61e2562);
+        MD5X8_STEP(MD5X8_G, d, a, b, c, x[ 6],  9, 0xc040b340);
+        MD5X8_STEP(MD5X8_G, c, d, a, b, x[11], 14, 0x265e5a51);
+        MD5X8_STEP(MD5X8_G, b, c, d, a, x[ 0], 20, 0xe9b6c7aa);
+        MD5X8_STEP(MD5X8_G, a, b, c, d, x[ 5],  5, 0xd62f105d);
+        MD5X8_STEP(MD5X8_G, d, a, b, c, x[10],  9, 0x02441453);
+        MD5X8_STEP(MD5X8_G, c, d, a, b, x[15], 14, 0xd8a1e681);
+        MD5X8_STEP(MD5X8_G, b, c, d, a, x[ 4], 20, 0xe7d3fbc8);
+        MD5X8_STEP(MD5X8_G, a, b, c, d, x[ 9],  5, 0x21e1cde6);
+        MD5X8_STEP(MD5X8_G, d, a, b, c, x[14],  9, 0xc33707d6);
+        MD5X8_STEP(MD5X8_G, c, d, a, b, x[ 3], 14, 0xf4d50d87);
+        MD5X8_STEP(MD5X8_G, b, c, d, a, x[ 8], 20, 0x455a14ed);
+        MD5X8_STEP(MD5X8_G, a, b, c, d, x[13],  5, 0xa9e3e905);
+        MD5X8_STEP(MD5X8_G, d, a, b, c, x[ 2],  9, 0xfcefa3f8);
+        MD5X8_STEP(MD5X8_G, c, d, a, b, x[ 7], 14, 0x676f02d9);
+        MD5X8_STEP(MD5X8_G, b, c, d, a, x[12], 20, 0x8d2a4c8a);
+
+        /* Round 3 */
+        MD5X8_STEP(MD5X8_H, a, b, c, d, x[ 5],  4, 0xfffa3942);
+        MD5X8_STEP(MD5X8_H, d, a, b, c, x[ 8], 11, 0x8771f681);
+        MD5X8_STEP(MD5X8_H, c, d, a, b, x[11], 16, 0x6d9d6122);
+        MD5X8_STEP(MD5X8_H, b, c, d, a, x[14], 23, 0xfde5380c);
+        MD5X8_STEP(MD5X8_H, a, b, c, d, x[ 1],  4, 0xa4beea44);
+        MD5X8_STEP(MD5X8_H, d, a, b, c, x[ 4], 11, 0x4bdecfa9);
+        MD5X8_STEP(MD5X8_H, c, d, a, b, x[ 7], 16, 0xf6bb4b60);
+        MD5X8_STEP(MD5X8_H, b, c, d, a, x[10], 23, 0xbebfbc70);
+        MD5X8_STEP(MD5X8_H, a, b, c, d, x[13],  4, 0x289b7ec6);
+        MD5X8_STEP(MD5X8_H, d, a, b, c, x[ 0], 11, 0xeaa127fa);
+        MD5X8_STEP(MD5X8_H, c, d, a, b, x[ 3], 16, 0xd4ef3085);
+        MD5X8_STEP(MD5X8_H, b, c, d, a, x[ 6], 23, 0x04881d05);
+        MD5X8_STEP(MD5X8_H, a, b, c, d, x[ 9],  4, 0xd9d4d039);
+        MD5X8_STEP(MD5X8_H, d, a, b, c, x[12], 11, 0xe6db99e5);
+        MD5X8_STEP(MD5X8_H, c, d, a, b, x[15], 16, 0x1fa27cf8);
+        MD5X8_STEP(MD5X8_H, b, c, d, a, x[ 2], 23, 0xc4ac5665);
+
+        /* Round 4 */
+        MD5X8_STEP(MD5X8_I, a, b, c, d, x[ 0],  6, 0xf4292244);
+        MD5X8_STEP(MD5X8_I, d, a, b, c, x[ 7], 10, 0x432aff97);
+        MD5X8_STEP(MD5X8_I, c, d, a, b, x[14], 15, 0xab9423a7);
+        MD5X8_STEP(MD5X8_I, b, c, d, a, x[ 5], 21, 0xfc93a039);
+        MD5X8_STEP(MD5X8_I, a, b, c, d, x[12],  6, 0x655b59c3);
+        MD5X8_STEP(MD5X8_I, d, a, b, c, x[ 3], 10, 0x8f0ccc92);
+        MD5X8_STEP(MD5X8_I, c, d, a, b, x[10], 15, 0xffeff47d);
+        MD5X8_STEP(MD5X8_I, b, c, d, a, x[ 1], 21, 0x85845dd1);
+        MD5X8_STEP(MD5X8_I, a, b, c, d, x[ 8],  6, 0x6fa87e4f);
+        MD5X8_STEP(MD5X8_I, d, a, b, c, x[15], 10, 0xfe2ce6e0);
+        MD5X8_STEP(MD5X8_I, c, d, a, b, x[ 6], 15, 0xa3014314);
+        MD5X8_STEP(MD5X8_I, b, c, d, a, x[13], 21, 0x4e0811a1);
+        MD5X8_STEP(MD5X8_I, a, b, c, d, x[ 4],  6, 0xf7537e82);
+        MD5X8_STEP(MD5X8_I, d, a, b, c, x[11], 10, 0xbd3af235);
+        MD5X8_STEP(MD5X8_I, c, d, a, b, x[ 2], 15, 0x2ad7d2bb);
+        MD5X8_STEP(MD5X8_I, b, c, d, a, x[ 9], 21, 0xeb86d391);
+
+        a = _mm256_add_epi32(a, aa);
+        b = _mm256_add_epi32(b, bb);
+        c = _mm256_add_epi32(c, cc);
+        d = _mm256_add_epi32(d, dd);
+    }
+
+    state[0] = a;
+    state[1] = b;
+    state[2] = c;
+    state[3] = d;
+}
+
+#undef MD5X8_STEP
+#undef MD5X8_I
+#undef MD5X8_H
+#undef MD5X8_G
+#undef MD5X8_F
+
+struct md5_lane_t
+{
+    std::ifstream file;
+    size_t file_index;
+    bool active;
+    // The padding was appended, the digest is ready once the remaining blocks are done
+    bool last;
+    uint64_t length;
+    const uint8_t* data;
+    size_t blocks;
+    // A chunk and up to 2 blocks of padding
+    std::vector<uint8_t> buffer;
+
+    md5_lane_t():
+        file_index(0),
+        active(false),
+        last(false),
+        length(0),
+        data(nullptr),
+        blocks(0),
+        buffer(chunk_size + 2 * block_size)
+    {}
+
+    // Reads the next chunk, pads the message when the end of the file is reached
+    bool refill()
+    {
+        file.read(reinterpret_cast<char*>(buffer.data()), chunk_size);
+        if (file.bad())
+            return false;
+
+        size_t read_len = static_cast<size_t>(file.gcount());
+        length += read_len;
+        data = buffer.data();
+        blocks = read_len / block_size;
+
+        if (read_len == chunk_size)
+            return true;
+
+        size_t tail = read_len % block_size;
+        uint8_t* padding = buffer.data() + blocks * block_size;
+        size_t padding_len = (tail < 56 ? block_size : 2 * block_size);
+        memset(padding + tail, 0, padding_len - tail);
+        padding[tail] = 0x80;
+
+        uint64_t bits = length * 8;
+        for (size_t i = 0; i < 8; ++i)
+            padding[padding_len - 8 + i] = static_cast<uint8_t>(bits >> (8 * i));
+
+        blocks += padding_len / block_size;
+        last = true;
+        return true;
+    }
+};
+
+MD5_AVX2_TARGET static std::vector<std::string> hash_files_avx2(std::vector<std::string> const& file_paths)
+{
+    static const uint8_t idle_block[block_size] = {};
+    static const char hex_chars[] = "0123456789abcdef";
+
+    std::vector<std::string> results(file_paths.size());
+    md5_lane_t lanes[md5_multi::lanes];
+    alignas(32) uint32_t state[4][md5_multi::lanes];
+    size_t next_file = 0;
+
+    // Opens the next readable file in the lane, the lane becomes idle when there is no file left
+    auto start_lane = [&](size_t lane_index)
+    {
+        md5_lane_t& lane = lanes[lane_index];
+        lane.active = false;
+        while (next_file < file_paths.size())
+        {
+            size_t file_index = next_file++;
+            lane.file = FileManager::open_read(file_paths[file_index], std::ios::binary);
+            if (!lane.file)
+                continue;
+
+            lane.file_index = file_index;
+            lane.active = true;
+            lane.last = false;
+            lane.length = 0;
+            lane.blocks = 0;
+            state[0][lane_index] = 0x67452301;
+            state[1][lane_index] = 0xefcdab89;
+            state[2][lane_index] = 0x98badcfe;
+            state[3][lane_index] = 0x10325476;
+            break;
+        }
+    };
+
+    for (size_t i = 0; i < md5_multi::lanes; ++i)
+        start_lane(i);
+
+    for (;;)
+    {
+        size_t blocks = std::numeric_limits<size_t>::max();
+        const uint8_t* data[md5_multi::lanes];
+        size_t stride[md5_multi::lanes];
+
+        for (size_t i = 0; i < md5_multi::lanes; ++i)
+        {
+            md5_lane_t& lane = lanes[i];
+            while (lane.active && lane.blocks == 0)
+            {
+                if (lane.last)
+                {// MD5 digest is the state words in little endian
+                    std::string& digest = results[lane.file_index];
+                    digest.reserve(32);
+                    for (size_t word = 0; word < 4; ++word)
+                    {
+                        for (size_t byte = 0; byte < 4; ++byte)
+                        {
+                            uint8_t v = static_cast<uint8_t>(state[word][i] >> (8 * byte));
+                            digest += hex_chars[v >> 4];
+                            digest += hex_chars[v & 0x0f];
+                        }
+                    }
+                    start_lane(i);
+                }
+                else if (!lane.refill())
+                {
+                    start_lane(i);
+                }
+            }
+
+            if (lane.active)
+            {
+                blocks = std::min(blocks, lane.blocks);
+                data[i] = lane.data;
+                stride[i] = block_size;
+            }
+            else
+            {
+                data[i] = idle_block;
+                stride[i] = 0;
+            }
+        }
+
+        if (blocks == std::numeric_limits<size_t>::max())
+            break;
+
+        __m256i vstate[4];
+        for (size_t i = 0; i < 4; ++i)
+            vstate[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[i]));
+
+        md5x8_blocks(vstate, data, stride, blocks);
+
+        for (size_t i = 0; i < 4; ++i)
+            _mm256_store_si256(reinterpret_cast<__m256i*>(state[i]), vstate[i]);
+
+        for (auto& lane : lanes)
+        {
+            if (lane.active)
+            {
+                lane.data += blocks * block_size;
+                lane.blocks -= blocks;
+            }
+        }
+    }
+
+    return results;
+}
+
+#endif
+
+std::vector<std::string> md5_multi::hash_files(std::vector<std::string> const& file_paths)
+{
+#if defined(MD5_MULTI_AVX2)
+    if (file_paths.size() > 1 && simd_available())
+        return hash_files_avx2(file_paths);
+#endif
+
+    std::vector<std::string> results;
+    results.reserve(file_paths.size());
+    for (auto const& file_path : file_paths)
+        results.emplace_back(hash_file(file_path));
+
+    return results;
+}
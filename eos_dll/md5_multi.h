@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+
+// Multi-buffer MD5: hashes up to 8 independent files at once, one file per AVX2 lane.
+// MD5 can't be vectorized inside a single message, but a directory scan has plenty of messages.
+// The scalar MD5 class stays the reference implementation and is used when AVX2 isn't available.
+class md5_multi
+{
+public:
+    static constexpr size_t lanes = 8;
+
+    // True if both the build and the cpu can run the AVX2 path
+    static bool simd_available();
+
+    // Streams a single file through the scalar MD5, returns an empty string if it couldn't be read
+    static std::string hash_file(std::string const& file_path);
+    // Result i is the hexdigest of file_paths[i], or an empty string if it couldn't be read
+    static std::vector<std::string> hash_files(std::vector<std::string> const& file_paths);
+};
@@ -18,20 +18,96 @@
  */
 
 #include "network.h"
+#include "settings.h"
 
 using namespace PortableAPI;
 
+// Only canonical non null ids have a binary form, the other ones stay strings
+static bool encode_binary_id(std::string const& id, uint64_t& high, uint64_t& low)
+{
+    id128_t binary_id;
+    if (!id128_t::parse(id.c_str(), id.length(), binary_id) || (binary_id.high == 0 && binary_id.low == 0))
+        return false;
+
+    high = binary_id.high;
+    low = binary_id.low;
+    return true;
+}
+
+// Moves the ids of a message to their binary fields for the time it is serialized
+class binary_ids_scope
+{
+    Network_Message_pb& _msg;
+    std::string _source_id;
+    std::string _dest_id;
+
+public:
+    binary_ids_scope(Network_Message_pb& msg, bool source, bool dest):
+        _msg(msg)
+    {
+        uint64_t high, low;
+        if (source && encode_binary_id(_msg.source_id(), high, low))
+        {
+            _msg.mutable_source_id()->swap(_source_id);
+            _msg.set_source_id_high(high);
+            _msg.set_source_id_low(low);
+        }
+        if (dest && encode_binary_id(_msg.dest_id(), high, low))
+        {
+            _msg.mutable_dest_id()->swap(_dest_id);
+            _msg.set_dest_id_high(high);
+            _msg.set_dest_id_low(low);
+        }
+    }
+
+    ~binary_ids_scope()
+    {
+        if (!_source_id.empty())
+        {
+            _msg.mutable_source_id()->swap(_source_id);
+            _msg.clear_source_id_high();
+            _msg.clear_source_id_low();
+        }
+        if (!_dest_id.empty())
+        {
+            _msg.mutable_dest_id()->swap(_dest_id);
+            _msg.clear_dest_id_high();
+            _msg.clear_dest_id_low();
+        }
+    }
+};
+
 Network::Network():
     _advertise(false),
     _advertise_rate(2000),
-    _tcp_port(0)
+    _tcp_port(0),
+    _reactor(Network_Reactor::create()),
+    _udp_recv_buffer(max_udp_message_size * udp_recv_batch_size),
+    _next_udp_message_id(0),
+    _udp_reassembly_size(0)
 {
+    for (size_t i = 0; i < udp_recv_batch_size; ++i)
+        _udp_recv_messages[i] = { &_udp_recv_addrs[i], &_udp_recv_buffer[i * max_udp_message_size], max_udp_message_size, 0 };
+
     //APP_LOG(Log::LogLevel::DEBUG, "");
 #if defined(NETWORK_COMPRESS)
     max_message_size = 0;
     max_compressed_message_size = 0;
+    _compress_min_size = Settings::Inst().network_compress_min_size;
     _zstd_ccontext = ZSTD_createCCtx();
     _zstd_dstream = ZSTD_createDStream();
+    _zstd_cdict = nullptr;
+    _zstd_ddict = nullptr;
+
+    if (!Settings::Inst().network_compress_dictionary.empty())
+        load_compression_dictionary(Settings::Inst().network_compress_dictionary);
+
+    if (!Settings::Inst().network_capture_file.empty())
+    {
+        _capture_file = FileManager::open_write(Settings::Inst().network_capture_file, std::ios::binary | std::ios::app);
+        if (!_capture_file)
+            APP_LOG(Log::LogLevel::WARN, "Failed to open network capture file %s", Settings::Inst().network_capture_file.c_str());
+    }
 #endif
 
     _network_task.run(&Network::network_thread, this);
@@ -51,6 +127,8 @@ Network::~Network()
 #if defined(NETWORK_COMPRESS)
     ZSTD_freeCCtx(_zstd_ccontext);
     ZSTD_freeDStream(_zstd_dstream);
+    ZSTD_freeCDict(_zstd_cdict);
+    ZSTD_freeDDict(_zstd_ddict);
 #endif
 
     //APP_LOG(Log::LogLevel::DEBUG, "Network Thread Joined");
@@ -58,46 +136,177 @@ Network::~Network()
 
 #if defined(NETWORK_COMPRESS)
 
+void Network::load_compression_dictionary(std::string const& path)
+{
+    std::ifstream file = FileManager::open_read(path, std::ios::binary);
+    std::string dict((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (dict.empty())
+    {
+        APP_LOG(Log::LogLevel::WARN, "Failed to load network compression dictionary %s, compressing without it", path.c_str());
+        return;
+    }
+
+    _zstd_cdict = ZSTD_createCDict(dict.data(), dict.length(), ZSTD_CLEVEL_DEFAULT);
+    _zstd_ddict = ZSTD_createDDict(dict.data(), dict.length());
+    if (_zstd_cdict == nullptr || _zstd_ddict == nullptr)
+    {
+        APP_LOG(Log::LogLevel::WARN, "Invalid network compression dictionary %s, compressing without it", path.c_str());
+        ZSTD_freeCDict(_zstd_cdict);
+        ZSTD_freeDDict(_zstd_ddict);
+        _zstd_cdict = nullptr;
+        _zstd_ddict = nullptr;
+        return;
+    }
+
+    // Peers must use the same dictionary, its id is written in every zstd frame so a mismatch is detected
+    APP_LOG(Log::LogLevel::INFO, "Loaded network compression dictionary %s, id %u", path.c_str(), ZSTD_getDictID_fromDDict(_zstd_ddict));
+}
+
 std::string Network::compress(void const* data, size_t len)
 {
-    std::string res(ZSTD_compressBound(len), '\0');
-    res.resize(ZSTD_compressCCtx(_zstd_ccontext, &res[0], res.length(), data, len, ZSTD_CLEVEL_DEFAULT));
+    if (_capture_file.is_open())
+    {// <big endian uint32 size><message>, what tools/train_network_dictionary.cpp reads
+        std::lock_guard<std::mutex> lk(_compress_mutex);
+        uint32_t sample_size = utils::Endian::net_swap(static_cast<uint32_t>(len));
+        _capture_file.write(reinterpret_cast<char const*>(&sample_size), sizeof(sample_size));
+        _capture_file.write(reinterpret_cast<char const*>(data), len);
+    }
+
+    if (len < _compress_min_size)
+        return compress(data, len, frame_flags::none);
+
+    std::string res(compress(data, len, _zstd_cdict == nullptr ? frame_flags::compressed : (frame_flags::compressed | frame_flags::dictionary)));
+    if (res.length() > (len + frame_flags_size))
+        return compress(data, len, frame_flags::none);
+
+    return res;
+}
+
+std::string Network::compress(void const* data, size_t len, uint8_t flags)
+{
+    std::string res;
+
+    if (!(flags & frame_flags::compressed))
+    {
+        res.reserve(frame_flags_size + len);
+        res.push_back(static_cast<char>(flags));
+        res.append(reinterpret_cast<char const*>(data), len);
+        return res;
+    }
+
+    std::lock_guard<std::mutex> lk(_compress_mutex);
+    res.resize(frame_flags_size + ZSTD_compressBound(len));
+    res[0] = static_cast<char>(flags);
+
+    size_t compressed_size;
+    if (flags & frame_flags::dictionary)
+        compressed_size = ZSTD_compress_usingCDict(_zstd_ccontext, &res[frame_flags_size], res.length() - frame_flags_size, data, len, _zstd_cdict);
+    else
+        compressed_size = ZSTD_compressCCtx(_zstd_ccontext, &res[frame_flags_size], res.length() - frame_flags_size, data, len, ZSTD_CLEVEL_DEFAULT);
+
+    if (ZSTD_isError(compressed_size))
+    {// Can't happen with a ZSTD_compressBound sized buffer, but never send garbage
+        APP_LOG(Log::LogLevel::WARN, "Compression error: %s", ZSTD_getErrorName(compressed_size));
+        res.resize(frame_flags_size);
+        res[0] = static_cast<char>(frame_flags::none);
+        res.append(reinterpret_cast<char const*>(data), len);
+        return res;
+    }
+
+    res.resize(frame_flags_size + compressed_size);
+    return res;
+}
+
+std::string Network::compress_for_peer(void const* data, size_t len, uint32_t peer_protocol_version)
+{
+    if (peer_protocol_version >= frame_flags_protocol_version)
+        return compress(data, len);
+
+    std::string res(compress(data, len, frame_flags::compressed));
+    res.erase(0, frame_flags_size);
     return res;
 }
 
-std::string Network::decompress(void const* data, size_t len)
+bool Network::decompress(void const*& data, size_t& len)
 {
-    static size_t decompress_block_size = ZSTD_DStreamOutSize();
-    static std::string res;
+    if (len < frame_flags_size)
+        return false;
+
+    // ZSTD_MAGICNUMBER as it starts a frame, its first byte is not a valid flags byte
+    static constexpr uint8_t zstd_frame_magic[] = { 0x28, 0xB5, 0x2F, 0xFD };
 
-    res.resize(decompress_block_size);
-    ZSTD_inBuffer inbuff{ data, len, 0 };
-    ZSTD_outBuffer outbuff{ const_cast<char*>(res.data()), res.length(), 0 };
+    uint8_t flags = *reinterpret_cast<uint8_t const*>(data);
+    ZSTD_inBuffer inbuff{ reinterpret_cast<uint8_t const*>(data) + frame_flags_size, len - frame_flags_size, 0 };
 
-    while (inbuff.pos < inbuff.size)
+    if (len >= sizeof(zstd_frame_magic) && memcmp(data, zstd_frame_magic, sizeof(zstd_frame_magic)) == 0)
+    {// Bare zstd frame from a peer before frame_flags_protocol_version
+        flags = frame_flags::compressed;
+        inbuff = ZSTD_inBuffer{ data, len, 0 };
+    }
+
+    if (flags & ~(frame_flags::compressed | frame_flags::dictionary))
     {
-        size_t x = 0;
-        x = ZSTD_decompressStream(_zstd_dstream, &outbuff, &inbuff);
-        if (ZSTD_isError(x))
+        APP_LOG(Log::LogLevel::WARN, "Decompression error: unknown frame flags %02x", flags);
+        return false;
+    }
+
+    if (!(flags & frame_flags::compressed))
+    {
+        data = inbuff.src;
+        len = inbuff.size;
+        return true;
+    }
+
+    if ((flags & frame_flags::dictionary) && _zstd_ddict == nullptr)
+    {
+        APP_LOG(Log::LogLevel::WARN, "Decompression error: the frame needs a dictionary, set network_compress_dictionary");
+        return false;
+    }
+
+    ZSTD_DCtx_reset(_zstd_dstream, ZSTD_reset_session_only);
+    ZSTD_DCtx_refDDict(_zstd_dstream, (flags & frame_flags::dictionary) ? _zstd_ddict : nullptr);
+
+    _decompress_buffer.resize(std::max(_decompress_buffer.capacity(), ZSTD_DStreamOutSize()));
+    ZSTD_outBuffer outbuff{ &_decompress_buffer[0], _decompress_buffer.length(), 0 };
+
+    size_t res;
+    for (;;)
+    {
+        // Concatenated zstd frames are decompressed as a single stream
+        res = ZSTD_decompressStream(_zstd_dstream, &outbuff, &inbuff);
+        if (ZSTD_isError(res))
         {
-            if (x == size_t(-70))
-            {
-                res.resize(res.length() + decompress_block_size);
-                outbuff.size = res.length();
-                outbuff.dst = const_cast<char*>(res.data());
-            }
-            else
+            APP_LOG(Log::LogLevel::WARN, "Decompression error: %s", ZSTD_getErrorName(res));
+            return false;
+        }
+
+        // zstd flushes everything it can while there is room left in the output
+        if (inbuff.pos == inbuff.size && outbuff.pos < outbuff.size)
+            break;
+
+        if (outbuff.pos == outbuff.size)
+        {
+            if (_decompress_buffer.length() >= max_decompressed_size)
             {
-                auto str_error = ZSTD_getErrorName(x);
-                APP_LOG(Log::LogLevel::WARN, "Decompression error: %s", str_error);
-                return std::string((char*)data, ((char*)data) + len);
+                APP_LOG(Log::LogLevel::WARN, "Decompression error: message is bigger than %llu bytes", (unsigned long long)max_decompressed_size);
+                return false;
             }
+
+            _decompress_buffer.resize(std::min(_decompress_buffer.length() * 2, max_decompressed_size));
+            outbuff.dst = &_decompress_buffer[0];
+            outbuff.size = _decompress_buffer.length();
         }
     }
 
-    ZSTD_initDStream(_zstd_dstream);
-    res.resize(outbuff.pos);
-    return res;
+    if (res != 0)
+    {
+        APP_LOG(Log::LogLevel::WARN, "Decompression error: truncated frame");
+        return false;
+    }
+
+    data = _decompress_buffer.data();
+    len = outbuff.pos;
+    return true;
 }
 
 #endif
@@ -141,7 +350,7 @@ void Network::start_network()
                 addr.set_loopback_addr();
                 _tcp_self_send.connect(addr);
                 _tcp_self_recv.socket = std::move(_tcp_socket.accept());
-                _tcp_self_recv.buffer.reserve(1024 * 10);
+                _tcp_self_recv.buffer.reserve(1024 * 64);
                 break;
             }
             catch (...)
@@ -168,6 +377,8 @@ void Network::stop_network()
     _advertise = false;
     _udp_socket.close();
     _tcp_socket.close();
+    _reactor->clear();
+    _tcp_clients_by_socket.clear();
     _tcp_clients.clear();
     _network_msgs.clear();
     _udp_addrs.clear();
@@ -191,6 +402,7 @@ void Network::build_advertise_msg(Network_Message_pb& msg)
         APP_LOG(Log::LogLevel::DEBUG, "%s", id.c_str());
         peer_pb->add_peer_ids(id);
     }
+    peer_pb->set_protocol_version(protocol_version);
 
     advertise->set_allocated_peer(peer_pb);
     msg.set_allocated_network_advertise(advertise);
@@ -266,13 +478,23 @@ std::chrono::milliseconds Network::get_advertise_rate()
     return _advertise_rate;
 }
 
-void Network::add_new_tcp_client(PortableAPI::tcp_socket* cli, std::vector<peer_t> const& peer_ids, bool advertise_peer)
+void Network::add_new_tcp_client(PortableAPI::tcp_socket* cli, std::vector<peer_t> const& peer_ids, uint32_t peer_protocol_version, bool advertise_peer)
 {
     std::lock_guard<std::recursive_mutex> lk(local_mutex);
 
-    FD_SET(cli->get_native_socket(), &readfds);
-
-    FD_SET(cli->get_native_socket(), &exceptfds);
+    auto native_socket = cli->get_native_socket();
+    if (_tcp_clients_by_socket.count(native_socket) == 0)
+    {// New client, index it so the reactor events can be dispatched to it
+        auto it = std::find_if(_tcp_clients.begin(), _tcp_clients.end(), [cli](tcp_buffer_t const& client)
+        {
+            return &client.socket == cli;
+        });
+        if (it != _tcp_clients.end())
+        {
+            _tcp_clients_by_socket[native_socket] = it;
+            _reactor->add_socket(native_socket);
+        }
+    }
 
     Network_Message_pb msg;
     Network_Advertise_pb adv;
@@ -285,6 +507,8 @@ void Network::add_new_tcp_client(PortableAPI::tcp_socket* cli, std::vector<peer_
     {// Map all clients peerids to the socket
         APP_LOG(Log::LogLevel::DEBUG, "Adding peer id %s to client %s", peerid.c_str(), cli->get_addr().to_string(true).c_str());
         _tcp_peers[peerid] = cli;
+        // Older builds don't send their version
+        _peer_protocol_versions[peerid] = std::min(protocol_version, std::max<uint32_t>(peer_protocol_version, 1));
 
         msg.set_source_id(peerid);
 
@@ -305,11 +529,12 @@ void Network::add_new_tcp_client(PortableAPI::tcp_socket* cli, std::vector<peer_
         Network_Advertise_pb* adv = new Network_Advertise_pb;
         Network_Peer_Accept_pb* accept_peer = new Network_Peer_Accept_pb;
 
+        accept_peer->set_protocol_version(protocol_version);
         adv->set_allocated_accept(accept_peer);
         msg.set_allocated_network_advertise(adv);
 
         std::string buff(sizeof(next_packet_size_t), 0);
-        // Don't compress the accept message, its only 4 bytes long
+        // Don't compress the accept message, its only a few bytes long
     //#if defined(NETWORK_COMPRESS)
     //    std::string data;
     //    msg.SerializeToString(&data);
@@ -333,8 +558,6 @@ void Network::remove_tcp_peer(tcp_buffer_t& tcp_buffer)
 
     APP_LOG(Log::LogLevel::DEBUG, "TCP Client %s gone", tcp_buffer.socket.get_addr().to_string().c_str());
 
-    FD_CLR(tcp_buffer.socket.get_native_socket(), &exceptfds);
-
     // Remove the peer mappings
 
     Network_Message_pb msg;
@@ -349,6 +572,7 @@ void Network::remove_tcp_peer(tcp_buffer_t& tcp_buffer)
         if (it->second == &(tcp_buffer.socket))
         {
             msg.set_source_id(it->first);
+            _peer_protocol_versions.erase(it->first);
             it = _tcp_peers.erase(it);
 
             for (auto& channel : _default_channels)
@@ -364,6 +588,60 @@ void Network::remove_tcp_peer(tcp_buffer_t& tcp_buffer)
     msg.release_network_advertise();
 }
 
+void Network::remove_tcp_client(std::list<tcp_buffer_t>::iterator client)
+{
+    std::lock_guard<std::recursive_mutex> lk(local_mutex);
+
+    auto native_socket = client->socket.get_native_socket();
+    _reactor->remove_socket(native_socket);
+    _tcp_clients_by_socket.erase(native_socket);
+
+    remove_tcp_peer(*client);
+    _tcp_clients.erase(client);
+}
+
+Network::tcp_buffer_t* Network::find_waiting_tcp_client(Network_Reactor::socket_t native_socket)
+{
+    for (auto& client : _waiting_in_tcp_clients)
+    {
+        if (client.socket.get_native_socket() == native_socket)
+            return &client;
+    }
+
+    for (auto& client : _waiting_out_tcp_clients)
+    {
+        if (client.second.socket.get_native_socket() == native_socket)
+            return &client.second;
+    }
+
+    return nullptr;
+}
+
+void Network::remove_waiting_tcp_client(Network_Reactor::socket_t native_socket)
+{
+    _reactor->remove_socket(native_socket);
+
+    auto in_it = std::find_if(_waiting_in_tcp_clients.begin(), _waiting_in_tcp_clients.end(), [native_socket](tcp_buffer_t& client)
+    {
+        return client.socket.get_native_socket() == native_socket;
+    });
+    if (in_it != _waiting_in_tcp_clients.end())
+    {
+        _waiting_in_tcp_clients.erase(in_it);
+        return;
+    }
+
+    auto out_it = std::find_if(_waiting_out_tcp_clients.begin(), _waiting_out_tcp_clients.end(), [native_socket](std::pair<peer_t const, tcp_buffer_t>& client)
+    {
+        return client.second.socket.get_native_socket() == native_socket;
+    });
+    if (out_it != _waiting_out_tcp_clients.end())
+    {
+        APP_LOG(Log::LogLevel::DEBUG, "Peer %s closed the connection before pairing", out_it->first.c_str());
+        _waiting_out_tcp_clients.erase(out_it);
+    }
+}
+
 void Network::connect_to_peer(ipv4_addr &addr, peer_t const& peer_id)
 {
     if (_waiting_out_tcp_clients.count(peer_id) != 0)
@@ -408,7 +686,8 @@ void Network::connect_to_peer(ipv4_addr &addr, peer_t const& peer_id)
     #if defined(NETWORK_COMPRESS)
         std::string data;
         msg.SerializeToString(&data);
-        buff += std::move(compress(data.data(), data.length()));
+        // The peer protocol version is known once paired
+        buff += std::move(compress_for_peer(data.data(), data.length(), get_peer_protocol_version(peer_id)));
 
         max_message_size = std::max<uint64_t>(max_message_size, data.length());
         max_compressed_message_size = std::max<uint64_t>(max_compressed_message_size, buff.length());
@@ -423,6 +702,9 @@ void Network::connect_to_peer(ipv4_addr &addr, peer_t const& peer_id)
 
         tcp_buffer_t tcp_buffer{};
         tcp_buffer.socket = std::move(it->second);
+        tcp_buffer.waiting_since = std::chrono::steady_clock::now();
+        // Wake up the network thread as soon as the peer answers
+        _reactor->add_socket(tcp_buffer.socket.get_native_socket());
         _waiting_out_tcp_clients.emplace(peer_id, std::move(tcp_buffer));
         _waiting_connect_tcp_clients.erase(it);
     }
@@ -433,139 +715,164 @@ void Network::process_waiting_out_clients()
     if (_waiting_out_tcp_clients.empty())
         return;
 
+    auto now = std::chrono::steady_clock::now();
     Network_Message_pb msg;
     for (auto it = _waiting_out_tcp_clients.begin(); it != _waiting_out_tcp_clients.end(); )
     {
-        try
+        // The bytes were drained in the buffer by the network thread, wait for the whole accept frame
+        bool accepted = false;
+        size_t frames = split_frames(it->second.buffer, it->second.next_packet_size, [&msg, &accepted](uint8_t const* data, size_t size)
         {
-            unsigned long count = 0;
-            it->second.socket.ioctlsocket(Socket::cmd_name::fionread, &count);
-            if (count > 0)
-            {
-                if (it->second.next_packet_size == 0 && count > sizeof(next_packet_size_t))
-                {
-                    it->second.socket.recv(&it->second.next_packet_size, sizeof(next_packet_size_t));
-                    it->second.next_packet_size = utils::Endian::net_swap(it->second.next_packet_size);
-                    count -= sizeof(next_packet_size_t);
-                }
-                if (it->second.next_packet_size > 0 && count >= it->second.next_packet_size)
-                {
-                    it->second.buffer.resize(it->second.next_packet_size);
-                    it->second.socket.recv(it->second.buffer.data(), it->second.next_packet_size);
-
-                    const void* message;
-                    int message_size;
-
-                    // Don't compress the accept message, its only 4 bytes long
-                //#if defined(NETWORK_COMPRESS)
-                //    std::string buff = std::move(decompress(it->second.buffer.data(), it->second.buffer.size()));
-                //    message = buff.data();
-                //    message_size = buff.length();
-                //#else
-                    message = it->second.buffer.data();
-                    message_size = it->second.buffer.size();
-                //#endif
-                    
-                    if (msg.ParseFromArray(message, message_size) &&
-                        msg.has_network_advertise() && 
-                        msg.network_advertise().has_accept())
-                    {
-                        std::lock_guard<std::recursive_mutex> lk(local_mutex);
-
-                        it->second.next_packet_size = 0;
-                        it->second.buffer.clear();
-                        it->second.socket.set_nonblocking(false);
+            // Don't compress the accept message, its only 4 bytes long
+            accepted = (msg.ParseFromArray(data, static_cast<int>(size)) &&
+                msg.has_network_advertise() &&
+                msg.network_advertise().has_accept());
+        }, 1);
 
-                        _tcp_clients.emplace_back(std::move(it->second));
-                        add_new_tcp_client(&(_tcp_clients.rbegin()->socket), std::vector<peer_t>{it->first}, false);
-                    }
-                    it = _waiting_out_tcp_clients.erase(it);
-                    continue;
-                }
+        if (frames == 0)
+        {
+            if ((now - it->second.waiting_since) > waiting_client_timeout)
+            {
+                APP_LOG(Log::LogLevel::WARN, "Failed peer pair: %s didn't accept in time", it->first.c_str());
+                _reactor->remove_socket(it->second.socket.get_native_socket());
+                it = _waiting_out_tcp_clients.erase(it);
+                continue;
             }
-            
+
             ++it;
+            continue;
         }
-        catch (std::exception &e)
+
+        if (accepted)
         {
-            // Error while reading, connection closed ?
-            APP_LOG(Log::LogLevel::WARN, "Failed peer pair: %s", e.what());
-            it = _waiting_out_tcp_clients.erase(it);
+            std::lock_guard<std::recursive_mutex> lk(local_mutex);
+
+            it->second.socket.set_nonblocking(false);
+
+            _tcp_clients.emplace_back(std::move(it->second));
+            add_new_tcp_client(&(_tcp_clients.rbegin()->socket), std::vector<peer_t>{it->first}, msg.network_advertise().accept().protocol_version(), false);
+            // The peer might have sent more messages right after the accept
+            process_tcp_frames(*_tcp_clients.rbegin());
         }
+        else
+        {
+            _reactor->remove_socket(it->second.socket.get_native_socket());
+        }
+        it = _waiting_out_tcp_clients.erase(it);
     }
 }
 
 void Network::process_waiting_in_client()
 {
+    auto now = std::chrono::steady_clock::now();
     Network_Message_pb msg;
     for (auto it = _waiting_in_tcp_clients.begin(); it != _waiting_in_tcp_clients.end(); )
     {
-        try
+        // The bytes were drained in the buffer by the network thread, wait for the whole peer frame
+        bool has_peer = false;
+        size_t frames = split_frames(it->buffer, it->next_packet_size, [this, &msg, &has_peer](uint8_t const* data, size_t size)
+        {
+            has_peer = (parse_message(data, size, msg) &&
+                msg.has_network_advertise() &&
+                msg.network_advertise().has_peer());
+        }, 1);
+
+        if (frames == 0)
         {
-            unsigned long count = 0;
-            it->socket.ioctlsocket(Socket::cmd_name::fionread, &count);
-            if (count > 0)
+            if ((now - it->waiting_since) > waiting_client_timeout)
             {
-                if (it->next_packet_size == 0 && count > sizeof(next_packet_size_t))
-                {
-                    it->socket.recv(&it->next_packet_size, sizeof(next_packet_size_t));
-                    it->next_packet_size = utils::Endian::net_swap(it->next_packet_size);
-                    count -= sizeof(next_packet_size_t);
-                }
-                if (it->next_packet_size > 0 && count >= it->next_packet_size)
-                {
-                    it->buffer.resize(it->next_packet_size);
-                    it->socket.recv(it->buffer.data(), it->next_packet_size);
-
-                    const void* message;
-                    int message_size;
-
-                #if defined(NETWORK_COMPRESS)
-                    std::string buff = std::move(decompress(it->buffer.data(), it->next_packet_size));
-                    message = buff.data();
-                    message_size = buff.length();
-                #else
-                    message = it->buffer.data();
-                    message_size = it->buffer.size();
-                #endif
-                    
-                    if (msg.ParseFromArray(message, message_size) &&
-                        msg.has_network_advertise() && 
-                        msg.network_advertise().has_peer())
-                    {
-                        std::lock_guard<std::recursive_mutex> lk(local_mutex);
-
-                        it->next_packet_size = 0;
-                        it->buffer.clear();
-                        it->socket.set_nonblocking(false);
-
-                        auto const& peer_msg = msg.network_advertise().peer();
-                        std::pair<tcp_socket*, std::vector<peer_t>> peer_ids_to_add = std::move(get_new_peer_ids(peer_msg));
-
-                        if (!peer_ids_to_add.second.empty())
-                        {// We have peer ids to add
-                            if (peer_ids_to_add.first == nullptr)
-                            {// Didn't find a matching peer id, its a new peer
-                                _tcp_clients.emplace_back(std::move(*it));
-                                peer_ids_to_add.first = &(_tcp_clients.rbegin()->socket);
-                            }
-                            add_new_tcp_client(peer_ids_to_add.first, peer_ids_to_add.second, true);
-                        }
-                    }
-                    it = _waiting_in_tcp_clients.erase(it);
-                    continue;
-                }
+                APP_LOG(Log::LogLevel::WARN, "Failed peer pair: %s didn't send its ids in time", it->socket.get_addr().to_string(true).c_str());
+                _reactor->remove_socket(it->socket.get_native_socket());
+                it = _waiting_in_tcp_clients.erase(it);
+                continue;
             }
-            
+
             ++it;
+            continue;
         }
-        catch (std::exception &e)
+
+        bool moved_to_clients = false;
+        if (has_peer)
         {
-            // Error while reading, connection closed ?
-            APP_LOG(Log::LogLevel::WARN, "Failed peer pair: %s", e.what());
-            it = _waiting_in_tcp_clients.erase(it);
+            std::lock_guard<std::recursive_mutex> lk(local_mutex);
+
+            it->socket.set_nonblocking(false);
+
+            auto const& peer_msg = msg.network_advertise().peer();
+            std::pair<tcp_socket*, std::vector<peer_t>> peer_ids_to_add = std::move(get_new_peer_ids(peer_msg));
+
+            if (!peer_ids_to_add.second.empty())
+            {// We have peer ids to add
+                if (peer_ids_to_add.first == nullptr)
+                {// Didn't find a matching peer id, its a new peer
+                    _tcp_clients.emplace_back(std::move(*it));
+                    peer_ids_to_add.first = &(_tcp_clients.rbegin()->socket);
+                    moved_to_clients = true;
+                }
+                add_new_tcp_client(peer_ids_to_add.first, peer_ids_to_add.second, peer_msg.protocol_version(), true);
+                if (moved_to_clients)
+                {// The peer might have sent more messages right after its ids
+                    process_tcp_frames(*_tcp_clients.rbegin());
+                }
+            }
         }
+        if (!moved_to_clients)
+        {// The socket has not been moved to the clients list, it will be closed
+            _reactor->remove_socket(it->socket.get_native_socket());
+        }
+        it = _waiting_in_tcp_clients.erase(it);
+    }
+}
+
+void Network::serialize_message_body(Network_Message_pb& msg, uint32_t peer_protocol_version, std::string& body)
+{
+    bool binary_ids = peer_protocol_version >= binary_ids_protocol_version;
+
+    // Parsing concatenated protobuf messages merges them, so the per peer fields are left to the header
+    msg.clear_dest_id();
+    msg.clear_timestamp();
+    {
+        binary_ids_scope ids(msg, binary_ids, false);
+        msg.SerializeToString(&body);
+    }
+
+#if defined(NETWORK_COMPRESS)
+    max_message_size = std::max<uint64_t>(max_message_size, body.length());
+
+    // Concatenated zstd frames are decompressed as a single stream
+    body = std::move(compress_for_peer(body.data(), body.length(), peer_protocol_version));
+    max_compressed_message_size = std::max<uint64_t>(max_compressed_message_size, body.length());
+#endif
+}
+
+void Network::serialize_message_header(peer_t const& dest_id, uint32_t peer_protocol_version, int64_t timestamp, std::string const& body, std::string& header)
+{
+    Network_Message_pb msg_header;
+    uint64_t high, low;
+    if (peer_protocol_version >= binary_ids_protocol_version && encode_binary_id(dest_id, high, low))
+    {
+        msg_header.set_dest_id_high(high);
+        msg_header.set_dest_id_low(low);
+    }
+    else
+    {
+        msg_header.set_dest_id(dest_id);
+    }
+    msg_header.set_timestamp(timestamp);
+    msg_header.SerializeToString(&header);
+
+#if defined(NETWORK_COMPRESS)
+    if (peer_protocol_version >= frame_flags_protocol_version)
+    {// The body flags byte is not sent, the header one applies to both
+        header = std::move(compress(header.data(), header.length(), static_cast<uint8_t>(body[0])));
+    }
+    else
+    {
+        header = std::move(compress_for_peer(header.data(), header.length(), peer_protocol_version));
     }
+#else
+    (void)body;
+#endif
 }
 
 void Network::process_network_message(Network_Message_pb &msg)
@@ -593,82 +900,273 @@ void Network::process_network_message(Network_Message_pb &msg)
     }
 }
 
-void Network::process_udp()
+void Network::decode_message_ids(Network_Message_pb& msg)
 {
-    try
+    if (msg.source_id().empty() && (msg.source_id_high() != 0 || msg.source_id_low() != 0))
     {
-        ipv4_addr addr;
-        std::array<uint8_t, 4096> buffer;
-        Network_Message_pb msg;
-        size_t len;
-        
-        len = _udp_socket.recvfrom(addr, buffer.data(), buffer.size());
-        if (len > 0)
+        msg.set_source_id(id128_t{ msg.source_id_high(), msg.source_id_low() }.to_string());
+        msg.clear_source_id_high();
+        msg.clear_source_id_low();
+    }
+    if (msg.dest_id().empty() && (msg.dest_id_high() != 0 || msg.dest_id_low() != 0))
+    {
+        msg.set_dest_id(id128_t{ msg.dest_id_high(), msg.dest_id_low() }.to_string());
+        msg.clear_dest_id_high();
+        msg.clear_dest_id_low();
+    }
+
+    if (msg.has_p2p())
+    {// The P2P data user id is the source id, binary_ids_protocol_version senders don't repeat it
+        auto* p2p = msg.mutable_p2p();
+        if (p2p->has_data_message() && p2p->data_message().user_id().empty())
         {
-            const void* message;
-            int message_size;
-
-            #if defined(NETWORK_COMPRESS)
-                std::string buff(std::move(decompress(buffer.data(), len)));
-                message = buff.data();
-                message_size = buff.length();
-            #else
-                message = buffer.data();
-                message_size = len;
-            #endif
-
-            if (msg.ParseFromArray(message, message_size))
+            p2p->mutable_data_message()->set_user_id(msg.source_id());
+        }
+        else if (p2p->has_data_batch())
+        {
+            for (auto& data : *p2p->mutable_data_batch()->mutable_messages())
             {
-                if (msg.source_id() != peer_t())
-                {
-                    std::lock_guard<std::recursive_mutex> lk(local_mutex);
-                    _udp_addrs[msg.source_id()] = addr;
+                if (data.user_id().empty())
+                    data.set_user_id(msg.source_id());
+            }
+        }
+    }
+}
 
-                    //APP_LOG(Log::LogLevel::TRACE, "Received UDP message from: %s - %s", addr.to_string().c_str(), msg.source_id().c_str());
-                    if (msg.has_network_advertise())
-                    {
-                        if (_advertise)
-                        {
-                            auto const& advertise = msg.network_advertise();
-                            if (advertise.has_port())
-                            {
-                                if (!_my_peer_ids.empty() &&
-                                    _tcp_peers.count(msg.source_id()) == 0)
-                                {
-                                    ipv4_addr peer_addr;
-                                    peer_addr.set_ip(addr.get_ip());
-                                    peer_addr.set_port(advertise.port().port());
-                                    connect_to_peer(peer_addr, msg.source_id());
-                                }
-                            }
-                            else if (advertise.has_peer())
-                            {
-                                std::pair<tcp_socket*, std::vector<peer_t>> peer_ids_to_add = std::move(get_new_peer_ids(advertise.peer()));
-
-                                if (peer_ids_to_add.first != nullptr && !peer_ids_to_add.second.empty())
-                                {// We have peer ids to add
-                                    add_new_tcp_client(peer_ids_to_add.first, peer_ids_to_add.second, false);
-                                }
-                            }
-                        }
-                    }
-                    else
-                    {
-                        APP_LOG(Log::LogLevel::DEBUG, "Received UDP message from %s type %d", addr.to_string(true).c_str(), msg.messages_case());
-                        process_network_message(msg);
-                    }
-                }
-                else
+bool Network::parse_message(void const* data, size_t len, Network_Message_pb& msg)
+{
+#if defined(NETWORK_COMPRESS)
+    if (!decompress(data, len))
+        return false;
+#endif
+    if (!msg.ParseFromArray(data, static_cast<int>(len)))
+        return false;
+
+    decode_message_ids(msg);
+    return true;
+}
+
+bool Network::reassemble_udp_message(Network_Message_pb const& fragment_msg, Network_Message_pb& msg)
+{
+    auto const& fragment = fragment_msg.fragment();
+    auto now = std::chrono::steady_clock::now();
+
+    drop_udp_reassemblies(now);
+
+    if (fragment.count() < 2 || fragment.count() > max_udp_fragments || fragment.index() >= fragment.count() ||
+        fragment.data().empty() || fragment.data().length() > udp_fragment_size)
+    {
+        APP_LOG(Log::LogLevel::DEBUG, "Dropping UDP fragment: invalid fragment %u/%u from %s", fragment.index(), fragment.count(), fragment_msg.source_id().c_str());
+        return false;
+    }
+
+    auto key = std::make_pair(fragment_msg.source_id(), fragment.message_id());
+    auto it = _udp_reassemblies.find(key);
+    if (it == _udp_reassemblies.end())
+    {
+        udp_reassembly_t reassembly;
+        reassembly.first_fragment = now;
+        reassembly.received = 0;
+        reassembly.size = 0;
+        reassembly.fragments.resize(fragment.count());
+        it = _udp_reassemblies.emplace(std::move(key), std::move(reassembly)).first;
+    }
+
+    auto& reassembly = it->second;
+    if (reassembly.fragments.size() != fragment.count() || !reassembly.fragments[fragment.index()].empty())
+    {// Duplicated fragment or inconsistent count
+        return false;
+    }
+
+    reassembly.fragments[fragment.index()] = fragment.data();
+    reassembly.size += fragment.data().length();
+    _udp_reassembly_size += fragment.data().length();
+    ++reassembly.received;
+
+    if (reassembly.received != reassembly.fragments.size())
+    {
+        while (_udp_reassembly_size > max_udp_reassembly_size && !_udp_reassemblies.empty())
+        {// Over budget, drop the oldest incomplete messages
+            auto oldest = std::min_element(_udp_reassemblies.begin(), _udp_reassemblies.end(), [](std::pair<std::pair<peer_t, uint32_t> const, udp_reassembly_t> const& a, std::pair<std::pair<peer_t, uint32_t> const, udp_reassembly_t> const& b)
+            {
+                return a.second.first_fragment < b.second.first_fragment;
+            });
+            APP_LOG(Log::LogLevel::WARN, "Dropping UDP message %u from %s: reassembly memory limit reached", oldest->first.second, oldest->first.first.c_str());
+            _udp_reassembly_size -= oldest->second.size;
+            _udp_reassemblies.erase(oldest);
+        }
+        return false;
+    }
+
+    std::string buffer;
+    buffer.reserve(reassembly.size);
+    for (auto const& part : reassembly.fragments)
+        buffer += part;
+
+    _udp_reassembly_size -= reassembly.size;
+    _udp_reassemblies.erase(it);
+
+    if (!parse_message(buffer.data(), buffer.length(), msg))
+    {
+        APP_LOG(Log::LogLevel::DEBUG, "Dropping reassembled UDP data: failed to parse protobuf");
+        return false;
+    }
+
+    return true;
+}
+
+void Network::drop_udp_reassemblies(std::chrono::steady_clock::time_point now)
+{
+    for (auto it = _udp_reassemblies.begin(); it != _udp_reassemblies.end();)
+    {
+        if ((now - it->second.first_fragment) > udp_reassembly_timeout)
+        {
+            APP_LOG(Log::LogLevel::DEBUG, "Dropping UDP message %u from %s: %u/%u fragments received before timeout", it->first.second, it->first.first.c_str(), it->second.received, (uint32_t)it->second.fragments.size());
+            _udp_reassembly_size -= it->second.size;
+            it = _udp_reassemblies.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void Network::send_udp_buffer(PortableAPI::ipv4_addr const& addr, Network_Message_pb const& msg, std::string const& buffer)
+{
+    if (buffer.length() <= max_udp_datagram_size)
+    {
+        _udp_socket.sendto(addr, buffer.data(), buffer.length());
+        return;
+    }
+
+    uint32_t count = static_cast<uint32_t>((buffer.length() + udp_fragment_size - 1) / udp_fragment_size);
+    if (count > max_udp_fragments)
+    {
+        APP_LOG(Log::LogLevel::WARN, "UDP message of %llu bytes is too big, dropping it", (unsigned long long)buffer.length());
+        return;
+    }
+
+    Network_Message_pb fragment_msg;
+    Network_Fragment_pb* fragment = new Network_Fragment_pb;
+
+    fragment_msg.set_source_id(msg.source_id());
+    fragment_msg.set_dest_id(msg.dest_id());
+    fragment_msg.set_source_id_high(msg.source_id_high());
+    fragment_msg.set_source_id_low(msg.source_id_low());
+    fragment_msg.set_dest_id_high(msg.dest_id_high());
+    fragment_msg.set_dest_id_low(msg.dest_id_low());
+    fragment_msg.set_timestamp(msg.timestamp());
+    fragment->set_message_id(_next_udp_message_id++);
+    fragment->set_count(count);
+    fragment_msg.set_allocated_fragment(fragment);
+
+    std::vector<std::string> fragment_buffers(count);
+    std::vector<Socket::const_buffer> buffers(count);
+    std::vector<Socket::send_message> messages(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        size_t offset = i * udp_fragment_size;
+        fragment->set_index(i);
+        fragment->set_data(buffer.data() + offset, std::min(udp_fragment_size, buffer.length() - offset));
+
+        fragment_msg.SerializeToString(&fragment_buffers[i]);
+    #if defined(NETWORK_COMPRESS)
+        // The fragment data was already compressed with the whole message
+        fragment_buffers[i] = std::move(compress(fragment_buffers[i].data(), fragment_buffers[i].length(), frame_flags::none));
+    #endif
+
+        buffers[i] = { fragment_buffers[i].data(), fragment_buffers[i].length() };
+        messages[i] = { &addr, &buffers[i], 1, 0 };
+    }
+
+    // sendto_batch throws if it can't send the first datagram of the batch, so this can't loop forever
+    for (size_t sent = 0; sent < messages.size();)
+        sent += _udp_socket.sendto_batch(&messages[sent], messages.size() - sent);
+}
+
+void Network::process_udp_message(PortableAPI::ipv4_addr const& addr, Network_Message_pb& msg)
+{
+    if (msg.source_id() == peer_t())
+    {
+        APP_LOG(Log::LogLevel::DEBUG, "Dropping UDP data: peer_id is null");
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lk(local_mutex);
+    _udp_addrs[msg.source_id()] = addr;
+
+    //APP_LOG(Log::LogLevel::TRACE, "Received UDP message from: %s - %s", addr.to_string().c_str(), msg.source_id().c_str());
+    if (msg.has_network_advertise())
+    {
+        if (_advertise)
+        {
+            auto const& advertise = msg.network_advertise();
+            if (advertise.has_port())
+            {
+                if (!_my_peer_ids.empty() &&
+                    _tcp_peers.count(msg.source_id()) == 0)
                 {
-                    APP_LOG(Log::LogLevel::DEBUG, "Dropping UDP data: peer_id is null");
+                    ipv4_addr peer_addr;
+                    peer_addr.set_ip(addr.get_ip());
+                    peer_addr.set_port(advertise.port().port());
+                    connect_to_peer(peer_addr, msg.source_id());
                 }
             }
-            else
+            else if (advertise.has_peer())
             {
-                APP_LOG(Log::LogLevel::DEBUG, "Dropping UDP data: failed to pase protobuf");
+                std::pair<tcp_socket*, std::vector<peer_t>> peer_ids_to_add = std::move(get_new_peer_ids(advertise.peer()));
+
+                if (peer_ids_to_add.first != nullptr && !peer_ids_to_add.second.empty())
+                {// We have peer ids to add
+                    add_new_tcp_client(peer_ids_to_add.first, peer_ids_to_add.second, advertise.peer().protocol_version(), false);
+                }
             }
         }
     }
+    else
+    {
+        APP_LOG(Log::LogLevel::DEBUG, "Received UDP message from %s type %d", addr.to_string(true).c_str(), msg.messages_case());
+        process_network_message(msg);
+    }
+}
+
+void Network::process_udp_datagram(PortableAPI::ipv4_addr const& addr, void const* data, size_t len)
+{
+    Network_Message_pb msg;
+
+    if (!parse_message(data, len, msg))
+    {
+        APP_LOG(Log::LogLevel::DEBUG, "Dropping UDP data: failed to pase protobuf");
+        return;
+    }
+
+    if (msg.has_fragment())
+    {// The game thread only sees complete messages
+        Network_Message_pb full_msg;
+        if (msg.source_id() != peer_t() && reassemble_udp_message(msg, full_msg))
+            process_udp_message(addr, full_msg);
+    }
+    else
+    {
+        process_udp_message(addr, msg);
+    }
+}
+
+void Network::process_udp()
+{
+    try
+    {
+        // Drain up to udp_recv_batch_size datagrams with one syscall where the platform allows it,
+        // the reactor is level triggered so it wakes us up again if more are pending.
+        size_t count = _udp_socket.recvfrom_batch(_udp_recv_messages.data(), _udp_recv_messages.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& message = _udp_recv_messages[i];
+            if (message.received > 0)
+                process_udp_datagram(_udp_recv_addrs[i], message.buffer, message.received);
+        }
+    }
     catch (socket_exception & e)
     {
         //APP_LOG(Log::LogLevel::WARN, "Udp socket exception: %s", e.what());
@@ -682,6 +1180,9 @@ void Network::process_tcp_listen()
         tcp_buffer_t tcp_buff({});
         tcp_buff.socket = std::move(_tcp_socket.accept());
         tcp_buff.socket.set_nonblocking(true);
+        tcp_buff.waiting_since = std::chrono::steady_clock::now();
+        // Wake up the network thread as soon as the peer sends its ids
+        _reactor->add_socket(tcp_buff.socket.get_native_socket());
         _waiting_in_tcp_clients.emplace_back(std::move(tcp_buff));
     }
     catch (socket_exception & e)
@@ -690,57 +1191,51 @@ void Network::process_tcp_listen()
     }
 }
 
-void Network::process_tcp_data(tcp_buffer_t& tcp_buffer)
+void Network::receive_tcp_data(tcp_buffer_t& tcp_buffer)
 {
-    // Don't lock here, its already locked in network_thread when needed
-    Network_Message_pb msg;
-    size_t len;
-
     unsigned long count = 0;
     tcp_buffer.socket.ioctlsocket(Socket::cmd_name::fionread, &count);
-    if (count > 0)
-    {
-        size_t buff_len = tcp_buffer.buffer.size();
-        tcp_buffer.buffer.resize(buff_len + count); // We grow to the current size + stream size
+    // Readable with nothing to read: the peer closed the connection (that's how select reports it).
+    // Let recv see the EOF, it throws and the caller removes the peer
+    if (count == 0)
+        count = 1;
 
-        len = tcp_buffer.socket.recv(tcp_buffer.buffer.data() + buff_len, count);
+    auto& buffer = tcp_buffer.buffer;
+    buffer.commit(tcp_buffer.socket.recv(buffer.prepare(count), count));
+}
 
-        while(tcp_buffer.buffer.size() > 0)
-        {
-            if (tcp_buffer.next_packet_size == 0 && tcp_buffer.buffer.size() >= sizeof(next_packet_size_t))
-            {
-                tcp_buffer.next_packet_size = *reinterpret_cast<next_packet_size_t*>(&tcp_buffer.buffer[0]);
-                tcp_buffer.next_packet_size = utils::Endian::net_swap(tcp_buffer.next_packet_size);
-                tcp_buffer.buffer.erase(tcp_buffer.buffer.begin(), tcp_buffer.buffer.begin() + sizeof(tcp_buffer.next_packet_size));
-            }
+void Network::process_tcp_frames(tcp_buffer_t& tcp_buffer)
+{
+    Network_Message_pb msg;
 
-            if (tcp_buffer.next_packet_size > 0 && tcp_buffer.buffer.size() >= tcp_buffer.next_packet_size)
-            {
-                const void* message;
-                int message_size;
-            #if defined(NETWORK_COMPRESS)
-                std::string buff = std::move(decompress(tcp_buffer.buffer.data(), tcp_buffer.next_packet_size));
-                message = buff.data();
-                message_size = buff.length();
-            #else
-                message = tcp_buffer.buffer.data();
-                message_size = tcp_buffer.buffer.size();
-            #endif
-
-                if (msg.ParseFromArray(message, message_size))
-                {
-                    //APP_LOG(Log::LogLevel::DEBUG, "Received TCP message from %s type %d", tcp_buffer.socket.get_addr().to_string(true).c_str(), msg.messages_case());
-                    process_network_message(msg);
-                }
-                tcp_buffer.buffer.erase(tcp_buffer.buffer.begin(), tcp_buffer.buffer.begin() + tcp_buffer.next_packet_size);
-                tcp_buffer.next_packet_size = 0;
-            }
-            else
-            {
-                break;
-            }
+    split_frames(tcp_buffer.buffer, tcp_buffer.next_packet_size, [this, &msg](uint8_t const* data, size_t size)
+    {
+        if (parse_message(data, size, msg))
+        {
+            //APP_LOG(Log::LogLevel::DEBUG, "Received TCP message from %s type %d", tcp_buffer.socket.get_addr().to_string(true).c_str(), msg.messages_case());
+            process_network_message(msg);
         }
-    }
+    });
+}
+
+void Network::process_tcp_data(tcp_buffer_t& tcp_buffer)
+{
+    // Don't lock here, its already locked in network_thread when needed
+    receive_tcp_data(tcp_buffer);
+    process_tcp_frames(tcp_buffer);
+}
+
+std::chrono::milliseconds Network::get_reactor_timeout()
+{
+    constexpr std::chrono::milliseconds max_timeout(500);
+
+    std::lock_guard<std::recursive_mutex> lk(local_mutex);
+    if (!_advertise)
+        return max_timeout;
+
+    // Wake up in time for the next advertise instead of waiting for the full timeout
+    auto next_advertise = std::chrono::duration_cast<std::chrono::milliseconds>((_last_advertise + _advertise_rate) - std::chrono::steady_clock::now());
+    return std::max(std::chrono::milliseconds(0), std::min(next_advertise, max_timeout));
 }
 
 void Network::network_thread()
@@ -752,78 +1247,100 @@ void Network::network_thread()
     _udp_socket.setsockopt(Socket::level::sol_socket, Socket::option_name::so_broadcast, &broadcast, sizeof(broadcast));
     //_udp_socket.set_nonblocking();
 
-    FD_ZERO(&readfds);
-    FD_ZERO(&writefds);
-    FD_ZERO(&exceptfds);
-
     if (!_network_task.want_stop())
     {
-        FD_SET(_udp_socket.get_native_socket(), &readfds);
-        FD_SET(_tcp_socket.get_native_socket(), &readfds);
-        FD_SET(_tcp_self_recv.socket.get_native_socket(), &readfds);
-
-        FD_SET(_udp_socket.get_native_socket(), &exceptfds);
-        FD_SET(_tcp_socket.get_native_socket(), &exceptfds);
-        FD_SET(_tcp_self_recv.socket.get_native_socket(), &exceptfds);
+        _reactor->add_socket(_udp_socket.get_native_socket());
+        _reactor->add_socket(_tcp_socket.get_native_socket());
+        _reactor->add_socket(_tcp_self_recv.socket.get_native_socket());
 
+        APP_LOG(Log::LogLevel::INFO, "Network reactor: %s", _reactor->name());
     }
 
-
+    auto const udp_socket = _udp_socket.get_native_socket();
+    auto const tcp_listen_socket = _tcp_socket.get_native_socket();
+    auto const tcp_self_socket = _tcp_self_recv.socket.get_native_socket();
 
     while (!_network_task.want_stop())
     {
         do_advertise();
 
-        timeval timeout;
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 500000;  // 500 ms timeout
-
-        fd_set readfds_copy = readfds;
-        fd_set writefds_copy = writefds;
-        fd_set exceptfds_copy = exceptfds;
-
-        int res = select(0, &readfds_copy, &writefds_copy, &exceptfds_copy, &timeout);
-        if (res == SOCKET_ERROR) {
+        int res = _reactor->wait(_reactor_events, get_reactor_timeout());
+        if (res < 0) {
             break;
         }
-        else if (res == 0) {
-            continue;  // No events, continue the loop
-        }
+        // res == 0: no events, still go through the waiting clients below so they can time out
 
-        if (FD_ISSET(_udp_socket.get_native_socket(), &readfds_copy)) {
-            process_udp();
-        }
-
-        if (FD_ISSET(_tcp_socket.get_native_socket(), &readfds_copy)) {
-            process_tcp_listen();
-        }
-        
-        if (FD_ISSET(_tcp_self_recv.socket.get_native_socket(), &readfds_copy))
-        {
-            try
+        for (auto& event : _reactor_events)
+        {// Only the ready sockets are reported, dispatch them to their handler
+            if (event.socket == udp_socket)
             {
-                process_tcp_data(_tcp_self_recv); // Process our TCP message, we are not considered as a classic client as we have 2 sockets for the same peer id
+                if (event.events & Network_Reactor::readable)
+                    process_udp();
             }
-            catch (...)
+            else if (event.socket == tcp_listen_socket)
             {
-                assert(0 == 1 && "The local socket should not fail");
+                if (event.events & Network_Reactor::readable)
+                    process_tcp_listen();
             }
-        }
-        
-        {
-            std::lock_guard<std::recursive_mutex> lk(local_mutex);
-            for (auto it = _tcp_clients.begin(); it != _tcp_clients.end();)
-            {// Process the multiple tcp clients we have
-                if (FD_ISSET(it->socket.get_native_socket(), &readfds_copy)) {
-                    process_tcp_data(*it);
-                    ++it;
+            else if (event.socket == tcp_self_socket)
+            {
+                try
+                {
+                    if (event.events & Network_Reactor::readable)
+                        process_tcp_data(_tcp_self_recv); // Process our TCP message, we are not considered as a classic client as we have 2 sockets for the same peer id
                 }
-                else if (FD_ISSET(it->socket.get_native_socket(), &exceptfds_copy)) {
-                    remove_tcp_peer(*it);
-                    it = _tcp_clients.erase(it);
+                catch (...)
+                {
+                    assert(0 == 1 && "The local socket should not fail");
+                }
+            }
+            else
+            {
+                std::lock_guard<std::recursive_mutex> lk(local_mutex);
+                auto it = _tcp_clients_by_socket.find(event.socket);
+                if (it == _tcp_clients_by_socket.end())
+                {// Waiting in/out clients: drain what they sent so the level triggered reactor doesn't report them again, their frames are processed below
+                    tcp_buffer_t* waiting_client = find_waiting_tcp_client(event.socket);
+                    if (waiting_client == nullptr)
+                        continue;
+
+                    bool closed = (event.events & Network_Reactor::error) != 0;
+                    if (!closed && (event.events & Network_Reactor::readable))
+                    {
+                        try
+                        {
+                            receive_tcp_data(*waiting_client);
+                        }
+                        catch (std::exception & e)
+                        {// The peer closed the connection before pairing
+                            APP_LOG(Log::LogLevel::WARN, "Failed peer pair: %s", e.what());
+                            closed = true;
+                        }
+                    }
+
+                    if (closed)
+                        remove_waiting_tcp_client(event.socket);
+
+                    continue;
+                }
+
+                uint32_t events = event.events;
+                if (events & Network_Reactor::readable)
+                {
+                    try
+                    {
+                        process_tcp_data(*it->second);
+                    }
+                    catch (socket_exception & e)
+                    {
+                        APP_LOG(Log::LogLevel::WARN, "Tcp client exception: %s", e.what());
+                        events |= Network_Reactor::error;
+                    }
+                }
+                if (events & Network_Reactor::error)
+                {
+                    remove_tcp_client(it->second);
                 }
-                else
-                    ++it;
             }
         }
         
@@ -869,16 +1386,27 @@ void Network::set_default_channel(peer_t peerid, channel_t default_channel)
     _default_channels[peerid] = default_channel;
 }
 
-void Network::register_listener(IRunNetwork* listener, channel_t channel, Network_Message_pb::MessagesCase type)
+uint32_t Network::get_peer_protocol_version(peer_t const& peerid)
 {
     std::lock_guard<std::recursive_mutex> lk(local_mutex);
 
+    auto it = _peer_protocol_versions.find(peerid);
+    if (it == _peer_protocol_versions.end())
+        return 1;
+
+    return it->second;
+}
+
+void Network::register_listener(IRunNetwork* listener, channel_t channel, Network_Message_pb::MessagesCase type)
+{
+    PROFILED_LOCK(std::unique_lock<std::recursive_mutex>, lk, listeners_mutex);
+
     _network_listeners[type][channel].push_back(listener);
 }
 
 void Network::unregister_listener(IRunNetwork* listener, channel_t channel, Network_Message_pb::MessagesCase type)
 {
-    std::lock_guard<std::recursive_mutex> lk(local_mutex);
+    PROFILED_LOCK(std::unique_lock<std::recursive_mutex>, lk, listeners_mutex);
 
     auto& listeners = _network_listeners[type][channel];
     listeners.erase(
@@ -886,14 +1414,21 @@ void Network::unregister_listener(IRunNetwork* listener, channel_t channel, Netw
         listeners.end());
 }
 
-bool Network::CBRunFrame(channel_t channel, Network_Message_pb::MessagesCase MessageFilter)
+bool Network::CBRunFrame(channel_t channel, Network_Message_pb::MessagesCase MessageFilter, std::chrono::steady_clock::time_point deadline)
 {
-    bool rerun = false;
+    bool messages_left = false;
+    PROFILED_LOCK(std::unique_lock<std::recursive_mutex>, lk, listeners_mutex);
     auto& channel_messages = _network_msgs[channel];
     {
-        std::lock_guard<std::recursive_mutex> lk(local_mutex);
+        bool first = true;
         for (auto it = channel_messages.begin(); it != channel_messages.end(); )
         {
+            if (!first && std::chrono::steady_clock::now() >= deadline)
+            {// Out of time, the next call starts with the remaining messages
+                messages_left = true;
+                break;
+            }
+
             auto msg_case = it->messages_case();
             if (msg_case != Network_Message_pb::MessagesCase::MESSAGES_NOT_SET)
             {
@@ -905,7 +1440,7 @@ bool Network::CBRunFrame(channel_t channel, Network_Message_pb::MessagesCase Mes
 
                     it = channel_messages.erase(it);
 
-                    rerun = true;
+                    first = false;
                 }
                 else
                 {
@@ -930,7 +1465,7 @@ bool Network::CBRunFrame(channel_t channel, Network_Message_pb::MessagesCase Mes
         }
     }
 
-    return rerun;
+    return messages_left;
 }
 
 bool Network::SendBroadcast(Network_Message_pb& msg)
@@ -952,7 +1487,8 @@ bool Network::SendBroadcast(Network_Message_pb& msg)
 #if defined(NETWORK_COMPRESS)
     max_message_size = std::max<uint64_t>(max_message_size, buffer.length());
 
-    buffer = std::move(compress(buffer.data(), buffer.length()));
+    // Broadcasts reach the peers we didn't pair with yet, send what all of them can read
+    buffer = std::move(compress_for_peer(buffer.data(), buffer.length(), get_peer_protocol_version(msg.dest_id())));
     max_compressed_message_size = std::max<uint64_t>(max_compressed_message_size, buffer.length());
 #endif
 
@@ -988,32 +1524,76 @@ std::set<Network::peer_t> Network::UDPSendToAllPeers(Network_Message_pb& msg)
     //if (msg.appid() == 0)
     //    msg.set_appid(Settings::Inst().gameid.AppID());
 
-    std::for_each(_udp_addrs.begin(), _udp_addrs.end(), [&](std::pair<peer_t const, PortableAPI::ipv4_addr>& peer_infos)
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    // One body per peer protocol version, serialized on first use
+    std::string bodies[protocol_version + 1];
+    auto get_body = [&](uint32_t peer_protocol_version) -> std::string const&
     {
-        msg.set_dest_id(peer_infos.first);
-        msg.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
-
-        std::string buffer;
-        msg.SerializeToString(&buffer);
-
-    #if defined(NETWORK_COMPRESS)
-        buffer = std::move(compress(buffer.data(), buffer.length()));
+        std::string& body = bodies[peer_protocol_version];
+        if (body.empty())
+            serialize_message_body(msg, peer_protocol_version, body);
+
+        return body;
+    };
+
+    // Every peer gets its own header, the body is shared. All the datagrams go out in one sendto_batch.
+    std::vector<std::string> headers(_udp_addrs.size());
+    std::vector<Socket::const_buffer> buffers(_udp_addrs.size() * 2);
+    std::vector<Socket::send_message> messages;
+    std::vector<peer_t const*> message_peers;
+    messages.reserve(_udp_addrs.size());
+    message_peers.reserve(_udp_addrs.size());
+
+    size_t i = 0;
+    for (auto& peer_infos : _udp_addrs)
+    {
+        std::string& header = headers[i];
+        uint32_t peer_protocol_version = get_peer_protocol_version(peer_infos.first);
+        std::string const& body = get_body(peer_protocol_version);
+        serialize_message_header(peer_infos.first, peer_protocol_version, timestamp, body, header);
 
-        max_message_size = std::max<uint64_t>(max_message_size, buffer.length());
-        max_compressed_message_size = std::max<uint64_t>(max_compressed_message_size, buffer.length());
-    #endif
+        size_t flags_size = peer_frame_flags_size(peer_protocol_version);
+        if ((header.length() + body.length() - flags_size) <= max_udp_datagram_size)
+        {
+            Socket::const_buffer* peer_buffers = &buffers[i * 2];
+            peer_buffers[0] = { header.data()            , header.length()            };
+            peer_buffers[1] = { body.data() + flags_size , body.length() - flags_size };
+            messages.emplace_back(Socket::send_message{ &peer_infos.second, peer_buffers, 2, 0 });
+            message_peers.emplace_back(&peer_infos.first);
+        }
+        else
+        {
+            try
+            {
+                send_udp_buffer(peer_infos.second, msg, header + body.substr(flags_size));
+                peers_sent_to.insert(peer_infos.first);
+            }
+            catch (socket_exception & e)
+            {
+                //APP_LOG(Log::LogLevel::WARN, "Udp socket exception: %s on %s", e.what(), peer_infos.second.to_string().c_str());
+            }
+        }
+        ++i;
+    }
 
+    for (size_t first = 0; first < messages.size();)
+    {
+        size_t sent = 0;
         try
         {
-            _udp_socket.sendto(peer_infos.second, buffer.data(), buffer.length());
-            peers_sent_to.insert(peer_infos.first);
-            //APP_LOG(Log::LogLevel::TRACE, "Sent message to %s", peer_infos.second.to_string().c_str());
+            sent = _udp_socket.sendto_batch(&messages[first], messages.size() - first);
         }
         catch (socket_exception & e)
         {
-            //APP_LOG(Log::LogLevel::WARN, "Udp socket exception: %s on %s", e.what(), peer_infos.second.to_string().c_str());
+            //APP_LOG(Log::LogLevel::WARN, "Udp socket exception: %s on %s", e.what(), messages[first].addr->to_string().c_str());
         }
-    });
+
+        for (size_t j = first; j < first + sent; ++j)
+            peers_sent_to.insert(*message_peers[j]);
+
+        // The datagram following the sent ones failed, skip it
+        first += sent + 1;
+    }
 
     return peers_sent_to;
 }
@@ -1036,20 +1616,24 @@ bool Network::UDPSendTo(Network_Message_pb& msg)
 
     msg.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
 
+    uint32_t peer_protocol_version = get_peer_protocol_version(msg.dest_id());
+    bool binary_ids = peer_protocol_version >= binary_ids_protocol_version;
+    binary_ids_scope ids(msg, binary_ids, binary_ids);
+
     std::string buffer;
     msg.SerializeToString(&buffer);
 
 #if defined(NETWORK_COMPRESS)
     max_message_size = std::max<uint64_t>(max_message_size, buffer.length());
 
-    buffer = std::move(compress(buffer.data(), buffer.length()));
+    buffer = std::move(compress_for_peer(buffer.data(), buffer.length(), peer_protocol_version));
     max_compressed_message_size = std::max<uint64_t>(max_compressed_message_size, buffer.length());
 #endif
 
     try
     {
-        _udp_socket.sendto(it->second, buffer.data(), buffer.length());
-        APP_LOG(Log::LogLevel::DEBUG, "Sent message to peer_id: %s, addr: %s", msg.dest_id().c_str(), it->second.to_string().c_str());
+        send_udp_buffer(it->second, msg, buffer);
+        APP_LOG(Log::LogLevel::DEBUG, "Sent message to peer_id: %s, addr: %s", it->first.c_str(), it->second.to_string().c_str());
     }
     catch (socket_exception & e)
     {
@@ -1071,30 +1655,31 @@ std::set<Network::peer_t> Network::TCPSendToAllPeers(Network_Message_pb& msg)
     //if (msg.appid() == 0)
     //    msg.set_appid(Settings::Inst().gameid.AppID());
 
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    // One body per peer protocol version, serialized on first use
+    std::string bodies[protocol_version + 1];
+    std::string header;
+
     std::for_each(_tcp_peers.begin(), _tcp_peers.end(), [&](std::pair<peer_t const, tcp_socket*>& client)
     {
-        msg.set_dest_id(client.first);
-        msg.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
-
-        std::string buffer(sizeof(next_packet_size_t), 0);
-
-    #if defined(NETWORK_COMPRESS)
-        std::string data;
-        msg.SerializeToString(&data);
+        uint32_t peer_protocol_version = get_peer_protocol_version(client.first);
+        std::string& body = bodies[peer_protocol_version];
+        if (body.empty())
+            serialize_message_body(msg, peer_protocol_version, body);
 
-        max_message_size = std::max<uint64_t>(max_message_size, data.length());
+        serialize_message_header(client.first, peer_protocol_version, timestamp, body, header);
 
-        buffer += std::move(compress(data.data(), data.length()));
-        max_compressed_message_size = std::max<uint64_t>(max_compressed_message_size, buffer.length());
-    #else
-        buffer += std::move(msg.SerializeAsString());
-    #endif
-
-        *reinterpret_cast<next_packet_size_t*>(&buffer[0]) = make_next_packet_size(buffer);
+        size_t flags_size = peer_frame_flags_size(peer_protocol_version);
+        next_packet_size_t packet_size = utils::Endian::net_swap(next_packet_size_t(header.length() + body.length() - flags_size));
+        Socket::const_buffer buffers[] = {
+            { &packet_size            , sizeof(packet_size)        },
+            { header.data()           , header.length()            },
+            { body.data() + flags_size, body.length() - flags_size },
+        };
 
         try
         {
-            client.second->send(buffer.data(), buffer.length());
+            client.second->sendv(buffers, 3);
             peers_sent_to.insert(client.first);
             //APP_LOG(Log::LogLevel::TRACE, "Sent message to %s", peer_infos.second.to_string().c_str());
         }
@@ -1125,6 +1710,10 @@ bool Network::TCPSendTo(Network_Message_pb& msg)
 
     msg.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
 
+    uint32_t peer_protocol_version = get_peer_protocol_version(msg.dest_id());
+    bool binary_ids = peer_protocol_version >= binary_ids_protocol_version;
+    binary_ids_scope ids(msg, binary_ids, binary_ids);
+
     std::string buffer(sizeof(next_packet_size_t), 0);
 
 #if defined(NETWORK_COMPRESS)
@@ -1133,7 +1722,7 @@ bool Network::TCPSendTo(Network_Message_pb& msg)
 
     max_message_size = std::max<uint64_t>(max_message_size, data.length());
 
-    buffer += std::move(compress(data.data(), data.length()));
+    buffer += std::move(compress_for_peer(data.data(), data.length(), peer_protocol_version));
     max_compressed_message_size = std::max<uint64_t>(max_compressed_message_size, buffer.length());
 #else
     buffer += std::move(msg.SerializeAsString());
@@ -24,6 +24,7 @@
 #endif
 
 #include "common_includes.h"
+#include "network_reactor.h"
 #include "task.h"
 
 class IRunNetwork
@@ -40,59 +41,234 @@ public:
     using peer_t = std::string;
     using next_packet_size_t = uint32_t;
 
+    // Contiguous receive buffer with read/write cursors.
+    // Frames are parsed in place and consumed by moving the read cursor, the unread bytes
+    // are only moved back to the front when there is no room left at the end of the buffer.
+    class recv_buffer_t
+    {
+        std::vector<uint8_t> _buffer;
+        size_t _read_pos;
+        size_t _write_pos;
+
+    public:
+        recv_buffer_t():
+            _read_pos(0),
+            _write_pos(0)
+        {}
+
+        inline size_t size() const { return _write_pos - _read_pos; }
+        inline bool empty() const { return _write_pos == _read_pos; }
+        inline uint8_t* data() { return _buffer.data() + _read_pos; }
+        inline uint8_t const* data() const { return _buffer.data() + _read_pos; }
+
+        inline void reserve(size_t len) { if (_buffer.size() < len) _buffer.resize(len); }
+        inline void clear() { _read_pos = _write_pos = 0; }
+
+        // Makes room for len bytes at the end of the buffer and returns where to write them
+        inline uint8_t* prepare(size_t len)
+        {
+            if ((_buffer.size() - _write_pos) < len && _read_pos > 0)
+            {// Not enough room at the end, move the pending bytes to the front (only happens once per partial frame)
+                size_t pending = size();
+                memmove(_buffer.data(), _buffer.data() + _read_pos, pending);
+                _read_pos = 0;
+                _write_pos = pending;
+            }
+            if ((_buffer.size() - _write_pos) < len)
+            {
+                _buffer.resize(std::max(_buffer.size() * 2, _write_pos + len));
+            }
+
+            return _buffer.data() + _write_pos;
+        }
+        // Commits len bytes previously written in the prepared area
+        inline void commit(size_t len) { _write_pos += len; }
+        // Drops len bytes from the front of the buffer
+        inline void consume(size_t len)
+        {
+            _read_pos += len;
+            if (_read_pos >= _write_pos)
+                clear();
+        }
+    };
+
     struct tcp_buffer_t
     {
         PortableAPI::tcp_socket socket;
-        std::vector<uint8_t> buffer;
+        recv_buffer_t buffer;
         next_packet_size_t next_packet_size;
+        // When the connection started waiting for its pairing message
+        std::chrono::steady_clock::time_point waiting_since;
+    };
+
+    // Splits the bytes received on a TCP connection in frames: a big endian next_packet_size_t then the message.
+    // on_frame(uint8_t const* data, size_t size) is called for each complete frame, straight from the buffer.
+    // next_packet_size keeps the size of a frame whose size was read but not its whole message yet.
+    // Stops after max_frames frames, the next ones stay in the buffer. Returns the number of frames processed.
+    template<typename OnFrame>
+    static size_t split_frames(recv_buffer_t& buffer, next_packet_size_t& next_packet_size, OnFrame&& on_frame, size_t max_frames = std::numeric_limits<size_t>::max())
+    {
+        size_t frames = 0;
+        while (frames < max_frames && !buffer.empty())
+        {
+            if (next_packet_size == 0)
+            {
+                if (buffer.size() < sizeof(next_packet_size_t))
+                    break;
+
+                memcpy(&next_packet_size, buffer.data(), sizeof(next_packet_size_t));
+                next_packet_size = utils::Endian::net_swap(next_packet_size);
+                buffer.consume(sizeof(next_packet_size_t));
+            }
+
+            if (buffer.size() < next_packet_size)
+                break;
+
+            // Frame is complete, parse it straight from the receive buffer
+            on_frame(static_cast<uint8_t const*>(buffer.data()), static_cast<size_t>(next_packet_size));
+            buffer.consume(next_packet_size);
+            next_packet_size = 0;
+            ++frames;
+        }
+
+        return frames;
+    }
+
+    // Fragments of a UDP message being reassembled
+    struct udp_reassembly_t
+    {
+        std::chrono::steady_clock::time_point first_fragment;
+        uint32_t received;
+        size_t size;
+        std::vector<std::string> fragments;
     };
 
 private:
     static constexpr uint16_t network_port = 55789;
+
+public:
+    // See Network_Peer_pb in network_proto.proto
+    static constexpr uint32_t protocol_version = 2;
+    static constexpr uint32_t binary_ids_protocol_version = 2;
+    // Compressed frames start with a flags byte, older peers send and expect bare zstd frames
+    static constexpr uint32_t frame_flags_protocol_version = 2;
+    // Reliable P2P packets are sequenced, acknowledged and sent again, older peers don't ack them
+    static constexpr uint32_t p2p_reliability_protocol_version = 2;
+
+private:
     static constexpr uint16_t max_network_port = (network_port + 10);
 
+    // Biggest datagram that won't be fragmented by IP: 1500 bytes MTU - 20 bytes IPv4 header - 8 bytes UDP header
+    static constexpr size_t max_udp_datagram_size = 1472;
+    // Bigger messages are split in fragments of this size, leaving room for the fragment envelope and compression framing
+    static constexpr size_t udp_fragment_size = 1200;
+    static constexpr uint32_t max_udp_fragments = 1024;
+    // Limits the memory used by incomplete messages, the oldest ones are dropped first
+    static constexpr size_t max_udp_reassembly_size = 8 * 1024 * 1024;
+    static constexpr auto udp_reassembly_timeout = std::chrono::milliseconds(2000);
+    // Connections that didn't send their pairing message in time are closed
+    static constexpr auto waiting_client_timeout = std::chrono::milliseconds(5000);
+    // Biggest UDP datagram
+    static constexpr size_t max_udp_message_size = 65536;
+    // Datagrams drained per reactor wakeup, each one gets its own slot in _udp_recv_buffer
+    static constexpr size_t udp_recv_batch_size = 16;
+
 #if defined(NETWORK_COMPRESS)
+    // Every frame starts with a flags byte telling how its payload is encoded
+    enum frame_flags : uint8_t
+    {
+        none       = 0,
+        compressed = 1 << 0, // The payload is a sequence of zstd frames
+        dictionary = 1 << 1, // The zstd frames were compressed with the shared dictionary
+    };
+    static constexpr size_t frame_flags_size = sizeof(uint8_t);
+    static constexpr size_t max_decompressed_size = 8 * 1024 * 1024;
+
     // Performance counters
     uint64_t max_message_size;
     uint64_t max_compressed_message_size;
 
+    // Below this size the zstd framing costs more than it saves, the message is sent as is
+    size_t _compress_min_size;
     ZSTD_CCtx   * _zstd_ccontext;
     ZSTD_DStream* _zstd_dstream;
+    ZSTD_CDict  * _zstd_cdict;
+    ZSTD_DDict  * _zstd_ddict;
+    // compress is called from the game thread and from the network thread
+    std::mutex _compress_mutex;
+    // Only used by the network thread
+    std::string _decompress_buffer;
+    // Uncompressed messages are recorded here to train the dictionary, see tools/train_network_dictionary.cpp
+    std::ofstream _capture_file;
 
+    void load_compression_dictionary(std::string const& path);
+    // Builds <flags><payload>, the payload is left uncompressed if it is too small or doesn't shrink
     std::string compress(void const* data, size_t len);
-    std::string decompress(void const* data, size_t len);
+    // Same but forces the flags, used for the header of a split message that must match its body
+    std::string compress(void const* data, size_t len, uint8_t flags);
+    // Peers before frame_flags_protocol_version get a bare zstd frame, without dictionary
+    std::string compress_for_peer(void const* data, size_t len, uint32_t peer_protocol_version);
+    // On success, data and len point to the message: in the frame itself or in _decompress_buffer.
+    // Bare zstd frames from the older peers are detected by their magic number.
+    bool decompress(void const*& data, size_t& len);
+#else
+    static constexpr size_t frame_flags_size = 0;
 #endif
 
+    static inline size_t peer_frame_flags_size(uint32_t peer_protocol_version)
+    {
+        return peer_protocol_version >= frame_flags_protocol_version ? frame_flags_size : 0;
+    }
+
     bool _advertise;
     std::chrono::milliseconds _advertise_rate;
     std::chrono::steady_clock::time_point _last_advertise;
     std::set<peer_t> _my_peer_ids;
     uint16_t _tcp_port;
 
-    fd_set readfds, writefds, exceptfds;
+    std::unique_ptr<Network_Reactor> _reactor;
+    std::vector<Network_Reactor::event_t> _reactor_events;
     PortableAPI::udp_socket _udp_socket;
     std::map<peer_t, PortableAPI::ipv4_addr> _udp_addrs;
+    std::vector<uint8_t> _udp_recv_buffer;
+    std::array<PortableAPI::ipv4_addr, udp_recv_batch_size> _udp_recv_addrs;
+    std::array<PortableAPI::Socket::recv_message, udp_recv_batch_size> _udp_recv_messages;
+    uint32_t _next_udp_message_id;
+    // Only accessed by the network thread
+    std::map<std::pair<peer_t, uint32_t>, udp_reassembly_t> _udp_reassemblies;
+    size_t _udp_reassembly_size;
 
     PortableAPI::tcp_socket _tcp_socket;
     std::list<tcp_buffer_t> _tcp_clients;
+    std::unordered_map<Network_Reactor::socket_t, std::list<tcp_buffer_t>::iterator> _tcp_clients_by_socket;
     std::map<peer_t, PortableAPI::tcp_socket> _waiting_connect_tcp_clients;
     std::map<peer_t, tcp_buffer_t>            _waiting_out_tcp_clients;
     std::list<tcp_buffer_t>                   _waiting_in_tcp_clients;
     PortableAPI::tcp_socket _tcp_self_send;
     tcp_buffer_t _tcp_self_recv;
     std::map<peer_t, PortableAPI::tcp_socket*> _tcp_peers;
+    // Protocol version negotiated with each paired peer
+    std::map<peer_t, uint32_t> _peer_protocol_versions;
 
     std::map<Network_Message_pb::MessagesCase, std::map<channel_t, std::vector<IRunNetwork*>>> _network_listeners;
 
     // Lock message_mutex when accessing:
     //  _pending_network_msgs
     std::mutex message_mutex;
+    // Lock listeners_mutex when accessing:
+    //  _network_listeners
+    //  _network_msgs
+    // It is held while the listeners run, the listeners take their interface lock and send messages:
+    // never (un)register a listener while holding an interface lock.
+    std::recursive_mutex listeners_mutex;
     // Lock local_mutex when accessing:
     //  _udp_addrs
+    //  _next_udp_message_id
     //  _tcp_clients
+    //  _tcp_clients_by_socket
     //  _tcp_peers
+    //  _peer_protocol_versions
     //  _my_peer_ids
-    //  _network_listeners
     //  _advertise
     std::recursive_mutex local_mutex;
 
@@ -108,15 +284,37 @@ private:
     void set_advertise_rate(std::chrono::milliseconds rate);
     std::chrono::milliseconds get_advertise_rate();
 
-    void add_new_tcp_client(PortableAPI::tcp_socket* cli, std::vector<peer_t> const& peer_ids, bool advertise);
+    std::chrono::milliseconds get_reactor_timeout();
+
+    void add_new_tcp_client(PortableAPI::tcp_socket* cli, std::vector<peer_t> const& peer_ids, uint32_t peer_protocol_version, bool advertise);
     void remove_tcp_peer(tcp_buffer_t& tcp_buffer);
+    void remove_tcp_client(std::list<tcp_buffer_t>::iterator client);
+    tcp_buffer_t* find_waiting_tcp_client(Network_Reactor::socket_t native_socket);
+    void remove_waiting_tcp_client(Network_Reactor::socket_t native_socket);
     void connect_to_peer(PortableAPI::ipv4_addr& addr, peer_t const& peer_id);
     void process_waiting_out_clients();
     void process_waiting_in_client();
 
+    // Fills the string ids of a message received with binary ids, the rest of the emulator only deals with strings
+    static void decode_message_ids(Network_Message_pb& msg);
+    bool parse_message(void const* data, size_t len, Network_Message_pb& msg);
+    bool reassemble_udp_message(Network_Message_pb const& fragment_msg, Network_Message_pb& msg);
+    void drop_udp_reassemblies(std::chrono::steady_clock::time_point now);
+    void send_udp_buffer(PortableAPI::ipv4_addr const& addr, Network_Message_pb const& msg, std::string const& buffer);
+
+    // Broadcasts send <header><body>: the body is serialized once, the header only holds the destination and the timestamp.
+    // The frame flags are at the front of both, only the header ones are sent: skip peer_frame_flags_size bytes of the body.
+    // The ids and the framing depend on the peer protocol version, a body is only shared by the peers of the same version.
+    void serialize_message_body(Network_Message_pb& msg, uint32_t peer_protocol_version, std::string& body);
+    void serialize_message_header(peer_t const& dest_id, uint32_t peer_protocol_version, int64_t timestamp, std::string const& body, std::string& header);
+
     void process_network_message(Network_Message_pb& msg);
+    void process_udp_message(PortableAPI::ipv4_addr const& addr, Network_Message_pb& msg);
+    void process_udp_datagram(PortableAPI::ipv4_addr const& addr, void const* data, size_t len);
     void process_udp();
     void process_tcp_listen();
+    static void receive_tcp_data(tcp_buffer_t& tcp_buffer);
+    void process_tcp_frames(tcp_buffer_t& tcp_buffer);
     void process_tcp_data(tcp_buffer_t& tcp_buffer);
     void network_thread();
     task _network_task;
@@ -139,10 +337,16 @@ public:
 
     void set_default_channel(peer_t peerid, channel_t default_channel);
 
+    // 1 if the peer is not paired
+    uint32_t get_peer_protocol_version(peer_t const& peerid);
+
     void register_listener  (IRunNetwork* listener, channel_t channel, Network_Message_pb::MessagesCase type);
     void unregister_listener(IRunNetwork* listener, channel_t channel, Network_Message_pb::MessagesCase type);
 
-    bool CBRunFrame(channel_t channel, Network_Message_pb::MessagesCase MessageFilter = Network_Message_pb::MessagesCase::MESSAGES_NOT_SET);
+    // Dispatches the received messages to their listeners, stops after deadline and leaves the rest for the next call.
+    // Returns true if some messages were left.
+    bool CBRunFrame(channel_t channel, Network_Message_pb::MessagesCase MessageFilter = Network_Message_pb::MessagesCase::MESSAGES_NOT_SET,
+                    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
 
     bool SendBroadcast(Network_Message_pb& msg); // Always UDP
     std::set<peer_t> UDPSendToAllPeers(Network_Message_pb& msg);
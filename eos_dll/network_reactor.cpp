@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "network_reactor.h"
+
+using namespace PortableAPI;
+
+std::unique_ptr<Network_Reactor> Network_Reactor::create()
+{
+#if defined(NETWORK_EPOLL_REACTOR)
+    try
+    {
+        return std::unique_ptr<Network_Reactor>(new Epoll_Reactor);
+    }
+    catch (std::exception& e)
+    {
+        APP_LOG(Log::LogLevel::WARN, "Failed to create epoll reactor, falling back to select: %s", e.what());
+    }
+#endif
+    return std::unique_ptr<Network_Reactor>(new Select_Reactor);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                               Select reactor                              //
+///////////////////////////////////////////////////////////////////////////////
+Select_Reactor::Select_Reactor()
+{
+    FD_ZERO(&_readfds);
+    FD_ZERO(&_exceptfds);
+}
+
+Select_Reactor::~Select_Reactor()
+{}
+
+const char* Select_Reactor::name() const
+{
+    return "select";
+}
+
+bool Select_Reactor::add_socket(socket_t socket)
+{
+    if (std::find(_sockets.begin(), _sockets.end(), socket) != _sockets.end())
+        return false;
+
+#if !defined(__WINDOWS__)
+    // On Windows fd_set is an array of sockets, elsewhere it is a bitset indexed by the fd
+    if (socket >= FD_SETSIZE)
+    {
+        APP_LOG(Log::LogLevel::ERR, "Socket %d is above FD_SETSIZE, it will not be polled", (int)socket);
+        return false;
+    }
+#endif
+
+    FD_SET(socket, &_readfds);
+    FD_SET(socket, &_exceptfds);
+    _sockets.emplace_back(socket);
+    return true;
+}
+
+bool Select_Reactor::remove_socket(socket_t socket)
+{
+    auto it = std::find(_sockets.begin(), _sockets.end(), socket);
+    if (it == _sockets.end())
+        return false;
+
+    FD_CLR(socket, &_readfds);
+    FD_CLR(socket, &_exceptfds);
+    _sockets.erase(it);
+    return true;
+}
+
+void Select_Reactor::clear()
+{
+    FD_ZERO(&_readfds);
+    FD_ZERO(&_exceptfds);
+    _sockets.clear();
+}
+
+int Select_Reactor::wait(std::vector<event_t>& events, std::chrono::milliseconds timeout)
+{
+    events.clear();
+
+    timeval tv;
+    tv.tv_sec  = static_cast<long>(timeout.count() / 1000);
+    tv.tv_usec = static_cast<long>((timeout.count() % 1000) * 1000);
+
+    fd_set readfds_copy = _readfds;
+    fd_set exceptfds_copy = _exceptfds;
+
+    int nfds = 0;
+#if !defined(__WINDOWS__)
+    for (auto socket : _sockets)
+        nfds = std::max<int>(nfds, socket + 1);
+#endif
+
+    int res = select(nfds, &readfds_copy, nullptr, &exceptfds_copy, &tv);
+    if (res < 0)
+        return -1;
+
+    if (res == 0)
+        return 0;
+
+    for (auto socket : _sockets)
+    {
+        uint32_t flags = event_flags::none;
+        if (FD_ISSET(socket, &readfds_copy))
+            flags |= event_flags::readable;
+        if (FD_ISSET(socket, &exceptfds_copy))
+            flags |= event_flags::error;
+
+        if (flags != event_flags::none)
+            events.emplace_back(event_t{ socket, flags });
+    }
+
+    return static_cast<int>(events.size());
+}
+
+#if defined(NETWORK_EPOLL_REACTOR)
+///////////////////////////////////////////////////////////////////////////////
+//                               Epoll reactor                               //
+///////////////////////////////////////////////////////////////////////////////
+Epoll_Reactor::Epoll_Reactor():
+    _epoll_fd(epoll_create1(EPOLL_CLOEXEC))
+{
+    if (_epoll_fd == -1)
+        throw std::runtime_error(strerror(errno));
+}
+
+Epoll_Reactor::~Epoll_Reactor()
+{
+    close(_epoll_fd);
+}
+
+const char* Epoll_Reactor::name() const
+{
+    return "epoll";
+}
+
+bool Epoll_Reactor::add_socket(socket_t socket)
+{
+    if (_sockets.count(socket) != 0)
+        return false;
+
+    // Level triggered: the handlers only read what they need and expect to be woken up again if data remains.
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.fd = socket;
+
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, socket, &ev) == -1)
+    {
+        APP_LOG(Log::LogLevel::WARN, "epoll_ctl add failed on socket %d: %s", socket, strerror(errno));
+        return false;
+    }
+
+    _sockets.insert(socket);
+    return true;
+}
+
+bool Epoll_Reactor::remove_socket(socket_t socket)
+{
+    auto it = _sockets.find(socket);
+    if (it == _sockets.end())
+        return false;
+
+    // The fd might already be closed, in that case the kernel already dropped it from the epoll set
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
+    _sockets.erase(it);
+    return true;
+}
+
+void Epoll_Reactor::clear()
+{
+    for (auto socket : _sockets)
+        epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
+
+    _sockets.clear();
+}
+
+int Epoll_Reactor::wait(std::vector<event_t>& events, std::chrono::milliseconds timeout)
+{
+    events.clear();
+
+    int res = epoll_wait(_epoll_fd, _events.data(), static_cast<int>(_events.size()), static_cast<int>(timeout.count()));
+    if (res == -1)
+    {
+        // A signal interrupted us, not an error, let the loop run again
+        return (errno == EINTR ? 0 : -1);
+    }
+
+    for (int i = 0; i < res; ++i)
+    {
+        uint32_t flags = event_flags::none;
+        if (_events[i].events & EPOLLIN)
+            flags |= event_flags::readable;
+        if (_events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+            flags |= event_flags::error;
+
+        events.emplace_back(event_t{ _events[i].data.fd, flags });
+    }
+
+    return res;
+}
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common_includes.h"
+
+#if defined(__LINUX__) && !defined(NETWORK_SELECT_REACTOR)
+    #define NETWORK_EPOLL_REACTOR
+    #include <sys/epoll.h>
+#endif
+
+// Waits for socket events on behalf of the network thread.
+// Sockets are registered once when they are accepted/connected and only the ready ones are reported back.
+class LOCAL_API Network_Reactor
+{
+public:
+    using socket_t = PortableAPI::Socket::socket_t;
+
+    enum event_flags : uint32_t
+    {
+        none     = 0,
+        readable = 1 << 0,
+        error    = 1 << 1, // Socket error or hang up, the socket should be dropped
+    };
+
+    struct event_t
+    {
+        socket_t socket;
+        uint32_t events;
+    };
+
+    virtual ~Network_Reactor() {}
+
+    virtual const char* name() const = 0;
+
+    virtual bool add_socket(socket_t socket) = 0;
+    virtual bool remove_socket(socket_t socket) = 0;
+    virtual void clear() = 0;
+
+    // Fills events with the ready sockets, returns the number of ready sockets, 0 on timeout, -1 on error.
+    virtual int wait(std::vector<event_t>& events, std::chrono::milliseconds timeout) = 0;
+
+    // Builds the best reactor available on this platform
+    static std::unique_ptr<Network_Reactor> create();
+};
+
+// Portable fallback, O(n) per wakeup and limited to FD_SETSIZE sockets
+class LOCAL_API Select_Reactor : public Network_Reactor
+{
+    fd_set _readfds;
+    fd_set _exceptfds;
+    std::vector<socket_t> _sockets;
+
+public:
+    Select_Reactor();
+    virtual ~Select_Reactor();
+
+    virtual const char* name() const;
+
+    virtual bool add_socket(socket_t socket);
+    virtual bool remove_socket(socket_t socket);
+    virtual void clear();
+
+    virtual int wait(std::vector<event_t>& events, std::chrono::milliseconds timeout);
+};
+
+#if defined(NETWORK_EPOLL_REACTOR)
+class LOCAL_API Epoll_Reactor : public Network_Reactor
+{
+    static constexpr int max_events = 64;
+
+    int _epoll_fd;
+    std::set<socket_t> _sockets;
+    std::array<epoll_event, max_events> _events;
+
+public:
+    Epoll_Reactor();
+    virtual ~Epoll_Reactor();
+
+    virtual const char* name() const;
+
+    virtual bool add_socket(socket_t socket);
+    virtual bool remove_socket(socket_t socket);
+    virtual void clear();
+
+    virtual int wait(std::vector<event_t>& events, std::chrono::milliseconds timeout);
+};
+#endif
@@ -36,6 +36,62 @@ T get_setting(nlohmann::json& settings, std::string const& key, T default_val)
     return val;
 }
 
+// Interface names used in the "callback_latency" setting
+static constexpr std::pair<const char*, int32_t> callback_latency_interfaces[] = {
+    { "auth"             , k_iAuthCallbackBase              / 1000 },
+    { "achievements"     , k_iAchievementsCallbacks         / 1000 },
+    { "connect"          , k_iConnectCallbackBase           / 1000 },
+    { "ecom"             , k_iEcomCallbackBase              / 1000 },
+    { "friends"          , k_iFriendsCallbackBase           / 1000 },
+    { "leaderboards"     , k_iLeaderboardsCallbackBase      / 1000 },
+    { "lobby"            , k_iLobbyCallbackBase             / 1000 },
+    { "metrics"          , k_iMetricsCallbackBase           / 1000 },
+    { "p2p"              , k_iP2PCallbackBase               / 1000 },
+    { "playerdatastorage", k_iPlayerDataStorageCallbackBase / 1000 },
+    { "presence"         , k_iPresenceCallbackBase          / 1000 },
+    { "sessions"         , k_iSessionsCallbackBase          / 1000 },
+    { "stats"            , k_iStatsCallbackBase             / 1000 },
+    { "titlestorage"     , k_iTitleStorageCallbackBase      / 1000 },
+    { "ui"               , k_iUICallbackBase                / 1000 },
+    { "userinfo"         , k_iUserInfoCallbackBase          / 1000 },
+};
+
+// A latency is either a number of milliseconds or one of "fixed", "fast" and "realistic"
+static bool parse_callback_latency(nlohmann::json const& value, Settings::callback_latency_t& latency)
+{
+    if (value.is_number_unsigned())
+    {
+        latency.mode = Settings::callback_latency_mode::fixed;
+        latency.milliseconds = static_cast<int32_t>(std::min<uint64_t>(value.get<uint64_t>(), INT32_MAX));
+        return true;
+    }
+    if (value.is_string())
+    {
+        latency.milliseconds = -1;
+        switchstr(value.get<std::string>())
+        {
+            casestr("fixed")    : latency.mode = Settings::callback_latency_mode::fixed    ; return true;
+            casestr("fast")     : latency.mode = Settings::callback_latency_mode::fast     ; return true;
+            casestr("realistic"): latency.mode = Settings::callback_latency_mode::realistic; return true;
+        }
+    }
+    return false;
+}
+
+static nlohmann::json callback_latency_to_json(Settings::callback_latency_t const& latency)
+{
+    switch (latency.mode)
+    {
+        case Settings::callback_latency_mode::fast     : return "fast";
+        case Settings::callback_latency_mode::realistic: return "realistic";
+        case Settings::callback_latency_mode::fixed    :
+        default:
+            if (latency.milliseconds >= 0)
+                return latency.milliseconds;
+            return "fixed";
+    }
+}
+
 Settings::Settings()
 {
     load_settings();
@@ -125,6 +181,7 @@ void Settings::load_settings()
     }
     APP_LOG(Log::LogLevel::INFO, "Setting log level to: %s", Log::loglevel_to_str(llvl));
     Log::set_loglevel(llvl);
+    Log::set_async(get_setting(settings, "log_async", true));
 #endif
 
     APP_LOG(Log::LogLevel::INFO, "Configuration Path: %s", config_path.c_str());
@@ -165,8 +222,47 @@ void Settings::load_settings()
     unlock_dlcs               = get_setting(settings, "unlock_dlcs", bool(true));
     enable_overlay            = get_setting(settings, "enable_overlay", bool(true));
     disable_online_networking = get_setting(settings, "disable_online_networking", bool(false));
+    p2p_coalesce_packets      = get_setting(settings, "p2p_coalesce_packets", bool(false));
+    network_compress_min_size   = get_setting(settings, "network_compress_min_size", uint32_t(64));
+    network_compress_dictionary = get_setting(settings, "network_compress_dictionary", std::string(""));
+    network_capture_file        = get_setting(settings, "network_capture_file", std::string(""));
+    storage_mmap_max_size       = get_setting(settings, "storage_mmap_max_size", uint64_t(64 * 1024 * 1024));
     savepath                  = get_setting(settings, "savepath", std::string("appdata"));
 
+    default_callback_latency = { callback_latency_mode::fixed, -1 };
+    callback_latencies.clear();
+    nlohmann::json latencies = get_setting(settings, "callback_latency", nlohmann::json{ {"default", "fixed"} });
+    if (latencies.is_object())
+    {
+        for (auto it = latencies.begin(); it != latencies.end(); ++it)
+        {
+            callback_latency_t latency;
+            if (!parse_callback_latency(it.value(), latency))
+            {
+                APP_LOG(Log::LogLevel::WARN, "Invalid callback_latency for '%s', expected milliseconds, \"fixed\", \"fast\" or \"realistic\"", it.key().c_str());
+                continue;
+            }
+
+            if (it.key() == "default")
+            {
+                default_callback_latency = latency;
+                continue;
+            }
+
+            auto interface_it = std::find_if(std::begin(callback_latency_interfaces), std::end(callback_latency_interfaces), [&it](std::pair<const char*, int32_t> const& item)
+            {
+                return it.key() == item.first;
+            });
+            if (interface_it == std::end(callback_latency_interfaces))
+            {
+                APP_LOG(Log::LogLevel::WARN, "Unknown callback_latency interface '%s'", it.key().c_str());
+                continue;
+            }
+
+            callback_latencies[interface_it->second] = latency;
+        }
+    }
+
     std::string productuserid = get_setting(settings, "productuserid", generate_account_id_from_name(appid + userid->to_string()));
     this->productuserid = GetProductUserId(productuserid);
 
@@ -209,10 +305,54 @@ void Settings::save_settings()
     settings["unlock_dlcs"]               = unlock_dlcs;
     settings["enable_overlay"]            = enable_overlay;
     settings["disable_online_networking"] = disable_online_networking;
+    settings["p2p_coalesce_packets"]      = p2p_coalesce_packets;
+    settings["network_compress_min_size"]   = network_compress_min_size;
+    settings["network_compress_dictionary"] = network_compress_dictionary;
+    settings["network_capture_file"]        = network_capture_file;
+    settings["storage_mmap_max_size"]       = storage_mmap_max_size;
 #ifndef DISABLE_LOG
     settings["log_level"]                 = Log::loglevel_to_str();
+    settings["log_async"]                 = Log::get_async();
 #endif
     settings["savepath"]                  = savepath;
 
+    nlohmann::json& latencies = settings["callback_latency"];
+    latencies["default"] = callback_latency_to_json(default_callback_latency);
+    for (auto const& item : callback_latency_interfaces)
+    {
+        auto it = callback_latencies.find(item.second);
+        if (it != callback_latencies.end())
+            latencies[item.first] = callback_latency_to_json(it->second);
+    }
+
     save_json(config_path, settings);
 }
+
+std::chrono::milliseconds Settings::get_callback_latency(int i_callback, std::chrono::milliseconds emu_latency) const
+{
+    auto it = callback_latencies.find(i_callback / 1000);
+    callback_latency_t const& latency = (it == callback_latencies.end() ? default_callback_latency : it->second);
+
+    switch (latency.mode)
+    {
+        case callback_latency_mode::fast: return std::chrono::milliseconds(0);
+
+        case callback_latency_mode::realistic:
+        {
+            if (emu_latency.count() <= 0)
+                return std::chrono::milliseconds(0);
+
+            // Network latencies have a long tail: log-normal around the emulator latency, clamped to [latency/4, latency*4]
+            thread_local std::mt19937 gen{ std::random_device{}() };
+            std::lognormal_distribution<double> dist(std::log(static_cast<double>(emu_latency.count())), 0.5);
+            double sample = std::min(std::max(dist(gen), emu_latency.count() / 4.0), emu_latency.count() * 4.0);
+            return std::chrono::milliseconds(static_cast<int64_t>(sample));
+        }
+
+        case callback_latency_mode::fixed:
+        default:
+            if (latency.milliseconds >= 0)
+                return std::chrono::milliseconds(latency.milliseconds);
+            return emu_latency;
+    }
+}
@@ -24,6 +24,21 @@
 
 class Settings
 {
+public:
+    enum class callback_latency_mode
+    {
+        fixed,     // Complete after milliseconds, or after the emulator latency if milliseconds < 0
+        fast,      // Complete on the next tick
+        realistic, // Complete after a latency sampled around the emulator latency
+    };
+
+    struct callback_latency_t
+    {
+        callback_latency_mode mode;
+        int32_t milliseconds;
+    };
+
+private:
     Settings();
     Settings(Settings const&) = delete;
     Settings(Settings&&) = delete;
@@ -48,11 +63,24 @@ public:
     bool unlock_dlcs;
     bool enable_overlay;
     bool disable_online_networking;
+    bool p2p_coalesce_packets;
+    // Only used when built with zstd compression
+    uint32_t network_compress_min_size;
+    std::string network_compress_dictionary;
+    std::string network_capture_file;
+    // Storage files up to that size are read through a memory mapping, bigger ones with buffered I/O. 0 disables the mappings
+    uint64_t storage_mmap_max_size;
+    // Minimum completion latency of the callbacks, by interface (k_i*CallbackBase / 1000)
+    callback_latency_t default_callback_latency;
+    std::map<int32_t, callback_latency_t> callback_latencies;
 
     ~Settings();
 
     void load_settings();
     void save_settings();
+
+    // emu_latency is the latency the emulator would have used for that callback
+    std::chrono::milliseconds get_callback_latency(int i_callback, std::chrono::milliseconds emu_latency) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Fixed size blocks allocator.
+// Blocks are carved out of slabs of BlocksPerSlab blocks and are never given back to the system:
+// a freed block goes into a free list and is handed out by the next allocation.
+template<size_t BlockSize, size_t BlocksPerSlab = 64>
+class slab_pool
+{
+    union block_t
+    {
+        block_t* next;
+        alignas(std::max_align_t) uint8_t data[BlockSize];
+    };
+
+    std::mutex _mutex;
+    block_t* _free_list;
+    std::vector<std::unique_ptr<block_t[]>> _slabs;
+    size_t _used_blocks;
+
+public:
+    static constexpr size_t block_size = BlockSize;
+
+    slab_pool():
+        _free_list(nullptr),
+        _used_blocks(0)
+    {}
+
+    slab_pool(slab_pool const&) = delete;
+    slab_pool& operator=(slab_pool const&) = delete;
+
+    void* allocate()
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (_free_list == nullptr)
+        {
+            _slabs.emplace_back(new block_t[BlocksPerSlab]);
+            block_t* slab = _slabs.back().get();
+            for (size_t i = 0; i < BlocksPerSlab; ++i)
+            {
+                slab[i].next = _free_list;
+                _free_list = &slab[i];
+            }
+        }
+
+        block_t* block = _free_list;
+        _free_list = block->next;
+        ++_used_blocks;
+        return block->data;
+    }
+
+    void deallocate(void* p)
+    {
+        if (p == nullptr)
+            return;
+
+        std::lock_guard<std::mutex> lk(_mutex);
+        block_t* block = reinterpret_cast<block_t*>(p);
+        block->next = _free_list;
+        _free_list = block;
+        --_used_blocks;
+    }
+
+    size_t used_blocks()
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        return _used_blocks;
+    }
+
+    size_t slab_count()
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        return _slabs.size();
+    }
+};
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+// Fixed size single producer/single consumer ring buffer.
+// One thread can push while another one reads without any lock, the slots are allocated once and reused.
+template<typename T, size_t N>
+class spsc_ring
+{
+    static_assert(N != 0 && (N & (N - 1)) == 0, "spsc_ring size must be a power of 2");
+    static constexpr size_t mask = N - 1;
+
+    std::array<T, N> _slots;
+    // Keep the cursors on their own cache line so the producer and the consumer don't fight over it
+    alignas(64) std::atomic<size_t> _head; // Written by the consumer
+    alignas(64) std::atomic<size_t> _tail; // Written by the producer
+
+public:
+    spsc_ring():
+        _head(0),
+        _tail(0)
+    {}
+
+    spsc_ring(spsc_ring const&) = delete;
+    spsc_ring& operator=(spsc_ring const&) = delete;
+
+    static constexpr size_t capacity() { return N; }
+
+    size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Producer side
+    // Returns false if the ring is full, value is left untouched in that case
+    bool push(T&& value)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == N)
+            return false;
+
+        _slots[tail & mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Consumer side
+    // Returns the oldest value or nullptr if the ring is empty, the pointer is valid until pop()
+    T* front()
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &_slots[head & mask];
+    }
+
+    void pop()
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Removes the values matching pred, keeping the order of the other ones.
+    // Only the slots already published by the producer are touched, so it is safe to push meanwhile.
+    template<typename Pred>
+    size_t remove_if(Pred pred)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t write = tail;
+
+        // Walk backward and pack the kept values against the tail
+        for (size_t read = tail; read != head;)
+        {
+            --read;
+            T& slot = _slots[read & mask];
+            if (!pred(slot))
+            {
+                --write;
+                if (write != read)
+                    std::swap(_slots[write & mask], slot);
+            }
+        }
+
+        _head.store(write, std::memory_order_release);
+        return write - head;
+    }
+};
@@ -287,6 +287,14 @@ namespace PortableAPI
             /// @return Size of the received data
             ////////////
             size_t send(const void* buffer, size_t len, Socket::socket_flags flags = Socket::socket_flags::normal);
+            ////////////
+            /// @brief Sends several buffers in a single call
+            /// @param[in]  buffers The buffers to send
+            /// @param[in]  count   Number of buffers, at most Socket::max_buffers
+            /// @param[in]  flags   Send flags, defaults to Socket::socket_flags::normal
+            /// @return Size of the sent data
+            ////////////
+            size_t sendv(Socket::const_buffer const* buffers, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
     };
 
     ////////////
@@ -368,6 +376,31 @@ namespace PortableAPI
             /// @return Size of the received data
             ////////////
             size_t sendto(const basic_addr & addr, const void* buffer, size_t len, Socket::socket_flags flags = Socket::socket_flags::normal);
+            ////////////
+            /// @brief Sends several buffers to a peer as a single datagram
+            /// @param[in]  addr    Address of the peer you send to
+            /// @param[in]  buffers The buffers to send
+            /// @param[in]  count   Number of buffers, at most Socket::max_buffers
+            /// @param[in]  flags   Send flags, defaults to Socket::socket_flags::normal
+            /// @return Size of the sent data
+            ////////////
+            size_t sendtov(const basic_addr & addr, Socket::const_buffer const* buffers, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
+            ////////////
+            /// @brief Receives several datagrams in a single call, see Socket::recvfrom_batch
+            /// @param[in,out] messages The datagrams to fill
+            /// @param[in]     count    Number of messages
+            /// @param[in]     flags    Receive flags, defaults to Socket::socket_flags::normal
+            /// @return Number of received datagrams
+            ////////////
+            size_t recvfrom_batch(Socket::recv_message* messages, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
+            ////////////
+            /// @brief Sends several datagrams in as few calls as possible, see Socket::sendto_batch
+            /// @param[in,out] messages The datagrams to send
+            /// @param[in]     count    Number of messages
+            /// @param[in]     flags    Send flags, defaults to Socket::socket_flags::normal
+            /// @return Number of sent datagrams
+            ////////////
+            size_t sendto_batch(Socket::send_message* messages, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
     };
 
 #include "basic_socket.inl"
@@ -77,6 +77,12 @@ inline size_t connected_socket<Addr, family, type, proto>::send(const void* buff
     return Socket::send(*_sock, buffer, len, flags);
 }
 
+template<typename Addr, Socket::address_family family, Socket::types type, Socket::protocols proto>
+inline size_t connected_socket<Addr, family, type, proto>::sendv(Socket::const_buffer const* buffers, size_t count, Socket::socket_flags flags)
+{
+    return Socket::sendv(*_sock, buffers, count, flags);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // unconnected_socket class
 ///////////////////////////////////////////////////////////////////////////////
@@ -115,4 +121,22 @@ template<typename Addr, Socket::address_family family, Socket::types type, Socke
 size_t unconnected_socket<Addr, family, type, proto>::sendto(const basic_addr& addr, const void* buffer, size_t len, Socket::socket_flags flags)
 {
     return Socket::sendto(*_sock, addr, buffer, len, flags);
+}
+
+template<typename Addr, Socket::address_family family, Socket::types type, Socket::protocols proto>
+size_t unconnected_socket<Addr, family, type, proto>::sendtov(const basic_addr& addr, Socket::const_buffer const* buffers, size_t count, Socket::socket_flags flags)
+{
+    return Socket::sendtov(*_sock, addr, buffers, count, flags);
+}
+
+template<typename Addr, Socket::address_family family, Socket::types type, Socket::protocols proto>
+size_t unconnected_socket<Addr, family, type, proto>::recvfrom_batch(Socket::recv_message* messages, size_t count, Socket::socket_flags flags)
+{
+    return Socket::recvfrom_batch(*_sock, messages, count, flags);
+}
+
+template<typename Addr, Socket::address_family family, Socket::types type, Socket::protocols proto>
+size_t unconnected_socket<Addr, family, type, proto>::sendto_batch(Socket::send_message* messages, size_t count, Socket::socket_flags flags)
+{
+    return Socket::sendto_batch(*_sock, messages, count, flags);
 }
\ No newline at end of file
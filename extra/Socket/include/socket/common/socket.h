@@ -192,6 +192,43 @@ public:\
         /// @brief An invalid value for a socket_t type
         ////////////
         static constexpr socket_t invalid_socket = ((socket_t)(-1));
+        ////////////
+        /// @brief Maximum number of buffers in a scatter/gather call
+        ////////////
+        static constexpr size_t max_buffers = 16;
+
+        ////////////
+        /// @brief A buffer to send, used by the scatter/gather functions
+        ////////////
+        struct const_buffer
+        {
+            const void* data;
+            size_t len;
+        };
+        ////////////
+        /// @brief Maximum number of datagrams in a single batch call
+        ////////////
+        static constexpr size_t max_batch = 64;
+        ////////////
+        /// @brief A datagram to receive, used by recvfrom_batch
+        ////////////
+        struct recv_message
+        {
+            basic_addr* addr;  ///< [out] Receives the peer address
+            void* buffer;      ///< [out] Receives the datagram
+            size_t len;        ///< [in]  buffer size
+            size_t received;   ///< [out] Size of the received datagram
+        };
+        ////////////
+        /// @brief A datagram to send, used by sendto_batch
+        ////////////
+        struct send_message
+        {
+            basic_addr const* addr;      ///< [in]  The peer to send to
+            const_buffer const* buffers; ///< [in]  The datagram parts
+            size_t buffer_count;         ///< [in]  Number of parts, at most max_buffers
+            size_t sent;                 ///< [out] Size of the sent datagram
+        };
 
         ////////////
         /// @brief Network address family enum 
@@ -572,6 +609,52 @@ public:\
         ////////////
         static size_t sendto(Socket::socket_t s, basic_addr const&addr, const void* buffer, size_t len, Socket::socket_flags flags = Socket::socket_flags::normal);
         ////////////
+        /// @brief Gather version of send, the buffers are sent one after the other in a single call (sendmsg/WSASend)
+        ///        Can throw exception depending on error
+        ///        If the socket is set non-blocking and it would block, 0 is returned as size
+        /// @param[in]  s A socket with a previous successful call to 'socket'
+        /// @param[in]  buffers The buffers to send
+        /// @param[in]  count Number of buffers, at most max_buffers
+        /// @param[in]  flags send flags
+        /// @return Sent size
+        ////////////
+        static size_t sendv(Socket::socket_t s, const_buffer const* buffers, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
+        ////////////
+        /// @brief Gather version of sendto, the buffers are sent as a single datagram (sendmsg/WSASendTo)
+        ///        Can throw exception depending on error
+        /// @param[in]  s A socket with a previous successful call to 'socket'
+        /// @param[in]  addr The peer to send to address informations
+        /// @param[in]  buffers The buffers to send
+        /// @param[in]  count Number of buffers, at most max_buffers
+        /// @param[in]  flags send flags
+        /// @return Sent size
+        ////////////
+        static size_t sendtov(Socket::socket_t s, basic_addr const& addr, const_buffer const* buffers, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
+        ////////////
+        /// @brief Receives several datagrams in a single call (recvmmsg on Linux).
+        ///        Returns as soon as one datagram is available, it doesn't wait for the others.
+        ///        Other platforms fall back to a single recvfrom per call.
+        ///        Can throw exception depending on error
+        ///        If the socket is set non-blocking and it would block, 0 is returned
+        /// @param[in]  s A socket with a previous successful call to 'socket'
+        /// @param[in,out] messages The datagrams to fill
+        /// @param[in]  count Number of messages, at most max_batch are filled
+        /// @param[in]  flags receive flags
+        /// @return Number of received datagrams
+        ////////////
+        static size_t recvfrom_batch(Socket::socket_t s, recv_message* messages, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
+        ////////////
+        /// @brief Sends several datagrams, possibly to different peers, in as few calls as possible (sendmmsg on Linux).
+        ///        Other platforms fall back to one sendtov per datagram.
+        ///        Can throw exception depending on error if no datagram could be sent
+        /// @param[in]  s A socket with a previous successful call to 'socket'
+        /// @param[in,out] messages The datagrams to send
+        /// @param[in]  count Number of messages
+        /// @param[in]  flags send flags
+        /// @return Number of sent datagrams
+        ////////////
+        static size_t sendto_batch(Socket::socket_t s, send_message* messages, size_t count, Socket::socket_flags flags = Socket::socket_flags::normal);
+        ////////////
         /// @brief Wrapper for 'C' shutdown function. Shutdowns in read and/or write a socket
         /// @param[in]  s   A socket with a previous successful call to 'socket'
         /// @param[in]  how The mode(s) to shutdown, default to both (in & out)
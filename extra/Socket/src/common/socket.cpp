@@ -17,8 +17,13 @@
 
 #include "socket/common/socket.h"
 
+#include <algorithm>
+
 using namespace PortableAPI;
 
+constexpr size_t Socket::max_buffers;
+constexpr size_t Socket::max_batch;
+
 socket_exception::socket_exception() :mywhat("Socket exception") {}
 socket_exception::socket_exception(const char* mywhat) :mywhat(mywhat) {}
 socket_exception::socket_exception(std::string const& mywhat) :mywhat(mywhat) {}
@@ -312,6 +317,249 @@ size_t Socket::sendto(Socket::socket_t s, basic_addr const&addr, const void* buf
     return res;
 }
 
+size_t Socket::sendv(Socket::socket_t s, const_buffer const* buffers, size_t count, Socket::socket_flags flags)
+{
+    if (count > max_buffers)
+        throw error_in_value("Too many buffers.");
+
+#if defined(UTILS_OS_WINDOWS)
+    WSABUF bufs[max_buffers];
+    for (size_t i = 0; i < count; ++i)
+    {
+        bufs[i].buf = reinterpret_cast<char*>(const_cast<void*>(buffers[i].data));
+        bufs[i].len = static_cast<ULONG>(buffers[i].len);
+    }
+
+    DWORD sent = 0;
+    int res = ::WSASend(s, bufs, static_cast<DWORD>(count), &sent, static_cast<DWORD>(flags), nullptr, nullptr);
+    if (res == 0)
+        res = static_cast<int>(sent);
+    else
+        res = -1;
+#elif defined(UTILS_OS_LINUX) || defined(UTILS_OS_APPLE)
+    iovec iov[max_buffers];
+    for (size_t i = 0; i < count; ++i)
+    {
+        iov[i].iov_base = const_cast<void*>(buffers[i].data);
+        iov[i].iov_len = buffers[i].len;
+    }
+
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    int res = static_cast<int>(::sendmsg(s, &msg, static_cast<int32_t>(flags)));
+#endif
+
+    if (res == -1)
+    {
+#if defined(UTILS_OS_WINDOWS)
+        int32_t error = WSAGetLastError();
+#elif defined(UTILS_OS_LINUX) || defined(UTILS_OS_APPLE)
+        int32_t error = errno;
+#endif
+        switch (error)
+        {
+#if defined(UTILS_OS_WINDOWS)
+            case WSANOTINITIALISED: throw wsa_not_initialised();
+            case WSAENETDOWN: throw wsa_net_down();
+            case WSAENOTCONN: throw not_connected();
+            case WSAEWOULDBLOCK: res = 0; break;
+            case WSAECONNABORTED: throw connection_reset();
+#elif defined(UTILS_OS_LINUX) || defined(UTILS_OS_APPLE)
+            case ENOTCONN: throw not_connected();
+    #if EAGAIN != EWOULDBLOCK
+            case EAGAIN:
+    #endif
+            case EWOULDBLOCK: res = 0; break;
+#endif
+            default: throw socket_exception("sendv exception: " + std::to_string(error));
+        }
+    }
+    return res;
+}
+
+size_t Socket::sendtov(Socket::socket_t s, basic_addr const& addr, const_buffer const* buffers, size_t count, Socket::socket_flags flags)
+{
+    if (count > max_buffers)
+        throw error_in_value("Too many buffers.");
+
+#if defined(UTILS_OS_WINDOWS)
+    WSABUF bufs[max_buffers];
+    for (size_t i = 0; i < count; ++i)
+    {
+        bufs[i].buf = reinterpret_cast<char*>(const_cast<void*>(buffers[i].data));
+        bufs[i].len = static_cast<ULONG>(buffers[i].len);
+    }
+
+    DWORD sent = 0;
+    int res = ::WSASendTo(s, bufs, static_cast<DWORD>(count), &sent, static_cast<DWORD>(flags), &addr.addr(), static_cast<int>(addr.len()), nullptr, nullptr);
+    if (res == 0)
+        res = static_cast<int>(sent);
+    else
+        res = -1;
+#elif defined(UTILS_OS_LINUX) || defined(UTILS_OS_APPLE)
+    iovec iov[max_buffers];
+    for (size_t i = 0; i < count; ++i)
+    {
+        iov[i].iov_base = const_cast<void*>(buffers[i].data);
+        iov[i].iov_len = buffers[i].len;
+    }
+
+    msghdr msg{};
+    msg.msg_name = const_cast<sockaddr*>(&addr.addr());
+    msg.msg_namelen = static_cast<socklen_t>(addr.len());
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    int res = static_cast<int>(::sendmsg(s, &msg, static_cast<int32_t>(flags)));
+#endif
+
+    if (res == -1)
+    {
+#if defined(UTILS_OS_WINDOWS)
+        int32_t error = WSAGetLastError();
+#elif defined(UTILS_OS_LINUX) || defined(UTILS_OS_APPLE)
+        int32_t error = errno;
+#endif
+        switch (error)
+        {
+#if defined(UTILS_OS_WINDOWS)
+            case WSANOTINITIALISED: throw wsa_not_initialised();
+            case WSAENETDOWN: throw wsa_net_down();
+            case WSAENETUNREACH: throw network_unreachable();
+#elif defined(UTILS_OS_LINUX) || defined(UTILS_OS_APPLE)
+            case ENETUNREACH: throw network_unreachable();
+#endif
+            default: throw socket_exception("sendtov exception: " + std::to_string(error));
+        }
+    }
+    return res;
+}
+
+size_t Socket::recvfrom_batch(Socket::socket_t s, recv_message* messages, size_t count, Socket::socket_flags flags)
+{
+    if (count == 0)
+        return 0;
+
+#if defined(UTILS_OS_LINUX)
+    count = std::min(count, max_batch);
+
+    mmsghdr hdrs[max_batch];
+    iovec iovs[max_batch];
+    for (size_t i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = messages[i].buffer;
+        iovs[i].iov_len = messages[i].len;
+
+        hdrs[i].msg_hdr = msghdr{};
+        hdrs[i].msg_hdr.msg_name = &messages[i].addr->addr();
+        hdrs[i].msg_hdr.msg_namelen = static_cast<socklen_t>(messages[i].addr->len());
+        hdrs[i].msg_hdr.msg_iov = &iovs[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+        hdrs[i].msg_len = 0;
+    }
+
+    // MSG_WAITFORONE: only block for the first datagram
+    int res = ::recvmmsg(s, hdrs, static_cast<unsigned int>(count), static_cast<int32_t>(flags) | MSG_WAITFORONE, nullptr);
+    if (res == -1)
+    {
+        int32_t error = errno;
+        switch (error)
+        {
+            case EINVAL: throw error_in_value("The socket is not bound to an address.");
+    #if EAGAIN != EWOULDBLOCK
+            case EAGAIN:
+    #endif
+            case EWOULDBLOCK: return 0;
+            default: throw socket_exception("recvmmsg exception: " + std::to_string(error));
+        }
+    }
+
+    for (int i = 0; i < res; ++i)
+        messages[i].received = hdrs[i].msg_len;
+
+    return static_cast<size_t>(res);
+#else
+    messages[0].received = recvfrom(s, *messages[0].addr, messages[0].buffer, messages[0].len, flags);
+    return messages[0].received == 0 ? 0 : 1;
+#endif
+}
+
+size_t Socket::sendto_batch(Socket::socket_t s, send_message* messages, size_t count, Socket::socket_flags flags)
+{
+#if defined(UTILS_OS_LINUX)
+    mmsghdr hdrs[max_batch];
+    iovec iovs[max_batch * max_buffers];
+    size_t sent = 0;
+
+    while (sent < count)
+    {
+        size_t batch_count = std::min(count - sent, max_batch);
+        for (size_t i = 0; i < batch_count; ++i)
+        {
+            send_message& message = messages[sent + i];
+            if (message.buffer_count > max_buffers)
+                throw error_in_value("Too many buffers.");
+
+            iovec* iov = &iovs[i * max_buffers];
+            for (size_t j = 0; j < message.buffer_count; ++j)
+            {
+                iov[j].iov_base = const_cast<void*>(message.buffers[j].data);
+                iov[j].iov_len = message.buffers[j].len;
+            }
+
+            hdrs[i].msg_hdr = msghdr{};
+            hdrs[i].msg_hdr.msg_name = const_cast<sockaddr*>(&message.addr->addr());
+            hdrs[i].msg_hdr.msg_namelen = static_cast<socklen_t>(message.addr->len());
+            hdrs[i].msg_hdr.msg_iov = iov;
+            hdrs[i].msg_hdr.msg_iovlen = message.buffer_count;
+            hdrs[i].msg_len = 0;
+        }
+
+        int res = ::sendmmsg(s, hdrs, static_cast<unsigned int>(batch_count), static_cast<int32_t>(flags));
+        if (res == -1)
+        {
+            if (sent != 0)
+                break;
+
+            int32_t error = errno;
+            switch (error)
+            {
+                case ENETUNREACH: throw network_unreachable();
+                default: throw socket_exception("sendmmsg exception: " + std::to_string(error));
+            }
+        }
+
+        for (int i = 0; i < res; ++i)
+            messages[sent + i].sent = hdrs[i].msg_len;
+
+        sent += res;
+        if (static_cast<size_t>(res) != batch_count)
+        {// The next datagram failed, let the caller decide what to do
+            break;
+        }
+    }
+
+    return sent;
+#else
+    for (size_t i = 0; i < count; ++i)
+    {
+        try
+        {
+            messages[i].sent = sendtov(s, *messages[i].addr, messages[i].buffers, messages[i].buffer_count, flags);
+        }
+        catch (...)
+        {
+            if (i == 0)
+                throw;
+
+            return i;
+        }
+    }
+
+    return count;
+#endif
+}
+
 int Socket::shutdown(Socket::socket_t s, Socket::shutdown_flags how)
 {
     return ::shutdown(s, static_cast<int32_t>(how));
@@ -249,6 +249,36 @@ int test_tcp()
         std::cerr << __LINE__ << " Failed to send: " << e.what() << std::endl;
         return -1;
     }
+    try {
+        Socket::const_buffer buffers[] = { { "Hello ", 6 }, { "from client1 gather", 20 } };
+        size_t res = client1.sendv(buffers, 2);
+        size_t expected = 26;
+        if (res != expected) {
+            std::cerr << __LINE__ << " Failed to sendv the data: sent " << res << ", wanted " << expected << std::endl;
+            return -1;
+        }
+
+        std::cerr << __LINE__ << " sendv successful" << std::endl;
+    }
+    catch (socket_exception& e) {
+        std::cerr << __LINE__ << " Failed to sendv: " << e.what() << std::endl;
+        return -1;
+    }
+    try {
+        std::vector<uint8_t> buffer(4096, 0);
+        size_t res = client2.recv(&buffer[0], buffer.size());
+        std::string expected("Hello from client1 gather");
+        if (res != expected.length() + 1 || expected != (const char*)(buffer.data())) {
+            std::cerr << __LINE__ << " Failed to recv the gathered data: recv " << res << ", wanted " << expected.length() + 1 << std::endl;
+            return -1;
+        }
+
+        std::cerr << __LINE__ << " recv successful: " << (const char*)(buffer.data()) << std::endl;
+    }
+    catch (socket_exception& e) {
+        std::cerr << __LINE__ << " Failed to recv: " << e.what() << std::endl;
+        return -1;
+    }
 
     return 0;
 }
@@ -298,6 +328,91 @@ int test_udp()
         std::cerr << __LINE__ << " Failed to recvfrom: " << e.what() << std::endl;
         return -1;
     }
+    try {
+        // addr now holds sock2 address, rebuild sock1 address
+        ipv4_addr sock1_addr;
+        sock1_addr.set_loopback_addr();
+        sock1_addr.set_port(45678);
+
+        Socket::const_buffer buffers[] = { { "Hello ", 6 }, { "from ", 5 }, { "sock2 gather", 13 } };
+        size_t res = sock2.sendtov(sock1_addr, buffers, 3);
+        size_t expected = 24;
+        if (res != expected) {
+            std::cerr << __LINE__ << " Failed to sendtov the data: sent " << res << ", wanted " << expected << std::endl;
+            return -1;
+        }
+
+        std::cerr << __LINE__ << " sendtov successful" << std::endl;
+    }
+    catch (socket_exception& e) {
+        std::cerr << __LINE__ << " Failed to sendtov: " << e.what() << std::endl;
+        return -1;
+    }
+    try {
+        std::vector<uint8_t> buff(4096, 0);
+        size_t res = sock1.recvfrom(remote_addr, &buff[0], buff.size());
+        std::string expected("Hello from sock2 gather");
+        if (res != expected.length() + 1 || expected != (const char*)(buff.data())) {
+            std::cerr << __LINE__ << " Failed to recvfrom the gathered data: received " << res << " bytes, wanted " << expected.length() + 1 << std::endl;
+            return -1;
+        }
+
+        std::cerr << __LINE__ << " recvfrom " << remote_addr.to_string(true) << " successful: " << (const char*)(buff.data()) << std::endl;
+    }
+    catch (socket_exception& e) {
+        std::cerr << __LINE__ << " Failed to recvfrom: " << e.what() << std::endl;
+        return -1;
+    }
+    try {
+        ipv4_addr sock1_addr;
+        sock1_addr.set_loopback_addr();
+        sock1_addr.set_port(45678);
+
+        Socket::const_buffer buffers[] = { { "batch 0", 8 }, { "batch 1", 8 }, { "batch 2", 8 } };
+        Socket::send_message messages[] = {
+            { &sock1_addr, &buffers[0], 1, 0 },
+            { &sock1_addr, &buffers[1], 1, 0 },
+            { &sock1_addr, &buffers[2], 1, 0 },
+        };
+        size_t res = sock2.sendto_batch(messages, 3);
+        size_t expected = 3;
+        if (res != expected || messages[2].sent != 8) {
+            std::cerr << __LINE__ << " Failed to sendto_batch the data: sent " << res << " datagrams, wanted " << expected << std::endl;
+            return -1;
+        }
+
+        std::cerr << __LINE__ << " sendto_batch successful" << std::endl;
+    }
+    catch (socket_exception& e) {
+        std::cerr << __LINE__ << " Failed to sendto_batch: " << e.what() << std::endl;
+        return -1;
+    }
+    try {
+        std::vector<uint8_t> buff(3 * 64, 0);
+        ipv4_addr addrs[3];
+        Socket::recv_message messages[3];
+        for (int i = 0; i < 3; ++i)
+            messages[i] = { &addrs[i], &buff[i * 64], 64, 0 };
+
+        // The fallback platforms return one datagram per call
+        size_t received = 0;
+        while (received < 3)
+            received += sock1.recvfrom_batch(&messages[received], 3 - received);
+
+        for (int i = 0; i < 3; ++i) {
+            std::string expected = "batch " + std::to_string(i);
+            if (messages[i].received != 8 || expected != (const char*)(messages[i].buffer)) {
+                std::cerr << __LINE__ << " Failed to recvfrom_batch the data: datagram " << i << " is " << (const char*)(messages[i].buffer) << ", wanted " << expected << std::endl;
+                return -1;
+            }
+        }
+
+        std::cerr << __LINE__ << " recvfrom_batch " << addrs[0].to_string(true) << " successful" << std::endl;
+    }
+    catch (socket_exception& e) {
+        std::cerr << __LINE__ << " Failed to recvfrom_batch: " << e.what() << std::endl;
+        return -1;
+    }
 
     return 0;
 }
@@ -255,6 +255,34 @@ bool FileManager::exists(std::string const& _path)
     return attrs != INVALID_FILE_ATTRIBUTES;
 }
 
+bool FileManager::file_info(std::string const& _path, file_info_t& info)
+{
+    std::string path(canonical_path(_path));
+    std::wstring wpath;
+    utf8::utf8to16(path.begin(), path.end(), std::back_inserter(wpath));
+
+    // Don't ask for any access right, we only want the metadata
+    HANDLE hFile = CreateFileW(wpath.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    BY_HANDLE_FILE_INFORMATION file_infos;
+    BOOL res = GetFileInformationByHandle(hFile, &file_infos);
+    CloseHandle(hFile);
+
+    if (res == FALSE || (file_infos.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
+        return false;
+
+    info.size = (uint64_t(file_infos.nFileSizeHigh) << 32) | file_infos.nFileSizeLow;
+    // FILETIME counts 100 nanoseconds since 1601, move it to the unix epoch like the other platforms before scaling so it fits in an int64_t
+    constexpr uint64_t filetime_unix_epoch = 116444736000000000ull;
+    uint64_t filetime = (uint64_t(file_infos.ftLastWriteTime.dwHighDateTime) << 32) | file_infos.ftLastWriteTime.dwLowDateTime;
+    info.mtime = (int64_t(filetime) - int64_t(filetime_unix_epoch)) * 100;
+    info.inode = (uint64_t(file_infos.nFileIndexHigh) << 32) | file_infos.nFileIndexLow;
+
+    return true;
+}
+
 bool FileManager::create_directory(std::string const& _directory, bool recursive)
 {
     size_t pos = 0;
@@ -307,6 +335,36 @@ bool FileManager::delete_file(std::string const& _path)
     return DeleteFileW(wpath.c_str()) == TRUE || GetLastError() == ERROR_FILE_NOT_FOUND;
 }
 
+bool FileManager::sync_file(std::string const& _path)
+{
+    std::string path(canonical_path(_path));
+    std::wstring wpath;
+
+    utf8::utf8to16(path.begin(), path.end(), std::back_inserter(wpath));
+
+    HANDLE hFile = CreateFileW(wpath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    BOOL res = FlushFileBuffers(hFile);
+    CloseHandle(hFile);
+    return res != FALSE;
+}
+
+bool FileManager::rename_file(std::string const& _from, std::string const& _to)
+{
+    std::string from(canonical_path(_from));
+    std::string to(canonical_path(_to));
+    std::wstring wfrom;
+    std::wstring wto;
+
+    utf8::utf8to16(from.begin(), from.end(), std::back_inserter(wfrom));
+    utf8::utf8to16(to.begin(), to.end(), std::back_inserter(wto));
+
+    create_directory(dirname(_to));
+    return MoveFileExW(wfrom.c_str(), wto.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+}
+
 static std::vector<std::wstring> list_files(std::wstring const& path, bool recursive)
 {
     std::vector<std::wstring> files;
@@ -499,6 +557,24 @@ bool FileManager::exists(std::string const& _path)
     return stat(path.c_str(), &sb) == 0;
 }
 
+bool FileManager::file_info(std::string const& _path, file_info_t& info)
+{
+    std::string path(canonical_path(_path));
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode))
+        return false;
+
+    info.size = sb.st_size;
+#if defined(__APPLE__)
+    info.mtime = int64_t(sb.st_mtimespec.tv_sec) * 1000000000 + sb.st_mtimespec.tv_nsec;
+#else
+    info.mtime = int64_t(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+#endif
+    info.inode = sb.st_ino;
+
+    return true;
+}
+
 bool FileManager::create_directory(std::string const& _directory, bool recursive)
 {
     size_t pos = 0;
@@ -535,6 +611,27 @@ bool FileManager::delete_file(std::string const& _path)
     return unlink(path.c_str()) == 0;
 }
 
+bool FileManager::sync_file(std::string const& _path)
+{
+    std::string path(canonical_path(_path));
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd == -1)
+        return false;
+
+    bool res = (fsync(fd) == 0);
+    close(fd);
+    return res;
+}
+
+bool FileManager::rename_file(std::string const& _from, std::string const& _to)
+{
+    std::string from(canonical_path(_from));
+    std::string to(canonical_path(_to));
+
+    create_directory(dirname(_to));
+    return rename(from.c_str(), to.c_str()) == 0;
+}
+
 std::vector<std::string> FileManager::list_files(std::string const& path, bool recursive)
 {
     std::vector<std::string> files;
@@ -40,6 +40,13 @@ public:
     constexpr static char separator = '/';
 #endif
 
+    struct file_info_t
+    {
+        uint64_t size;
+        int64_t mtime; // Last write time, in nanoseconds
+        uint64_t inode; // The file index on Windows
+    };
+
     ~FileManager();
 
     static std::string clean_path(std::string const& path);
@@ -75,9 +82,15 @@ public:
     static time_t file_atime(std::string const& path);
     static time_t file_mtime(std::string const& path);
     static time_t file_ctime(std::string const& path);
+    // Size, mtime and inode of a regular file in one call, returns false if it's not a regular file
+    static bool file_info(std::string const& path, file_info_t& info);
 
     static bool create_directory(std::string const& directory, bool recursive = true);
     static bool delete_file(std::string const& path);
+    // Flushes the file data to the disk (fsync)
+    static bool sync_file(std::string const& path);
+    // Moves from over to, replacing it atomically if it exists. Both must be on the same volume
+    static bool rename_file(std::string const& from, std::string const& to);
     static std::vector<std::string> list_files(std::string const& path, bool recursive = false);
 
     // std::ios::in is always appended to open_mode
@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Broadcasts a lobby update to peers on the loopback with the per peer loop UDPSendToAllPeers and TCPSendToAllPeers
+// used to run, and with the shared body they run now. Prints the serializations, the serialized bytes,
+// the send syscalls and the time per broadcast. The TCP times include reading the peers side.
+//   fanout_bench [peer_count]
+// Both paths are copied here without compression and with string ids, Network itself needs the whole emulator.
+// The syscalls are counted per call: sendto and sendv are one each, sendto_batch is one sendmmsg per Socket::max_batch
+// datagrams on Linux and one WSASendTo per datagram elsewhere.
+
+#include "network.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace PortableAPI;
+using clock_type = std::chrono::steady_clock;
+
+static constexpr int default_peer_count = 64;
+static constexpr int broadcasts = 2000;
+static constexpr uint16_t base_port = 47600;
+
+struct fanout_stats
+{
+    uint64_t message_serializations = 0;
+    uint64_t header_serializations = 0;
+    uint64_t serialized_bytes = 0;
+    uint64_t syscalls = 0;
+    double elapsed_ms = 0;
+};
+
+struct udp_peer
+{
+    Network::peer_t id;
+    ipv4_addr addr;
+};
+
+struct tcp_peer
+{
+    Network::peer_t id;
+    tcp_socket out;
+    tcp_socket in;
+};
+
+static void count_serialization(fanout_stats& stats, std::string const& buffer, bool header)
+{
+    ++(header ? stats.header_serializations : stats.message_serializations);
+    stats.serialized_bytes += buffer.length();
+}
+
+static int64_t now_timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// The loops before the shared body: the whole message is serialized for every peer and sent on its own
+static void udp_per_peer(udp_socket& sock, std::vector<udp_peer> const& peers, Network_Message_pb& msg, fanout_stats& stats)
+{
+    for (auto& peer : peers)
+    {
+        msg.set_dest_id(peer.id);
+        msg.set_timestamp(now_timestamp());
+
+        std::string buffer;
+        msg.SerializeToString(&buffer);
+        count_serialization(stats, buffer, false);
+
+        sock.sendto(peer.addr, buffer.data(), buffer.length());
+        ++stats.syscalls;
+    }
+}
+
+static void tcp_per_peer(std::vector<tcp_peer>& peers, Network_Message_pb& msg, fanout_stats& stats)
+{
+    for (auto& peer : peers)
+    {
+        msg.set_dest_id(peer.id);
+        msg.set_timestamp(now_timestamp());
+
+        std::string buffer(sizeof(Network::next_packet_size_t), 0);
+        std::string data = msg.SerializeAsString();
+        count_serialization(stats, data, false);
+        buffer += data;
+
+        Network::next_packet_size_t size = utils::Endian::net_swap(static_cast<Network::next_packet_size_t>(data.length()));
+        memcpy(&buffer[0], &size, sizeof(size));
+
+        peer.out.send(buffer.data(), buffer.length());
+        ++stats.syscalls;
+    }
+}
+
+// Network::serialize_message_body/serialize_message_header: the body once, a header with the destination and the timestamp per peer
+static void serialize_body(Network_Message_pb& msg, std::string& body, fanout_stats& stats)
+{
+    msg.clear_dest_id();
+    msg.clear_timestamp();
+    msg.SerializeToString(&body);
+    count_serialization(stats, body, false);
+}
+
+static void serialize_header(Network::peer_t const& dest_id, int64_t timestamp, std::string& header, fanout_stats& stats)
+{
+    Network_Message_pb msg_header;
+    msg_header.set_dest_id(dest_id);
+    msg_header.set_timestamp(timestamp);
+    msg_header.SerializeToString(&header);
+    count_serialization(stats, header, true);
+}
+
+static void udp_shared_body(udp_socket& sock, std::vector<udp_peer> const& peers, Network_Message_pb& msg, fanout_stats& stats)
+{
+    int64_t timestamp = now_timestamp();
+    std::string body;
+    serialize_body(msg, body, stats);
+
+    std::vector<std::string> headers(peers.size());
+    std::vector<Socket::const_buffer> buffers(peers.size() * 2);
+    std::vector<Socket::send_message> messages;
+    messages.reserve(peers.size());
+
+    for (size_t i = 0; i < peers.size(); ++i)
+    {
+        serialize_header(peers[i].id, timestamp, headers[i], stats);
+        buffers[i * 2]     = { headers[i].data(), headers[i].length() };
+        buffers[i * 2 + 1] = { body.data()      , body.length()       };
+        messages.emplace_back(Socket::send_message{ &peers[i].addr, &buffers[i * 2], 2, 0 });
+    }
+
+    for (size_t first = 0; first < messages.size();)
+    {
+        size_t sent = sock.sendto_batch(&messages[first], messages.size() - first);
+#if defined(UTILS_OS_LINUX)
+        stats.syscalls += (sent + Socket::max_batch - 1) / Socket::max_batch;
+#else
+        stats.syscalls += sent;
+#endif
+        first += sent + 1;
+    }
+}
+
+static void tcp_shared_body(std::vector<tcp_peer>& peers, Network_Message_pb& msg, fanout_stats& stats)
+{
+    int64_t timestamp = now_timestamp();
+    std::string body;
+    std::string header;
+    serialize_body(msg, body, stats);
+
+    for (auto& peer : peers)
+    {
+        serialize_header(peer.id, timestamp, header, stats);
+
+        Network::next_packet_size_t packet_size = utils::Endian::net_swap(static_cast<Network::next_packet_size_t>(header.length() + body.length()));
+        Socket::const_buffer buffers[] = {
+            { &packet_size , sizeof(packet_size) },
+            { header.data(), header.length()     },
+            { body.data()  , body.length()       },
+        };
+
+        peer.out.sendv(buffers, 3);
+        ++stats.syscalls;
+    }
+}
+
+// Keeps the TCP receive buffers from filling up, the send would block
+static void drain(std::vector<tcp_peer>& peers, std::vector<uint8_t>& buffer)
+{
+    for (auto& peer : peers)
+    {
+        unsigned long count = 0;
+        while (Socket::ioctlsocket(peer.in.get_native_socket(), Socket::cmd_name::fionread, &count) == 0 && count > 0)
+        {
+            buffer.resize(std::max<size_t>(buffer.size(), count));
+            peer.in.recv(buffer.data(), count);
+        }
+    }
+}
+
+static Network_Message_pb build_lobby_update()
+{
+    Network_Message_pb msg;
+    msg.set_source_id("0123456789abcdef0123456789abcdef");
+    msg.set_game_id("bench");
+
+    Lobby_Update_pb* update = msg.mutable_lobby()->mutable_lobby_update();
+    update->set_lobby_id("fedcba9876543210fedcba9876543210");
+    update->set_max_lobby_member(64);
+    for (int i = 0; i < 16; ++i)
+    {
+        Lobby_Attribute& attr = (*update->mutable_attributes())["attribute_" + std::to_string(i)];
+        attr.set_visibility_type(0);
+        attr.mutable_value()->set_s("value_" + std::to_string(i));
+    }
+
+    return msg;
+}
+
+static std::string make_peer_id(int i)
+{
+    char id[33];
+    snprintf(id, sizeof(id), "%032x", i + 1);
+    return id;
+}
+
+template<typename Peers, typename Send>
+static fanout_stats run(Peers& peers, Send&& send)
+{
+    fanout_stats stats;
+    Network_Message_pb msg = build_lobby_update();
+
+    auto start = clock_type::now();
+    for (int i = 0; i < broadcasts; ++i)
+        send(peers, msg, stats);
+    stats.elapsed_ms = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+
+    return stats;
+}
+
+static void print(char const* name, fanout_stats const& stats)
+{
+    std::cout << "  " << name
+              << ": " << double(stats.message_serializations) / broadcasts << " message + "
+              << double(stats.header_serializations) / broadcasts << " header serializations, "
+              << double(stats.serialized_bytes) / broadcasts << " bytes serialized, "
+              << double(stats.syscalls) / broadcasts << " syscalls, "
+              << stats.elapsed_ms * 1000 / broadcasts << " us per broadcast" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int peer_count = (argc > 1 ? atoi(argv[1]) : default_peer_count);
+    if (peer_count <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [peer_count]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        Socket::InitSocket();
+
+        udp_socket udp_sender;
+        std::vector<udp_socket> udp_receivers(peer_count);
+        std::vector<udp_peer> udp_peers(peer_count);
+        uint16_t port = base_port;
+        for (int i = 0; i < peer_count; ++i)
+        {
+            udp_peers[i].id = make_peer_id(i);
+            udp_peers[i].addr.set_loopback_addr();
+            for (;; ++port)
+            {// Unread datagrams are dropped by the receivers, the sends never block
+                try
+                {
+                    udp_peers[i].addr.set_port(port);
+                    udp_receivers[i].bind(udp_peers[i].addr);
+                    ++port;
+                    break;
+                }
+                catch (socket_exception&)
+                {}
+            }
+        }
+
+        tcp_socket listener;
+        ipv4_addr listen_addr;
+        listen_addr.set_loopback_addr();
+        for (;; ++port)
+        {
+            try
+            {
+                listen_addr.set_port(port);
+                listener.bind(listen_addr);
+                listener.listen(peer_count);
+                break;
+            }
+            catch (socket_exception&)
+            {}
+        }
+
+        std::vector<tcp_peer> tcp_peers(peer_count);
+        for (int i = 0; i < peer_count; ++i)
+        {
+            tcp_peers[i].id = make_peer_id(i);
+            tcp_peers[i].out.connect(listen_addr);
+            tcp_peers[i].in = listener.accept();
+        }
+
+        std::vector<uint8_t> drain_buffer;
+        std::cout << peer_count << " peers, " << broadcasts << " broadcasts" << std::endl;
+
+        std::cout << "UDPSendToAllPeers:" << std::endl;
+        print("per peer   ", run(udp_peers, [&](std::vector<udp_peer>& peers, Network_Message_pb& msg, fanout_stats& stats) { udp_per_peer(udp_sender, peers, msg, stats); }));
+        print("shared body", run(udp_peers, [&](std::vector<udp_peer>& peers, Network_Message_pb& msg, fanout_stats& stats) { udp_shared_body(udp_sender, peers, msg, stats); }));
+
+        std::cout << "TCPSendToAllPeers:" << std::endl;
+        print("per peer   ", run(tcp_peers, [&](std::vector<tcp_peer>& peers, Network_Message_pb& msg, fanout_stats& stats) { tcp_per_peer(peers, msg, stats); drain(peers, drain_buffer); }));
+        print("shared body", run(tcp_peers, [&](std::vector<tcp_peer>& peers, Network_Message_pb& msg, fanout_stats& stats) { tcp_shared_body(peers, msg, stats); drain(peers, drain_buffer); }));
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Socket error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
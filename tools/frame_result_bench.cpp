@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Creates and frees FrameResults like an api call does, with the heap allocated results and parameters
+// FrameResult used to have and with its slab pools, then prints the heap allocations and the time per cycle.
+//   frame_result_bench [cycles]
+// The heap allocations are counted by replacing the global operator new. The pools take a slab from the heap
+// now and then, the pooled numbers are taken once they are warm.
+// It links the emulator for the callback latency settings: like the emulator, it reads (or writes a default)
+// NemirtingasEpicEmu.json next to the executable.
+
+#include "frame_result.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+using clock_type = std::chrono::steady_clock;
+
+static constexpr int default_cycles = 100000;
+
+static std::atomic<uint64_t> heap_allocations(0);
+
+void* operator new(size_t size)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = malloc(size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+// FrameResult before the pools: a std::shared_ptr to a heap allocated result, its parameter allocated with new[]
+class legacy_frame_result
+{
+    std::chrono::milliseconds ok_timeout;
+    bool remove_on_timeout;
+    CallbackMessage_t res;
+
+public:
+    const std::chrono::time_point<std::chrono::steady_clock> created_time;
+    bool done;
+
+    legacy_frame_result():
+        ok_timeout(std::chrono::milliseconds(0)),
+        remove_on_timeout(true),
+        res({}),
+        created_time(std::chrono::steady_clock::now()),
+        done(false)
+    {}
+
+    ~legacy_frame_result()
+    {
+        delete[] res.func_param;
+    }
+
+    template<typename T>
+    inline T& CreateCallback(CallbackObj func, std::chrono::milliseconds ok_timeout = std::chrono::milliseconds(100))
+    {
+        delete[] res.func_param;
+        this->ok_timeout = ok_timeout;
+        res.cb_func = func;
+        res.callback_type_id = T::k_iCallback;
+        res.func_param_size = sizeof(T);
+        res.func_param = new uint8_t[sizeof(T)];
+        return *new (res.func_param) T;
+    }
+};
+
+static void EOS_CALL on_query_complete(EOS_Achievements_OnQueryDefinitionsCompleteCallbackInfo const* data)
+{
+    (void)data;
+}
+
+struct cycle_stats
+{
+    uint64_t heap_allocations;
+    double elapsed_ms;
+};
+
+template<typename Cycle>
+static cycle_stats run(int cycles, Cycle&& cycle)
+{
+    // Warms the pools up, a game keeps about this many results alive
+    for (int i = 0; i < 64; ++i)
+        cycle(i);
+
+    uint64_t allocations = heap_allocations.load(std::memory_order_relaxed);
+    auto start = clock_type::now();
+    for (int i = 0; i < cycles; ++i)
+        cycle(i);
+
+    return cycle_stats{
+        heap_allocations.load(std::memory_order_relaxed) - allocations,
+        std::chrono::duration<double, std::milli>(clock_type::now() - start).count()
+    };
+}
+
+static void print(char const* name, cycle_stats const& stats, int cycles)
+{
+    std::cout << "  " << name << ": " << stats.heap_allocations << " heap allocations ("
+              << double(stats.heap_allocations) / cycles << " per cycle), "
+              << stats.elapsed_ms * 1000000 / cycles << " ns per cycle" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int cycles = (argc > 1 ? atoi(argv[1]) : default_cycles);
+    if (cycles <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [cycles]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << cycles << " create/free cycles" << std::endl;
+
+    print("shared_ptr and new[]", run(cycles, [](int i)
+    {
+        std::shared_ptr<legacy_frame_result> res(new legacy_frame_result);
+        auto& oqdcci = res->CreateCallback<EOS_Achievements_OnQueryDefinitionsCompleteCallbackInfo>((CallbackFunc)on_query_complete);
+        oqdcci.ClientData = reinterpret_cast<void*>(static_cast<intptr_t>(i));
+        oqdcci.ResultCode = EOS_EResult::EOS_Success;
+    }), cycles);
+
+    print("slab pools          ", run(cycles, [](int i)
+    {
+        pFrameResult_t res(new FrameResult);
+        auto& oqdcci = res->CreateCallback<EOS_Achievements_OnQueryDefinitionsCompleteCallbackInfo>((CallbackFunc)on_query_complete);
+        oqdcci.ClientData = reinterpret_cast<void*>(static_cast<intptr_t>(i));
+        oqdcci.ResultCode = EOS_EResult::EOS_Success;
+    }), cycles);
+
+    return EXIT_SUCCESS;
+}
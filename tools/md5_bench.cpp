@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Checks md5_multi against the MD5 class, then prints the scalar and multi-buffer hashing throughputs.
+//   md5_bench [file_count] [file_size_mb]
+// The digests are checked on files sized around the MD5 padding boundaries and around the md5_multi read chunks,
+// alone and mixed in the same lanes. The throughput files are written first, they are hashed from the page cache.
+// The test files are written in md5_bench_files/, in the current directory, and deleted at the end.
+
+#include "md5.h"
+#include "md5_multi.h"
+#include "file_manager.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using clock_type = std::chrono::steady_clock;
+
+static constexpr int default_file_count = 32;
+static constexpr int default_file_size_mb = 4;
+static constexpr int iterations = 3;
+// md5_multi reads the files in chunks of this size
+static constexpr size_t chunk_size = 64 * 1024;
+static constexpr char work_dir[] = "md5_bench_files";
+
+static std::string make_content(size_t size, uint32_t seed)
+{
+    std::string content(size, '\0');
+    uint32_t x = seed * 2654435761u + 1;
+    for (auto& c : content)
+    {// xorshift32
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        c = static_cast<char>(x);
+    }
+
+    return content;
+}
+
+static bool write_file(std::string const& path, std::string const& content)
+{
+    std::ofstream file = FileManager::open_write(path, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), content.length());
+    return static_cast<bool>(file);
+}
+
+static std::vector<size_t> boundary_sizes()
+{
+    std::vector<size_t> sizes;
+    // The padding needs 9 bytes: 55 bytes fit in one block, 56 need a second one
+    for (size_t block : { size_t(0), size_t(64), size_t(128) })
+    {
+        for (size_t offset : { 0, 1, 55, 56, 57, 63 })
+            sizes.emplace_back(block + offset);
+    }
+
+    for (size_t chunks : { size_t(1), size_t(2), size_t(3) })
+    {
+        for (int offset : { -65, -64, -57, -56, -55, -1, 0, 1, 55, 56, 64 })
+            sizes.emplace_back(chunks * chunk_size + offset);
+    }
+
+    return sizes;
+}
+
+// Every file alone, then all of them at once: the lanes finish at different blocks and get refilled
+static bool check_digests()
+{
+    std::vector<size_t> sizes = boundary_sizes();
+    std::vector<std::string> paths;
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        std::string content = make_content(sizes[i], static_cast<uint32_t>(i));
+        paths.emplace_back("check_" + std::to_string(i));
+        expected.emplace_back(MD5(content).hexdigest());
+        if (!write_file(paths.back(), content))
+        {
+            std::cerr << "Failed to write " << paths.back() << std::endl;
+            return false;
+        }
+    }
+
+    bool ok = true;
+    auto check = [&](char const* name, size_t i, std::string const& digest)
+    {
+        if (digest != expected[i])
+        {
+            std::cerr << name << " mismatch on " << sizes[i] << " bytes: " << digest << " instead of " << expected[i] << std::endl;
+            ok = false;
+        }
+    };
+
+    for (size_t i = 0; i < paths.size(); ++i)
+        check("hash_file", i, md5_multi::hash_file(paths[i]));
+
+    std::vector<std::string> digests = md5_multi::hash_files(paths);
+    for (size_t i = 0; i < paths.size(); ++i)
+        check("hash_files", i, digests[i]);
+
+    // A partial batch leaves lanes empty
+    for (size_t count = 2; count <= md5_multi::lanes; ++count)
+    {
+        std::vector<std::string> batch(paths.end() - count, paths.end());
+        digests = md5_multi::hash_files(batch);
+        for (size_t i = 0; i < count; ++i)
+            check("hash_files", paths.size() - count + i, digests[i]);
+    }
+
+    for (auto const& path : paths)
+        FileManager::delete_file(path);
+
+    std::cout << sizes.size() << " boundary sizes checked against MD5: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+template<typename Hash>
+static double best_throughput(size_t total_size, Hash&& hash)
+{
+    double best = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto start = clock_type::now();
+        hash();
+        double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+        best = std::max(best, total_size / (1024.0 * 1024.0) / seconds);
+    }
+
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    int file_count = (argc > 1 ? atoi(argv[1]) : default_file_count);
+    int file_size_mb = (argc > 2 ? atoi(argv[2]) : default_file_size_mb);
+    if (file_count <= 0 || file_size_mb <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [file_count] [file_size_mb]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The FileManager paths are relative to its root
+    FileManager::set_root_dir(work_dir);
+    if (!check_digests())
+        return EXIT_FAILURE;
+
+    size_t file_size = static_cast<size_t>(file_size_mb) * 1024 * 1024;
+    std::vector<std::string> paths;
+    for (int i = 0; i < file_count; ++i)
+    {
+        paths.emplace_back("throughput_" + std::to_string(i));
+        if (!write_file(paths.back(), make_content(file_size, static_cast<uint32_t>(i))))
+        {
+            std::cerr << "Failed to write " << paths.back() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    size_t total_size = file_size * file_count;
+    std::vector<std::string> scalar_digests;
+    std::vector<std::string> multi_digests;
+
+    double scalar = best_throughput(total_size, [&]()
+    {
+        scalar_digests.clear();
+        for (auto const& path : paths)
+            scalar_digests.emplace_back(md5_multi::hash_file(path));
+    });
+    double multi = best_throughput(total_size, [&]()
+    {
+        multi_digests = md5_multi::hash_files(paths);
+    });
+
+    for (auto const& path : paths)
+        FileManager::delete_file(path);
+
+    std::cout << file_count << " files of " << file_size_mb << "MB, best of " << iterations << std::endl;
+    std::cout << "  scalar MD5  : " << scalar << " MB/s" << std::endl;
+    std::cout << "  md5_multi x" << md5_multi::lanes << ": " << multi << " MB/s" << (md5_multi::simd_available() ? "" : " (no AVX2, scalar fallback)") << std::endl;
+
+    if (scalar_digests != multi_digests)
+    {
+        std::cerr << "The scalar and multi-buffer digests differ" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Replays a burst of small messages through the TCP framing code (Network::split_frames)
+// and through the erase-from-front vector it replaced, then prints the time per burst.
+//   tcp_framing_bench [message_count]
+// The burst is handed to the framing code in one TCP segment per recv, 64KB per recv and all at once,
+// the network thread reads everything FIONREAD reports so a burst often comes in a single recv.
+
+#include "network.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using clock_type = std::chrono::steady_clock;
+
+static constexpr int default_message_count = 10000;
+static constexpr int iterations = 50;
+
+// The receive loop before the cursor buffer: every frame is erased from the front of the vector,
+// moving all the bytes received after it. It parses the frame size, not the whole buffer like it used to.
+class vector_framing
+{
+    std::vector<uint8_t> _buffer;
+    Network::next_packet_size_t _next_packet_size = 0;
+
+public:
+    template<typename OnFrame>
+    void receive(uint8_t const* data, size_t len, OnFrame&& on_frame)
+    {
+        size_t buff_len = _buffer.size();
+        _buffer.resize(buff_len + len);
+        memcpy(_buffer.data() + buff_len, data, len);
+
+        while (_buffer.size() > 0)
+        {
+            if (_next_packet_size == 0 && _buffer.size() >= sizeof(Network::next_packet_size_t))
+            {
+                memcpy(&_next_packet_size, _buffer.data(), sizeof(Network::next_packet_size_t));
+                _next_packet_size = utils::Endian::net_swap(_next_packet_size);
+                _buffer.erase(_buffer.begin(), _buffer.begin() + sizeof(Network::next_packet_size_t));
+            }
+
+            if (_next_packet_size > 0 && _buffer.size() >= _next_packet_size)
+            {
+                on_frame(_buffer.data(), static_cast<size_t>(_next_packet_size));
+                _buffer.erase(_buffer.begin(), _buffer.begin() + _next_packet_size);
+                _next_packet_size = 0;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+};
+
+class cursor_framing
+{
+    Network::recv_buffer_t _buffer;
+    Network::next_packet_size_t _next_packet_size = 0;
+
+public:
+    template<typename OnFrame>
+    void receive(uint8_t const* data, size_t len, OnFrame&& on_frame)
+    {
+        memcpy(_buffer.prepare(len), data, len);
+        _buffer.commit(len);
+        Network::split_frames(_buffer, _next_packet_size, on_frame);
+    }
+};
+
+// Small P2P packets like the ones a lobby or a game sends in bursts
+static std::string build_burst(int message_count)
+{
+    std::string burst;
+    Network_Message_pb msg;
+    msg.set_source_id("0123456789abcdef0123456789abcdef");
+    msg.set_game_id("bench");
+
+    for (int i = 0; i < message_count; ++i)
+    {
+        P2P_Data_Message_pb* data = msg.mutable_p2p()->mutable_data_message();
+        data->set_data(std::string(16 + i % 48, static_cast<char>(i)));
+        data->set_channel(i % 4);
+        data->set_socket_name("GameSocket");
+        data->set_sequence(i);
+        msg.set_timestamp(i);
+
+        std::string frame = msg.SerializeAsString();
+        Network::next_packet_size_t size = utils::Endian::net_swap(static_cast<Network::next_packet_size_t>(frame.length()));
+        burst.append(reinterpret_cast<char const*>(&size), sizeof(size));
+        burst += frame;
+    }
+
+    return burst;
+}
+
+template<typename Framing>
+static double replay(std::string const& burst, size_t segment_size, int message_count)
+{
+    Network_Message_pb msg;
+    auto const* data = reinterpret_cast<uint8_t const*>(burst.data());
+    double best = 0;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        Framing framing;
+        int parsed = 0;
+        auto on_frame = [&](uint8_t const* frame, size_t size)
+        {
+            if (msg.ParseFromArray(frame, static_cast<int>(size)))
+                ++parsed;
+        };
+
+        auto start = clock_type::now();
+        for (size_t offset = 0; offset < burst.length(); offset += segment_size)
+            framing.receive(data + offset, std::min(segment_size, burst.length() - offset), on_frame);
+        double elapsed = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+
+        if (parsed != message_count)
+        {
+            std::cerr << "Parsed " << parsed << " messages out of " << message_count << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (i == 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    int message_count = (argc > 1 ? atoi(argv[1]) : default_message_count);
+    if (message_count <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [message_count]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string burst = build_burst(message_count);
+    std::cout << message_count << " messages, " << burst.length() << " bytes, best of " << iterations << " replays" << std::endl;
+
+    for (size_t segment_size : { size_t(1460), size_t(64 * 1024), burst.length() })
+    {
+        double vector_ms = replay<vector_framing>(burst, segment_size, message_count);
+        double cursor_ms = replay<cursor_framing>(burst, segment_size, message_count);
+
+        std::cout << segment_size << " bytes per recv:" << std::endl;
+        std::cout << "  erase-from-front vector: " << vector_ms << " ms" << std::endl;
+        std::cout << "  cursor buffer          : " << cursor_ms << " ms" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2020 Nemirtingas
+ * This file is part of the Nemirtingas's Epic Emulator
+ *
+ * The Nemirtingas's Epic Emulator is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * The Nemirtingas's Epic Emulator is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with the Nemirtingas's Epic Emulator; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Trains the zstd dictionary used to compress the network messages.
+//
+// Record traffic by setting "network_capture_file" in NemirtingasEpicEmu.json (emulator built with USE_ZSTD_COMPRESS),
+// play a session with a few peers, then:
+//   train_network_dictionary [-s dict_size] output.dict capture1.bin [capture2.bin ...]
+// Every peer must then use the same file in "network_compress_dictionary".
+
+#include <zdict.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static constexpr size_t default_dictionary_size = 16 * 1024;
+
+// Capture files are a sequence of <big endian uint32 size><message>
+static bool load_capture(std::string const& path, std::string& samples, std::vector<size_t>& sample_sizes)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    uint8_t size_buffer[4];
+    while (file.read(reinterpret_cast<char*>(size_buffer), sizeof(size_buffer)))
+    {
+        size_t size = (size_t(size_buffer[0]) << 24) | (size_t(size_buffer[1]) << 16) | (size_t(size_buffer[2]) << 8) | size_t(size_buffer[3]);
+        size_t offset = samples.length();
+
+        samples.resize(offset + size);
+        if (!file.read(&samples[offset], size))
+        {// The emulator was killed while writing, drop the partial sample
+            samples.resize(offset);
+            std::cerr << path << " is truncated, ignoring its last message" << std::endl;
+            break;
+        }
+        sample_sizes.emplace_back(size);
+    }
+
+    return true;
+}
+
+static void usage(char const* name)
+{
+    std::cerr << "Usage: " << name << " [-s dict_size] output.dict capture.bin [capture.bin ...]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t dictionary_size = default_dictionary_size;
+    int arg = 1;
+
+    if (arg + 1 < argc && strcmp(argv[arg], "-s") == 0)
+    {
+        dictionary_size = strtoul(argv[arg + 1], nullptr, 10);
+        arg += 2;
+    }
+
+    if (argc - arg < 2 || dictionary_size == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string output_path(argv[arg++]);
+    std::string samples;
+    std::vector<size_t> sample_sizes;
+
+    for (; arg < argc; ++arg)
+    {
+        if (!load_capture(argv[arg], samples, sample_sizes))
+            return EXIT_FAILURE;
+    }
+
+    std::cout << "Training a " << dictionary_size << " bytes dictionary on " << sample_sizes.size() << " messages (" << samples.length() << " bytes)" << std::endl;
+
+    std::string dictionary(dictionary_size, '\0');
+    size_t res = ZDICT_trainFromBuffer(&dictionary[0], dictionary.length(), samples.data(), sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+    if (ZDICT_isError(res))
+    {
+        // Usually means there are not enough samples, zstd wants ~100 times the dictionary size
+        std::cerr << "Training failed: " << ZDICT_getErrorName(res) << std::endl;
+        return EXIT_FAILURE;
+    }
+    dictionary.resize(res);
+
+    std::ofstream output(output_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output.write(dictionary.data(), dictionary.length()))
+    {
+        std::cerr << "Failed to write " << output_path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Wrote " << dictionary.length() << " bytes dictionary " << output_path << ", id " << ZDICT_getDictID(dictionary.data(), dictionary.length()) << std::endl;
+    return EXIT_SUCCESS;
+}